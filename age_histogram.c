@@ -0,0 +1,191 @@
+#include "age_histogram.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Prepares the histogram of a run: rows zeroed counts, the rabbits aged 0 in row origin.
+ *        The buffer of a previous run is reused when it is large enough.
+ * @param h The histogram.
+ * @param rows The number of rows of the run (see AGE_HISTOGRAM_ROWS).
+ * @param origin The row of age 0 (at least the oldest age of the rabbits added next).
+ * @return 1 on success, 0 if the rows could not be allocated (the run then keeps no histogram).
+ */
+int start_age_histogram(s_age_histogram *h, int rows, int origin)
+{
+    h->rows = 0;
+    if (rows > h->allocated)
+    {
+        long long *temp = realloc(h->counts, sizeof(long long) * NB_AGE_CLASSES * (size_t)rows);
+        if (!temp)
+            return 0;
+        h->counts = temp;
+        h->allocated = rows;
+    }
+    memset(h->counts, 0, sizeof(long long) * NB_AGE_CLASSES * (size_t)rows);
+    h->rows = rows;
+    h->origin = origin;
+    h->oldest = 0;
+    return 1;
+}
+
+/**
+ * @brief Empties the histogram, keeping its rows and origin.
+ * @param h The histogram.
+ * @return void
+ */
+void clear_age_histogram(s_age_histogram *h)
+{
+    memset(h->counts, 0, sizeof(long long) * NB_AGE_CLASSES * (size_t)h->rows);
+    h->oldest = 0;
+}
+
+/**
+ * @brief Ages every rabbit of the histogram by one month, by moving its origin to the next row.
+ *        The rows only run out if the run goes past the months it was started for; they are grown then.
+ * @param h The histogram.
+ * @return 1 on success, 0 if the rows could not be grown (the origin is left in place).
+ */
+int advance_age_histogram(s_age_histogram *h)
+{
+    if (h->origin + 1 >= h->rows)
+    {
+        int rows = h->rows * 2;
+        if (rows > h->allocated)
+        {
+            long long *temp = realloc(h->counts, sizeof(long long) * NB_AGE_CLASSES * (size_t)rows);
+            if (!temp)
+                return 0;
+            h->counts = temp;
+            h->allocated = rows;
+        }
+        memset(h->counts + (size_t)h->rows * NB_AGE_CLASSES, 0,
+               sizeof(long long) * NB_AGE_CLASSES * (size_t)(rows - h->rows));
+        h->rows = rows;
+    }
+    h->origin++;
+    return 1;
+}
+
+/**
+ * @brief Adds the counts of a histogram (or the deltas kept by one thread) to another one of the same shape.
+ * @param dst The histogram receiving the counts.
+ * @param src The histogram added, with the same origin.
+ * @return void
+ */
+void add_age_histogram(s_age_histogram *dst, const s_age_histogram *src)
+{
+    for (int r = src->oldest; r <= src->origin && r < dst->rows; ++r)
+        for (int c = 0; c < NB_AGE_CLASSES; ++c)
+            AGE_HISTOGRAM_AT(dst, r, c) += AGE_HISTOGRAM_AT(src, r, c);
+    if (src->oldest < dst->oldest)
+        dst->oldest = src->oldest;
+}
+
+/**
+ * @brief Tells whether a row of the histogram holds no rabbit.
+ * @param h The histogram.
+ * @param row The row.
+ * @return 1 if the row is empty, 0 otherwise.
+ */
+static int age_row_is_empty(const s_age_histogram *h, int row)
+{
+    const long long *counts = &AGE_HISTOGRAM_AT(h, row, 0);
+    return (counts[0] | counts[1] | counts[2] | counts[3]) == 0;
+}
+
+/**
+ * @brief Moves the oldest row of the histogram past the rows emptied by the deaths.
+ *        Rows before the origin never receive rabbits again, except through a full rebuild
+ *        that starts from a cleared histogram.
+ * @param h The histogram.
+ * @return void
+ */
+static void skip_empty_rows(s_age_histogram *h)
+{
+    while (h->oldest < h->origin && age_row_is_empty(h, h->oldest))
+        h->oldest++;
+}
+
+/**
+ * @brief Computes the age statistics of the living rabbits from the histogram.
+ * @param h The histogram.
+ * @param min_age Receives the youngest age (0 without rabbits).
+ * @param max_age Receives the oldest age (0 without rabbits).
+ * @param mature_rabbits Receives the number of mature rabbits.
+ * @return The sum of the ages of the living rabbits.
+ */
+long long summarize_age_histogram(s_age_histogram *h, int *min_age, int *max_age, long long *mature_rabbits)
+{
+    long long age_sum = 0, mature = 0;
+    int youngest = -1, oldest = -1;
+
+    skip_empty_rows(h);
+    for (int r = h->oldest; r <= h->origin; ++r)
+    {
+        const long long *counts = &AGE_HISTOGRAM_AT(h, r, 0);
+        long long total = counts[0] + counts[1] + counts[2] + counts[3];
+        if (total == 0)
+            continue;
+        int age = h->origin - r;
+        age_sum += total * age;
+        mature += counts[AGE_CLASS(0, 1)] + counts[AGE_CLASS(1, 1)];
+        if (oldest < 0)
+            oldest = age;
+        youngest = age;
+    }
+
+    *min_age = youngest < 0 ? 0 : youngest;
+    *max_age = oldest < 0 ? 0 : oldest;
+    *mature_rabbits = mature;
+    return age_sum;
+}
+
+/**
+ * @brief Counts the ages that have at least one living rabbit (the rows fill_age_rows writes).
+ * @param h The histogram.
+ * @return The number of ages.
+ */
+size_t count_age_rows(s_age_histogram *h)
+{
+    size_t count = 0;
+    skip_empty_rows(h);
+    for (int r = h->oldest; r <= h->origin; ++r)
+        count += !age_row_is_empty(h, r);
+    return count;
+}
+
+/**
+ * @brief Writes the age structure of a month, one row per age with living rabbits, youngest first.
+ * @param h The histogram.
+ * @param month The month of the rows.
+ * @param rows Receives the rows (room for count_age_rows rows).
+ * @return The number of rows written.
+ */
+size_t fill_age_rows(s_age_histogram *h, int month, s_age_row *rows)
+{
+    size_t count = 0;
+    skip_empty_rows(h);
+    for (int r = h->origin; r >= h->oldest; --r)
+    {
+        if (age_row_is_empty(h, r))
+            continue;
+        s_age_row *row = &rows[count++];
+        row->month = month;
+        row->age = h->origin - r;
+        for (int c = 0; c < NB_AGE_CLASSES; ++c)
+            row->counts[c] = AGE_HISTOGRAM_AT(h, r, c);
+    }
+    return count;
+}
+
+/**
+ * @brief Frees the rows of a histogram.
+ * @param h The histogram.
+ * @return void
+ */
+void free_age_histogram(s_age_histogram *h)
+{
+    free(h->counts);
+    *h = (s_age_histogram){0};
+}
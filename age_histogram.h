@@ -0,0 +1,53 @@
+#ifndef AGE_HISTOGRAM_H
+#define AGE_HISTOGRAM_H
+
+// Age structure of the living rabbits of a logged simulation: rabbits per age in months and per
+// class (sex and maturity), kept up to date on every birth, death and maturity instead of being
+// recomputed from the rabbits. Rows are indexed by birth month (row = origin - age), so ageing the
+// whole population by one month only moves the origin, and the statistics of a month (average,
+// minimum and maximum age, mature rabbits) and its full age structure cost O(oldest age).
+// The row of a rabbit never changes, which lets a thread keep the deltas of its own rabbits in a
+// histogram of the same shape that is added to the shared one afterwards (see add_age_histogram).
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Oldest age of a rabbit of the initial population (same bound as EVENT_MAX_FOUNDER_AGE)
+#define AGE_HISTOGRAM_FOUNDER_AGE 32
+
+// Rows of the histogram of a simulation of the given number of months
+#define AGE_HISTOGRAM_ROWS(months) (AGE_HISTOGRAM_FOUNDER_AGE + (months) + 2)
+
+// Classes of a row: females and males, immature and mature
+#define NB_AGE_CLASSES 4
+#define AGE_CLASS(sex, mature) (((sex) << 1) | (mature))
+
+// Count of a row, or of an age in months, and a class
+#define AGE_HISTOGRAM_AT(h, row, cls) ((h)->counts[(size_t)(row) * NB_AGE_CLASSES + (cls)])
+#define AGE_HISTOGRAM_CELL(h, age, cls) AGE_HISTOGRAM_AT(h, (h)->origin - (age), cls)
+
+typedef struct {
+    long long *counts;           // rows x NB_AGE_CLASSES counts (kept between runs of a pooled instance)
+    int rows;                    // Rows of the current run (0 when the run keeps no histogram)
+    int allocated;               // Allocated rows
+    int origin;                  // Row of the rabbits aged 0 months
+    int oldest;                  // No rabbit below this row
+} s_age_histogram;
+
+// One row of the age structure of a month, as written to the age structure logs
+typedef struct {
+    int month;
+    int age;
+    long long counts[NB_AGE_CLASSES];  // Indexed by AGE_CLASS(sex, mature)
+} s_age_row;
+
+int start_age_histogram(s_age_histogram *h, int rows, int origin);
+void clear_age_histogram(s_age_histogram *h);
+int advance_age_histogram(s_age_histogram *h);
+void add_age_histogram(s_age_histogram *dst, const s_age_histogram *src);
+long long summarize_age_histogram(s_age_histogram *h, int *min_age, int *max_age, long long *mature_rabbits);
+size_t count_age_rows(s_age_histogram *h);
+size_t fill_age_rows(s_age_histogram *h, int month, s_age_row *rows);
+void free_age_histogram(s_age_histogram *h);
+
+#endif
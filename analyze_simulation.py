@@ -9,6 +9,9 @@ import numpy as np
 import matplotlib.pyplot as plt
 import seaborn as sns
 from glob import glob
+from concurrent.futures import ProcessPoolExecutor
+import argparse
+import os
 import warnings
 warnings.filterwarnings('ignore')
 
@@ -18,42 +21,214 @@ plt.rcParams['figure.figsize'] = (14, 8)
 plt.rcParams['font.size'] = 10
 
 
+# Binary columnar logs written with "--log-format binary" (layout described in rabbitsim.h)
+BINARY_LOG_MAGIC = b"RABBITLG"
+BINARY_LOG_HEADER = np.dtype([('magic', 'S8'), ('version', '<u4'), ('kind', '<u4'),
+                              ('nb_columns', '<u4'), ('nb_rows', '<u4'), ('months', '<i4'),
+                              ('initial_population', '<i4'), ('base_seed', '<u8'),
+                              ('number', '<i4'), ('reserved', '<u4')])
+BINARY_LOG_COLUMN = np.dtype([('name', 'S28'), ('type', '<u4')])
+BINARY_LOG_TYPES = {0: '<i4', 1: '<f4'}
+STOP_REASON_NAMES = ['completed', 'extinction', 'ceiling', 'confidence', 'limit', 'storage']
+
+
+def load_binary_log(path, offset=0):
+    """Memory-map the binary log starting at offset, returns (DataFrame, header dict)"""
+    header = np.fromfile(path, dtype=BINARY_LOG_HEADER, count=1, offset=offset)[0]
+    if header['magic'] != BINARY_LOG_MAGIC or header['version'] != 1:
+        raise ValueError(f"{path} is not a version 1 rabbit log")
+    nb_columns, nb_rows = int(header['nb_columns']), int(header['nb_rows'])
+    columns = np.fromfile(path, dtype=BINARY_LOG_COLUMN, count=nb_columns,
+                          offset=offset + BINARY_LOG_HEADER.itemsize)
+
+    offset += BINARY_LOG_HEADER.itemsize + nb_columns * BINARY_LOG_COLUMN.itemsize
+    data = {}
+    for column in columns:
+        name = column['name'].decode()
+        dtype = BINARY_LOG_TYPES[int(column['type'])]
+        # Each column is one contiguous array of 4-byte values
+        data[name] = (np.memmap(path, dtype=dtype, mode='r', offset=offset, shape=(nb_rows,))
+                      if nb_rows > 0 else np.empty(0, dtype=dtype))
+        offset += nb_rows * 4
+
+    df = pd.DataFrame(data)
+    if 'Stop_Reason' in df:
+        df['Stop_Reason'] = [STOP_REASON_NAMES[r] if 0 <= r < len(STOP_REASON_NAMES) else 'unknown'
+                             for r in df['Stop_Reason']]
+    info = {name: header[name].item() for name in BINARY_LOG_HEADER.names if name not in ('magic', 'reserved')}
+    info['end'] = offset
+    return df, info
+
+
+# Memory-mapped result store written with "--result-store FILE" (layout described in result_store.h)
+RESULT_STORE_MAGIC = b"RABBITRS"
+RESULT_STORE_HEADER = np.dtype([('magic', 'S8'), ('version', '<u4'), ('record_size', '<u4'),
+                                ('nb_records', '<u4'), ('months', '<i4'), ('initial_population', '<i4'),
+                                ('flags', '<u4'), ('base_seed', '<u8'), ('records_offset', '<u8'),
+                                ('done_offset', '<u8'), ('reserved', 'V8')])
+# Leading fields of s_simulation_results, the record size of the header covers the rest (instrumented builds)
+RESULT_STORE_FIELDS = [('Total_Dead', '<i4', 0), ('Final_Alive', '<i4', 4), ('Extinction_Month', '<i4', 8),
+                       ('Final_Males', '<i4', 12), ('Final_Females', '<i4', 16), ('Peak_Pop', '<i4', 20),
+                       ('Peak_Month', '<i4', 24), ('Min_Pop', '<i4', 28), ('Min_Month', '<i4', 32),
+                       ('Population_Sum', '<i8', 40), ('Months_Simulated', '<i4', 48), ('Male_Pct', '<f4', 52),
+                       ('Female_Pct', '<f4', 56), ('Stop_Reason', '<i4', 60), ('Cohort_Switch_Month', '<i4', 64),
+                       ('Rabbit_Updates', '<i8', 72)]
+
+
+def load_result_store(path):
+    """Memory-map a result store, returns (DataFrame of the completed simulations, header dict)"""
+    header = np.fromfile(path, dtype=RESULT_STORE_HEADER, count=1)[0]
+    if header['magic'] != RESULT_STORE_MAGIC or header['version'] != 1:
+        raise ValueError(f"{path} is not a version 1 result store")
+    nb_records = int(header['nb_records'])
+    record = np.dtype({'names': [f[0] for f in RESULT_STORE_FIELDS], 'formats': [f[1] for f in RESULT_STORE_FIELDS],
+                       'offsets': [f[2] for f in RESULT_STORE_FIELDS], 'itemsize': int(header['record_size'])})
+    records = np.memmap(path, dtype=record, mode='r', offset=int(header['records_offset']), shape=(nb_records,))
+    done = np.memmap(path, dtype='u1', mode='r', offset=int(header['done_offset']), shape=(nb_records,))
+
+    # An interrupted run only has some of its records
+    completed = np.flatnonzero(done)
+    df = pd.DataFrame({name: records[name][completed] for name in record.names})
+    df.insert(0, 'Sim_Number', completed + 1)
+    df['Stop_Reason'] = [STOP_REASON_NAMES[r] if 0 <= r < len(STOP_REASON_NAMES) else 'unknown'
+                         for r in df['Stop_Reason']]
+    info = {name: header[name].item() for name in RESULT_STORE_HEADER.names if name not in ('magic', 'reserved')}
+    return df, info
+
+
+def load_monthly_stream(path):
+    """Split a single stream file ("--log-stream 1") into one DataFrame per simulation, ordered by number"""
+    logs = []
+    if path.endswith('.rlog'):
+        offset, size = 0, os.path.getsize(path)
+        while offset < size:
+            df, info = load_binary_log(path, offset)
+            logs.append((info['number'], df))
+            offset = info['end']
+    else:
+        stream = pd.read_csv(path)
+        logs = [(int(n), df.drop(columns='Sim_Number').reset_index(drop=True))
+                for n, df in stream.groupby('Sim_Number')]
+    return [df for _, df in sorted(logs, key=lambda log: log[0])]
+
+
+def load_simulation_file(file):
+    """Load the monthly log of one simulation (run in a worker process by load_data)"""
+    df = load_binary_log(file)[0] if file.endswith('.rlog') else pd.read_csv(file)
+    df['simulation_file'] = file
+    return df
+
+
+# Summaries with more simulations than this are plotted as distributions instead of one bar each
+MAX_PLOTTED_SIMULATIONS = 200
+
+
 class RabbitSimulationAnalyzer:
     """Analyzes rabbit simulation data and generates visualizations"""
     
-    def __init__(self):
+    def __init__(self, aggregates_only=False, jobs=None):
         self.individual_data = []  # List of DataFrames from individual simulations
         self.summary_data = None    # Summary statistics across all simulations
+        self.ensemble_data = None   # Month by month statistics across all simulations
+        self.age_data = []          # Age structure of every month of the logged simulations
+        self.aggregates_only = aggregates_only  # Plot from the ensemble and summary files only
+        self.jobs = jobs            # Processes loading the monthly logs (None for one per core)
         self.load_data()
     
+    def load_individual_files(self, sim_files):
+        """Load the monthly logs of the simulations, in parallel and in file order"""
+        if len(sim_files) < 2 or self.jobs == 1:
+            results = []
+            for file in sim_files:
+                try:
+                    results.append(load_simulation_file(file))
+                except Exception as e:
+                    results.append(e)
+        else:
+            with ProcessPoolExecutor(max_workers=self.jobs) as pool:
+                futures = [pool.submit(load_simulation_file, file) for file in sim_files]
+                results = []
+                for future in futures:
+                    try:
+                        results.append(future.result())
+                    except Exception as e:
+                        results.append(e)
+        
+        for file, result in zip(sim_files, results):
+            if isinstance(result, Exception):
+                print(f"Error loading {file}: {result}")
+            else:
+                self.individual_data.append(result)
+                print(f"Loaded: {file}")
+    
     def load_data(self):
-        """Load all simulation CSV files"""
+        """Load all simulation CSV files, or the binary .rlog files when there are no CSV files"""
+        # Load ensemble statistics ("--ensemble 1"), enough for the plots of the whole run
+        ensemble_files = glob("ensemble_monthly_*.csv")
+        if ensemble_files:
+            try:
+                self.ensemble_data = pd.read_csv(ensemble_files[0], comment='#')
+                print(f"Loaded ensemble: {ensemble_files[0]}")
+            except Exception as e:
+                print(f"Error loading ensemble: {e}")
+        
         # Load individual simulation data
-        sim_files = sorted(glob("simulation_*_pop*.csv"))
-        sim_files = [f for f in sim_files if "summary" not in f]
+        sim_files = sorted(glob("simulation_*_pop*.csv")) or sorted(glob("simulation_*_pop*.rlog"))
+        sim_files = [f for f in sim_files if "summary" not in f and "monthly" not in f]
+        stream_files = sorted(glob("simulation_monthly_*.csv")) or sorted(glob("simulation_monthly_*.rlog"))
+        if self.aggregates_only and self.ensemble_data is not None:
+            sim_files, stream_files = [], []
         
-        for file in sim_files:
+        # Single stream files written with "--log-stream 1"
+        for file in stream_files:
             try:
-                df = pd.read_csv(file)
-                df['simulation_file'] = file
-                self.individual_data.append(df)
+                for number, df in enumerate(load_monthly_stream(file), start=1):
+                    df['simulation_file'] = f"{file} #{number}"
+                    self.individual_data.append(df)
                 print(f"Loaded: {file}")
             except Exception as e:
                 print(f"Error loading {file}: {e}")
         
+        self.load_individual_files(sim_files)
+        
         # Load summary data
-        summary_files = glob("simulation_summary_*.csv")
+        summary_files = glob("simulation_summary_*.csv") or glob("simulation_summary_*.rlog")
         if summary_files:
             try:
-                # Skip comment lines and read from CSV
-                self.summary_data = pd.read_csv(summary_files[0], skiprows=6)
+                if summary_files[0].endswith('.rlog'):
+                    self.summary_data = load_binary_log(summary_files[0])[0]
+                else:
+                    # Skip comment lines and read from CSV
+                    self.summary_data = pd.read_csv(summary_files[0], skiprows=6)
                 print(f"Loaded summary: {summary_files[0]}")
             except Exception as e:
                 print(f"Error loading summary: {e}")
+        else:
+            # Results of an interrupted run, or of a run without summary file
+            store_files = sorted(glob("*.rstore"))
+            if store_files:
+                try:
+                    self.summary_data = load_result_store(store_files[0])[0]
+                    print(f"Loaded result store: {store_files[0]}")
+                except Exception as e:
+                    print(f"Error loading result store: {e}")
+        
+        # Load the age structure of the logged simulations ("--age-structure 1")
+        age_files = sorted(glob("age_structure_*_pop*.csv")) or sorted(glob("age_structure_*_pop*.rlog"))
+        if self.aggregates_only and self.ensemble_data is not None:
+            age_files = []
+        for file in age_files:
+            try:
+                df = load_binary_log(file)[0] if file.endswith('.rlog') else pd.read_csv(file)
+                df['simulation_file'] = file
+                self.age_data.append(df)
+                print(f"Loaded: {file}")
+            except Exception as e:
+                print(f"Error loading {file}: {e}")
     
     def plot_population_over_time(self):
         """Plot 1: Population dynamics over time for each simulation"""
-        if not self.individual_data:
+        if not self.individual_data and self.ensemble_data is None:
             print("No individual data to plot")
             return
         
@@ -71,6 +246,17 @@ class RabbitSimulationAnalyzer:
             ax.plot(df['Month'], df['Total_Alive'], marker=m, linestyle=ls,
                    color=c, label=df['simulation_file'].iloc[0], linewidth=1.8, markersize=5, alpha=0.9)
         
+        # Spread of all the simulations behind the logged ones
+        if self.ensemble_data is not None:
+            ens = self.ensemble_data
+            n = int(ens['Simulations'].iloc[0])
+            ax.fill_between(ens['Month'], ens['P05_Alive'], ens['P95_Alive'], color='gray', alpha=0.15,
+                            label=f'5-95% of {n} simulations')
+            ax.fill_between(ens['Month'], ens['P25_Alive'], ens['P75_Alive'], color='gray', alpha=0.3,
+                            label='25-75%')
+            ax.plot(ens['Month'], ens['Median_Alive'], color='black', linewidth=2, label='Median')
+            ax.plot(ens['Month'], ens['Mean_Alive'], color='black', linestyle='--', linewidth=1.5, label='Mean')
+        
         ax.set_xlabel('Month', fontsize=12, fontweight='bold')
         ax.set_ylabel('Population (Total Alive Rabbits)', fontsize=12, fontweight='bold')
         ax.set_title('Population Over Time', fontsize=14, fontweight='bold')
@@ -83,11 +269,22 @@ class RabbitSimulationAnalyzer:
     
     def plot_growth_rate_over_time(self):
         """Plot 2: Growth rate (month-to-month change) over time"""
-        if not self.individual_data:
+        ens = self.ensemble_data
+        has_growth = ens is not None and 'Mean_Growth' in ens
+        if not self.individual_data and not has_growth:
             return
         
         fig, ax = plt.subplots(figsize=(14, 7))
         
+        # Growth rate of every simulation alive the month before, aggregated by the simulator
+        if has_growth:
+            n = int(ens['Simulations'].iloc[0])
+            growth = ens[ens['Month'] > 0]
+            ax.fill_between(growth['Month'], growth['Mean_Growth'] - growth['Std_Growth'],
+                            growth['Mean_Growth'] + growth['Std_Growth'], color='gray', alpha=0.25,
+                            label=f'Mean ± std of {n} simulations')
+            ax.plot(growth['Month'], growth['Mean_Growth'], color='black', linewidth=2, label='Mean')
+        
         for df in self.individual_data:
             # Calculate growth rate: (current - previous) / previous * 100
             growth_rate = df['Total_Alive'].pct_change() * 100
@@ -176,14 +373,67 @@ class RabbitSimulationAnalyzer:
         print("✓ Saved: 04_population_structure.png")
         plt.close()
     
+    def plot_age_structure(self):
+        """Plot 6: Age pyramid of the final month and maturity by sex over time, from the age structure logs"""
+        if not self.age_data:
+            return
+        
+        ages = pd.concat(self.age_data, ignore_index=True)
+        classes = ['Immature_Females', 'Mature_Females', 'Immature_Males', 'Mature_Males']
+        fig, axes = plt.subplots(1, 2, figsize=(16, 7))
+        
+        # Plot 1: Age pyramid of the last month recorded by every simulation, summed over the simulations
+        ax = axes[0]
+        last = ages[ages['Month'] == ages.groupby('simulation_file')['Month'].transform('max')]
+        pyramid = last.groupby('Age')[classes].sum().sort_index()
+        ax.barh(pyramid.index, -pyramid['Mature_Females'], color='darkred', label='Mature females')
+        ax.barh(pyramid.index, -pyramid['Immature_Females'], left=-pyramid['Mature_Females'],
+                color='salmon', label='Immature females')
+        ax.barh(pyramid.index, pyramid['Mature_Males'], color='darkblue', label='Mature males')
+        ax.barh(pyramid.index, pyramid['Immature_Males'], left=pyramid['Mature_Males'],
+                color='skyblue', label='Immature males')
+        ax.axvline(0, color='black', linewidth=0.8)
+        ax.set_xlabel('Rabbits (females left, males right)', fontweight='bold')
+        ax.set_ylabel('Age (months)', fontweight='bold')
+        ax.set_title('Age Pyramid at the Final Month (all logged simulations)', fontweight='bold')
+        ax.legend()
+        ax.grid(True, alpha=0.3)
+        
+        # Plot 2: Immature and mature rabbits of each sex over time, averaged over the simulations
+        ax = axes[1]
+        per_month = ages.groupby(['simulation_file', 'Month'])[classes].sum().groupby('Month').mean()
+        styles = {'Immature_Females': ('salmon', '--'), 'Mature_Females': ('darkred', '-'),
+                  'Immature_Males': ('skyblue', '--'), 'Mature_Males': ('darkblue', '-')}
+        for name in classes:
+            color, style = styles[name]
+            ax.plot(per_month.index, per_month[name], label=name.replace('_', ' '), color=color,
+                    linestyle=style, linewidth=2)
+        ax.set_xlabel('Month', fontweight='bold')
+        ax.set_ylabel('Average Count', fontweight='bold')
+        ax.set_title('Maturity by Sex Over Time', fontweight='bold')
+        ax.set_yscale('symlog')
+        ax.legend()
+        ax.grid(True, alpha=0.3)
+        
+        plt.tight_layout()
+        plt.savefig('06_age_structure.png', dpi=300, bbox_inches='tight')
+        print("✓ Saved: 06_age_structure.png")
+        plt.close()
+    
     def plot_births_vs_deaths(self):
         """Plot 5: Births vs Deaths over time"""
-        if not self.individual_data:
+        if not self.individual_data and self.ensemble_data is None:
             return
         
         fig, axes = plt.subplots(1, 2, figsize=(14, 6))
         
-        all_data = pd.concat(self.individual_data, ignore_index=True)
+        # Means of every simulation when the ensemble file is there, the logged simulations otherwise
+        if self.ensemble_data is not None:
+            all_data = self.ensemble_data.rename(columns={'Mean_Births': 'Births', 'Mean_Deaths': 'Deaths'})
+            scope = f" (mean of {int(all_data['Simulations'].iloc[0])} simulations)"
+        else:
+            all_data = pd.concat(self.individual_data, ignore_index=True)
+            scope = ""
         
         # Plot 1: Births and deaths
         ax = axes[0]
@@ -191,7 +441,7 @@ class RabbitSimulationAnalyzer:
         ax.bar(all_data['Month'] + 0.2, all_data['Deaths'], width=0.4, label='Deaths', alpha=0.8)
         ax.set_xlabel('Month', fontweight='bold')
         ax.set_ylabel('Count', fontweight='bold')
-        ax.set_title('Monthly Births vs Deaths', fontweight='bold')
+        ax.set_title('Monthly Births vs Deaths' + scope, fontweight='bold')
         ax.legend()
         ax.grid(True, alpha=0.3, axis='y')
         
@@ -224,13 +474,20 @@ class RabbitSimulationAnalyzer:
         fig, axes = plt.subplots(1, 2, figsize=(14, 6))
         
         data = self.summary_data
+        many = len(data) > MAX_PLOTTED_SIMULATIONS
         
         # Plot 1: Final population distribution
         ax = axes[0]
-        ax.bar(data['Sim_Number'], data['Final_Alive'], color='steelblue', alpha=0.7)
-        ax.set_xlabel('Simulation #', fontweight='bold')
-        ax.set_ylabel('Final Population', fontweight='bold')
-        ax.set_title('Final Population by Simulation', fontweight='bold')
+        if many:
+            ax.hist(data['Final_Alive'], bins=50, color='steelblue', alpha=0.7)
+            ax.set_xlabel('Final Population', fontweight='bold')
+            ax.set_ylabel('Simulations', fontweight='bold')
+            ax.set_title(f'Final Population of {len(data)} Simulations', fontweight='bold')
+        else:
+            ax.bar(data['Sim_Number'], data['Final_Alive'], color='steelblue', alpha=0.7)
+            ax.set_xlabel('Simulation #', fontweight='bold')
+            ax.set_ylabel('Final Population', fontweight='bold')
+            ax.set_title('Final Population by Simulation', fontweight='bold')
         ax.grid(True, alpha=0.3, axis='y')
         
         # Plot 2: Extinction months / Survival vs Extinction
@@ -238,15 +495,30 @@ class RabbitSimulationAnalyzer:
         extinct = data[data['Extinction_Month'] > 0]
         surviving = data[data['Extinction_Month'] == 0]
         
-        if not extinct.empty:
-            ax.bar(extinct['Sim_Number'], extinct['Extinction_Month'], 
-                   label=f'Extinct ({len(extinct)})', color='red', alpha=0.7)
-        if not surviving.empty:
-            ax.bar(surviving['Sim_Number'], surviving['Months_Simulated'], 
-                   label=f'Surviving ({len(surviving)})', color='green', alpha=0.7)
+        if many and self.ensemble_data is not None and 'Extinct' in self.ensemble_data:
+            # Simulations extinct by each month, counted by the simulator
+            ens = self.ensemble_data
+            ax.plot(ens['Month'], ens['Extinct'], color='red', linewidth=2, label=f'Extinct ({len(extinct)})')
+            ax.plot(ens['Month'], ens['Simulations'] - ens['Extinct'], color='green', linewidth=2,
+                    label=f'Alive (ending {len(surviving)} surviving)')
+            ax.set_xlabel('Month', fontweight='bold')
+            ax.set_ylabel('Simulations', fontweight='bold')
+        elif many:
+            ax.hist([extinct['Extinction_Month'], surviving['Months_Simulated']], bins=50, stacked=True,
+                    color=['red', 'green'], alpha=0.7,
+                    label=[f'Extinct ({len(extinct)})', f'Surviving ({len(surviving)})'])
+            ax.set_xlabel('Month', fontweight='bold')
+            ax.set_ylabel('Simulations', fontweight='bold')
+        else:
+            if not extinct.empty:
+                ax.bar(extinct['Sim_Number'], extinct['Extinction_Month'], 
+                       label=f'Extinct ({len(extinct)})', color='red', alpha=0.7)
+            if not surviving.empty:
+                ax.bar(surviving['Sim_Number'], surviving['Months_Simulated'], 
+                       label=f'Surviving ({len(surviving)})', color='green', alpha=0.7)
+            ax.set_xlabel('Simulation #', fontweight='bold')
+            ax.set_ylabel('Month', fontweight='bold')
         
-        ax.set_xlabel('Simulation #', fontweight='bold')
-        ax.set_ylabel('Month', fontweight='bold')
         ax.set_title('Survival vs Extinction', fontweight='bold')
         ax.legend()
         ax.grid(True, alpha=0.3, axis='y')
@@ -266,7 +538,7 @@ class RabbitSimulationAnalyzer:
         print("RABBIT SIMULATION ANALYSIS - GENERATING PLOTS")
         print("="*60 + "\n")
         
-        if not self.individual_data:
+        if not self.individual_data and self.ensemble_data is None:
             print("ERROR: No simulation data found. Please run the C simulation first.")
             return
         
@@ -274,6 +546,7 @@ class RabbitSimulationAnalyzer:
         self.plot_growth_rate_over_time()
         self.plot_phase_plot()
         self.plot_population_structure()
+        self.plot_age_structure()
         self.plot_births_vs_deaths()
         self.plot_extinction_outcomes()
         
@@ -286,12 +559,20 @@ class RabbitSimulationAnalyzer:
         print("  03_phase_plot.png - Population dynamics (current vs next month)")
         print("  04_population_structure.png - Sex distribution over time and final distribution")
         print("  05_births_vs_deaths.png - Reproduction and mortality")
+        if self.age_data:
+            print("  06_age_structure.png - Age pyramid and maturity by sex")
         print("  08_extinction_outcomes.png - Final population and survival vs extinction")
 
 
 def main():
     """Main entry point"""
-    analyzer = RabbitSimulationAnalyzer()
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--aggregates-only', action='store_true',
+                        help='plot from the ensemble and summary files, without loading the monthly logs')
+    parser.add_argument('--jobs', type=int, default=None,
+                        help='processes loading the monthly logs (default: one per core)')
+    args = parser.parse_args()
+    analyzer = RabbitSimulationAnalyzer(aggregates_only=args.aggregates_only, jobs=args.jobs)
     analyzer.generate_all_plots()
 
 
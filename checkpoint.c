@@ -0,0 +1,596 @@
+#include "checkpoint.h"
+#include "cohort.h"
+
+#include <string.h>
+
+// Global variables for the checkpoints of multi_simulate
+int checkpoint_interval = 0;
+int checkpoint_resume = 0;
+
+// Marker written after the last record, so a truncated file is never resumed
+#define CHECKPOINT_END 0x444E454Bu  // "KEND"
+
+// Bytes of one encoded record
+#define CHECKPOINT_RABBIT_SIZE 7     // age, maturity_age, flags, nb_litters_y, nb_litters (+ 4 for the rate)
+#define CHECKPOINT_COHORT_SIZE 21    // count, survival_rate, age, maturity_age and the five small fields
+#define CHECKPOINT_MONTH_SIZE 44     // The eleven fields of s_monthly_stats
+#define CHECKPOINT_AGE_ROW_SIZE (8 + 8 * NB_AGE_CLASSES)  // month, age and the counts of s_age_row
+
+// File being written or read, ok drops to 0 at the first error
+typedef struct {
+    FILE *fp;
+    int ok;
+} s_checkpoint_file;
+
+/**
+ * @brief Stores a value of 1 to 8 bytes in little-endian order.
+ * @param p The destination.
+ * @param value The value.
+ * @param size The number of bytes.
+ * @return The byte after the value.
+ */
+static uint8_t *put_le(uint8_t *p, uint64_t value, int size)
+{
+    for (int b = 0; b < size; ++b)
+        p[b] = (uint8_t)(value >> (8 * b));
+    return p + size;
+}
+
+/**
+ * @brief Reads a value of 1 to 8 bytes stored in little-endian order.
+ * @param p The value.
+ * @param size The number of bytes.
+ * @return The value.
+ */
+static uint64_t get_le(const uint8_t *p, int size)
+{
+    uint64_t value = 0;
+    for (int b = 0; b < size; ++b)
+        value |= (uint64_t)p[b] << (8 * b);
+    return value;
+}
+
+// Bit copies of the floating-point values, stored like the integers
+static uint32_t float_bits(float value) { uint32_t bits; memcpy(&bits, &value, sizeof(bits)); return bits; }
+static float bits_float(uint32_t bits) { float value; memcpy(&value, &bits, sizeof(value)); return value; }
+static uint64_t double_bits(double value) { uint64_t bits; memcpy(&bits, &value, sizeof(bits)); return bits; }
+
+/**
+ * @brief Writes one header value.
+ * @param f The checkpoint file.
+ * @param value The value.
+ * @param size The number of bytes (4 or 8).
+ * @return void
+ */
+static void write_value(s_checkpoint_file *f, uint64_t value, int size)
+{
+    uint8_t bytes[8];
+    put_le(bytes, value, size);
+    if (f->ok && fwrite(bytes, 1, size, f->fp) != (size_t)size)
+        f->ok = 0;
+}
+
+/**
+ * @brief Reads one header value.
+ * @param f The checkpoint file.
+ * @param size The number of bytes (4 or 8).
+ * @return The value, 0 after an error.
+ */
+static uint64_t read_value(s_checkpoint_file *f, int size)
+{
+    uint8_t bytes[8];
+    if (!f->ok || fread(bytes, 1, size, f->fp) != (size_t)size)
+    {
+        f->ok = 0;
+        return 0;
+    }
+    return get_le(bytes, size);
+}
+
+/**
+ * @brief Builds the checkpoint file of a simulation ("checkpoint_sim<I>_pop<N>.rck" after the log prefix).
+ * @param target The target to fill.
+ * @param base_seed The base seed of the run.
+ * @param sim_number The simulation number (from 1).
+ * @param months The months requested.
+ * @param initial_population The initial population size.
+ * @return void
+ */
+void checkpoint_target_for(s_checkpoint_target *target, uint64_t base_seed, int sim_number, int months,
+                           int initial_population)
+{
+    snprintf(target->path, sizeof(target->path), "%scheckpoint_sim%d_pop%d.rck", log_file_prefix, sim_number,
+             initial_population);
+    target->base_seed = base_seed;
+    target->sim_number = sim_number;
+    target->months = months;
+    target->initial_population = initial_population;
+    target->owned = 0;
+}
+
+/**
+ * @brief Writes or checks the part of the header that must match for a checkpoint to be resumed:
+ *        the simulation and its survival model.
+ * @param f The checkpoint file.
+ * @param target The simulation.
+ * @param params The survival model.
+ * @param writing 1 to write the values, 0 to read and compare them.
+ * @return 1 if the values were written or match, 0 otherwise.
+ */
+static int transfer_identity(s_checkpoint_file *f, const s_checkpoint_target *target, const s_survival_params *params,
+                             int writing)
+{
+    const uint64_t values[] = {
+        PCG32X_LANES, PCG32X_BUFFER_SIZE, target->base_seed, (uint64_t)target->sim_number,
+        (uint64_t)target->months, (uint64_t)target->initial_population, (uint64_t)params->method,
+        float_bits(params->init_rate), float_bits(params->adult_rate), double_bits(params->gaussian_sigma),
+        double_bits(params->exponential_scale), double_bits(params->exponential_spread),
+        (uint64_t)params->penalty_age, float_bits(params->penalty_per_year)
+    };
+    int match = 1;
+    for (size_t v = 0; v < sizeof(values) / sizeof(values[0]); ++v)
+    {
+        if (writing)
+            write_value(f, values[v], 8);
+        else if (read_value(f, 8) != values[v])
+            match = 0;
+    }
+    return match && f->ok;
+}
+
+/**
+ * @brief Writes the rabbits, encoded CHECKPOINT_BLOCK at a time.
+ * @param f The checkpoint file.
+ * @param sim The simulation instance.
+ * @param with_rates 1 to write the survival rates (random methods).
+ * @return void
+ */
+static void write_rabbits(s_checkpoint_file *f, const s_simulation_instance *sim, int with_rates)
+{
+    uint8_t block[CHECKPOINT_BLOCK * (CHECKPOINT_RABBIT_SIZE + 4)];
+    for (size_t start = 0; start < sim->rabbit_count && f->ok; start += CHECKPOINT_BLOCK)
+    {
+        size_t end = (start + CHECKPOINT_BLOCK < sim->rabbit_count) ? start + CHECKPOINT_BLOCK : sim->rabbit_count;
+        uint8_t *p = block;
+        for (size_t i = start; i < end; ++i)
+        {
+            unsigned flags = (unsigned)RABBIT_FLAG(sim, i, sex) << RABBIT_BIT_sex
+                           | (unsigned)RABBIT_FLAG(sim, i, status) << RABBIT_BIT_status
+                           | (unsigned)RABBIT_FLAG(sim, i, mature) << RABBIT_BIT_mature
+                           | (unsigned)RABBIT_FLAG(sim, i, pregnant) << RABBIT_BIT_pregnant
+                           | (unsigned)RABBIT_FLAG(sim, i, survival_check_flag) << RABBIT_BIT_survival_check_flag;
+            p = put_le(p, (uint64_t)RABBIT_FIELD(sim, i, age), 2);
+            p = put_le(p, (uint64_t)RABBIT_FIELD(sim, i, maturity_age), 2);
+            p = put_le(p, flags, 1);
+            p = put_le(p, (uint64_t)RABBIT_FIELD(sim, i, nb_litters_y), 1);
+            p = put_le(p, (uint64_t)RABBIT_FIELD(sim, i, nb_litters), 1);
+            if (with_rates)
+                p = put_le(p, float_bits(RABBIT_FIELD(sim, i, survival_rate)), 4);
+        }
+        size_t size = (size_t)(p - block);
+        if (fwrite(block, 1, size, f->fp) != size)
+            f->ok = 0;
+    }
+}
+
+/**
+ * @brief Reads the rabbits written by write_rabbits into an instance with room for them.
+ *        The static method keeps no rate, the rabbits of the array-of-structures storage get the one they were created with.
+ * @param f The checkpoint file.
+ * @param sim The simulation instance.
+ * @param count The number of rabbits.
+ * @param with_rates 1 if the survival rates were written.
+ * @return void
+ */
+static void read_rabbits(s_checkpoint_file *f, s_simulation_instance *sim, size_t count, int with_rates)
+{
+    uint8_t block[CHECKPOINT_BLOCK * (CHECKPOINT_RABBIT_SIZE + 4)];
+    size_t record = CHECKPOINT_RABBIT_SIZE + (with_rates ? 4 : 0);
+    for (size_t start = 0; start < count && f->ok; start += CHECKPOINT_BLOCK)
+    {
+        size_t end = (start + CHECKPOINT_BLOCK < count) ? start + CHECKPOINT_BLOCK : count;
+        if (fread(block, record, end - start, f->fp) != end - start)
+        {
+            f->ok = 0;
+            return;
+        }
+        const uint8_t *p = block;
+        for (size_t i = start; i < end; ++i, p += record)
+        {
+            unsigned flags = (unsigned)p[4];
+#if RABBIT_STORAGE_SOA
+            sim->columns.flags[i] = 0;
+#endif
+            RABBIT_FIELD(sim, i, age) = (uint16_t)get_le(p, 2);
+            RABBIT_FIELD(sim, i, maturity_age) = (uint16_t)get_le(p + 2, 2);
+            RABBIT_SET_FLAG(sim, i, sex, (flags >> RABBIT_BIT_sex) & 1);
+            RABBIT_SET_FLAG(sim, i, status, (flags >> RABBIT_BIT_status) & 1);
+            RABBIT_SET_FLAG(sim, i, mature, (flags >> RABBIT_BIT_mature) & 1);
+            RABBIT_SET_FLAG(sim, i, pregnant, (flags >> RABBIT_BIT_pregnant) & 1);
+            RABBIT_SET_FLAG(sim, i, survival_check_flag, (flags >> RABBIT_BIT_survival_check_flag) & 1);
+            RABBIT_FIELD(sim, i, nb_litters_y) = p[5];
+            RABBIT_FIELD(sim, i, nb_litters) = p[6];
+            if (with_rates)
+            {
+                RABBIT_FIELD(sim, i, survival_rate) = bits_float((uint32_t)get_le(p + 7, 4));
+            }
+            else
+            {
+#if !RABBIT_STORAGE_SOA
+                int founder = RABBIT_FLAG(sim, i, mature) && RABBIT_FIELD(sim, i, maturity_age) == 0;
+                RABBIT_FIELD(sim, i, survival_rate) =
+                    calculate_survival_rate_static(founder ? sim->founder_rate : sim->survival.init_rate);
+#endif
+            }
+        }
+    }
+}
+
+/**
+ * @brief Writes the cohorts, encoded CHECKPOINT_BLOCK at a time.
+ * @param f The checkpoint file.
+ * @param sim The simulation instance.
+ * @return void
+ */
+static void write_cohorts(s_checkpoint_file *f, const s_simulation_instance *sim)
+{
+    uint8_t block[CHECKPOINT_BLOCK * CHECKPOINT_COHORT_SIZE];
+    for (size_t start = 0; start < sim->cohort_count && f->ok; start += CHECKPOINT_BLOCK)
+    {
+        size_t end = (start + CHECKPOINT_BLOCK < sim->cohort_count) ? start + CHECKPOINT_BLOCK : sim->cohort_count;
+        uint8_t *p = block;
+        for (size_t c = start; c < end; ++c)
+        {
+            const s_cohort *cohort = &sim->cohorts[c];
+            p = put_le(p, (uint64_t)cohort->count, 8);
+            p = put_le(p, float_bits(cohort->survival_rate), 4);
+            p = put_le(p, cohort->age, 2);
+            p = put_le(p, cohort->maturity_age, 2);
+            p = put_le(p, cohort->sex, 1);
+            p = put_le(p, cohort->mature, 1);
+            p = put_le(p, cohort->pregnant, 1);
+            p = put_le(p, cohort->nb_litters_y, 1);
+            p = put_le(p, cohort->nb_litters, 1);
+        }
+        size_t size = (size_t)(p - block);
+        if (fwrite(block, 1, size, f->fp) != size)
+            f->ok = 0;
+    }
+}
+
+/**
+ * @brief Reads the cohorts written by write_cohorts into an instance with room for them.
+ * @param f The checkpoint file.
+ * @param sim The simulation instance.
+ * @param count The number of cohorts.
+ * @return void
+ */
+static void read_cohorts(s_checkpoint_file *f, s_simulation_instance *sim, size_t count)
+{
+    uint8_t block[CHECKPOINT_BLOCK * CHECKPOINT_COHORT_SIZE];
+    for (size_t start = 0; start < count && f->ok; start += CHECKPOINT_BLOCK)
+    {
+        size_t end = (start + CHECKPOINT_BLOCK < count) ? start + CHECKPOINT_BLOCK : count;
+        if (fread(block, CHECKPOINT_COHORT_SIZE, end - start, f->fp) != end - start)
+        {
+            f->ok = 0;
+            return;
+        }
+        const uint8_t *p = block;
+        for (size_t c = start; c < end; ++c, p += CHECKPOINT_COHORT_SIZE)
+        {
+            s_cohort *cohort = &sim->cohorts[c];
+            cohort->count = (long long)get_le(p, 8);
+            cohort->survival_rate = bits_float((uint32_t)get_le(p + 8, 4));
+            cohort->age = (uint16_t)get_le(p + 12, 2);
+            cohort->maturity_age = (uint16_t)get_le(p + 14, 2);
+            cohort->sex = p[16];
+            cohort->mature = p[17];
+            cohort->pregnant = p[18];
+            cohort->nb_litters_y = p[19];
+            cohort->nb_litters = p[20];
+        }
+    }
+}
+
+/**
+ * @brief Writes or reads the recorded monthly statistics.
+ * @param f The checkpoint file.
+ * @param data The statistics.
+ * @param count The number of months.
+ * @param writing 1 to write them, 0 to read them.
+ * @return void
+ */
+static void transfer_months(s_checkpoint_file *f, s_monthly_stats *data, int count, int writing)
+{
+    for (int m = 0; m < count && f->ok; ++m)
+    {
+        s_monthly_stats *s = &data[m];
+        int *fields[] = { &s->month, &s->total_alive, &s->males, &s->females, &s->mature_rabbits,
+                          &s->pregnant_females, &s->births_this_month, &s->deaths_this_month,
+                          &s->min_age, &s->max_age };
+        uint8_t bytes[CHECKPOINT_MONTH_SIZE];
+        if (writing)
+        {
+            uint8_t *p = bytes;
+            for (size_t k = 0; k < sizeof(fields) / sizeof(fields[0]); ++k)
+                p = put_le(p, (uint32_t)*fields[k], 4);
+            put_le(p, float_bits(s->avg_age), 4);
+            if (fwrite(bytes, 1, sizeof(bytes), f->fp) != sizeof(bytes))
+                f->ok = 0;
+        }
+        else
+        {
+            if (fread(bytes, 1, sizeof(bytes), f->fp) != sizeof(bytes))
+            {
+                f->ok = 0;
+                return;
+            }
+            const uint8_t *p = bytes;
+            for (size_t k = 0; k < sizeof(fields) / sizeof(fields[0]); ++k, p += 4)
+                *fields[k] = (int)(uint32_t)get_le(p, 4);
+            s->avg_age = bits_float((uint32_t)get_le(p, 4));
+        }
+    }
+}
+
+/**
+ * @brief Writes or reads the recorded age rows.
+ * @param f The checkpoint file.
+ * @param rows The age rows.
+ * @param count The number of rows.
+ * @param writing 1 to write them, 0 to read them.
+ * @return void
+ */
+static void transfer_age_rows(s_checkpoint_file *f, s_age_row *rows, size_t count, int writing)
+{
+    for (size_t r = 0; r < count && f->ok; ++r)
+    {
+        s_age_row *row = &rows[r];
+        uint8_t bytes[CHECKPOINT_AGE_ROW_SIZE];
+        if (writing)
+        {
+            uint8_t *p = put_le(bytes, (uint32_t)row->month, 4);
+            p = put_le(p, (uint32_t)row->age, 4);
+            for (int c = 0; c < NB_AGE_CLASSES; ++c)
+                p = put_le(p, (uint64_t)row->counts[c], 8);
+            if (fwrite(bytes, 1, sizeof(bytes), f->fp) != sizeof(bytes))
+                f->ok = 0;
+        }
+        else
+        {
+            if (fread(bytes, 1, sizeof(bytes), f->fp) != sizeof(bytes))
+            {
+                f->ok = 0;
+                return;
+            }
+            row->month = (int)(uint32_t)get_le(bytes, 4);
+            row->age = (int)(uint32_t)get_le(bytes + 4, 4);
+            for (int c = 0; c < NB_AGE_CLASSES; ++c)
+                row->counts[c] = (long long)get_le(bytes + 8 + 8 * c, 8);
+        }
+    }
+}
+
+/**
+ * @brief Saves a running simulation, at the start of month progress->month, to its checkpoint file.
+ *        The file is written next to the previous checkpoint and only replaces it once complete.
+ * @param target The checkpoint file and the simulation it belongs to.
+ * @param sim The simulation instance.
+ * @param rng The generator of the simulation.
+ * @param progress The progress of simulate.
+ * @return 1 on success, 0 if the file could not be written.
+ */
+int write_checkpoint(s_checkpoint_target *target, const s_simulation_instance *sim,
+                     const pcg32x_random_t *rng, const s_simulation_progress *progress)
+{
+    char temp_path[sizeof(target->path) + 4];
+    snprintf(temp_path, sizeof(temp_path), "%s.tmp", target->path);
+    s_checkpoint_file f = { fopen(temp_path, "wb"), 1 };
+    if (!f.fp)
+    {
+        LOG_PRINT("Warning: Could not create checkpoint file %s\n", temp_path);
+        return 0;
+    }
+
+    int with_rates = (sim->survival.method != SURVIVAL_STATIC);
+    int monthly_count = sim->monthly_data ? sim->monthly_data_count : 0;
+    size_t age_row_count = sim->age_rows ? sim->age_row_count : 0;
+
+    if (fwrite(CHECKPOINT_MAGIC, 1, 8, f.fp) != 8)
+        f.ok = 0;
+    write_value(&f, CHECKPOINT_VERSION, 4);
+    transfer_identity(&f, target, &sim->survival, 1);
+
+    // Progress of the loop of simulate
+    write_value(&f, (uint64_t)progress->month, 4);
+    write_value(&f, (uint64_t)progress->peak_population, 4);
+    write_value(&f, (uint64_t)progress->peak_month, 4);
+    write_value(&f, (uint64_t)progress->min_population, 4);
+    write_value(&f, (uint64_t)progress->min_month, 4);
+    write_value(&f, (uint64_t)progress->actual_months, 4);
+    write_value(&f, (uint64_t)progress->population_sum, 8);
+    write_value(&f, (uint64_t)progress->cohort_switch_month, 4);
+    write_value(&f, (uint64_t)progress->rabbit_updates, 8);
+
+    // Counters of the instance
+    write_value(&f, (uint64_t)sim->engine, 4);
+    write_value(&f, sim->rabbit_count, 8);
+    write_value(&f, sim->dead_rabbit_count, 8);
+    write_value(&f, (uint64_t)sim->sex_distribution[0], 4);
+    write_value(&f, (uint64_t)sim->sex_distribution[1], 4);
+    write_value(&f, (uint64_t)sim->deaths_this_month, 4);
+    write_value(&f, (uint64_t)sim->births_this_month, 4);
+    write_value(&f, (uint64_t)sim->stats.pregnant_females, 4);
+    write_value(&f, (uint64_t)sim->last_births, 8);
+    write_value(&f, float_bits(sim->founder_rate), 4);
+    write_value(&f, sim->cohort_count, 8);
+    write_value(&f, (uint64_t)sim->cohort_alive, 8);
+    write_value(&f, (uint64_t)monthly_count, 4);
+    write_value(&f, (uint64_t)with_rates, 4);
+    write_value(&f, age_row_count, 8);
+
+    // Generator: the outputs drawn since it was seeded for this simulation
+    write_value(&f, pcg32x_outputs_drawn(rng), 8);
+
+    write_rabbits(&f, sim, with_rates);
+    write_cohorts(&f, sim);
+    transfer_months(&f, sim->monthly_data, monthly_count, 1);
+    transfer_age_rows(&f, sim->age_rows, age_row_count, 1);
+    write_value(&f, CHECKPOINT_END, 4);
+
+    if (fclose(f.fp) != 0)
+        f.ok = 0;
+    if (!f.ok || rename(temp_path, target->path) != 0)
+    {
+        LOG_PRINT("Warning: Could not write checkpoint file %s\n", target->path);
+        remove(temp_path);
+        return 0;
+    }
+    target->owned = 1;
+    return 1;
+}
+
+/**
+ * @brief Restores a simulation from its checkpoint file, after simulate has prepared the instance
+ *        (survival storage, threshold table, monthly logging) as for a new run.
+ * @param target The checkpoint file and the simulation it must belong to.
+ * @param sim The simulation instance, without any rabbit yet.
+ * @param rng Receives the generator of the simulation, seeded for it and advanced to the checkpointed month.
+ * @param progress Receives the progress of simulate.
+ * @return 1 if the simulation was restored, 0 if there is no usable checkpoint (the instance and the generator are then left as they were).
+ */
+int read_checkpoint(s_checkpoint_target *target, s_simulation_instance *sim,
+                    pcg32x_random_t *rng, s_simulation_progress *progress)
+{
+    s_checkpoint_file f = { fopen(target->path, "rb"), 1 };
+    if (!f.fp)
+        return 0;
+
+    char magic[8];
+    if (fread(magic, 1, 8, f.fp) != 8 || memcmp(magic, CHECKPOINT_MAGIC, 8) != 0 ||
+        read_value(&f, 4) != CHECKPOINT_VERSION || !transfer_identity(&f, target, &sim->survival, 0))
+    {
+        LOG_PRINT("Warning: %s belongs to another simulation, starting over\n", target->path);
+        fclose(f.fp);
+        return 0;
+    }
+
+    s_simulation_progress p;
+    p.month = (int)read_value(&f, 4);
+    p.peak_population = (int)read_value(&f, 4);
+    p.peak_month = (int)read_value(&f, 4);
+    p.min_population = (int)read_value(&f, 4);
+    p.min_month = (int)read_value(&f, 4);
+    p.actual_months = (int)read_value(&f, 4);
+    p.population_sum = (long long)read_value(&f, 8);
+    p.cohort_switch_month = (int)read_value(&f, 4);
+    p.rabbit_updates = (long long)read_value(&f, 8);
+
+    simulation_engine_t engine = (simulation_engine_t)read_value(&f, 4);
+    size_t rabbit_count = (size_t)read_value(&f, 8);
+    size_t dead_rabbit_count = (size_t)read_value(&f, 8);
+    int sex_distribution[2];
+    sex_distribution[0] = (int)read_value(&f, 4);
+    sex_distribution[1] = (int)read_value(&f, 4);
+    int deaths_this_month = (int)read_value(&f, 4);
+    int births_this_month = (int)read_value(&f, 4);
+    s_population_stats stats;
+    stats.pregnant_females = (int)read_value(&f, 4);
+    long long last_births = (long long)read_value(&f, 8);
+    float founder_rate = bits_float((uint32_t)read_value(&f, 4));
+    size_t cohort_count = (size_t)read_value(&f, 8);
+    long long cohort_alive = (long long)read_value(&f, 8);
+    int monthly_count = (int)read_value(&f, 4);
+    int with_rates = (int)read_value(&f, 4);
+    size_t age_row_count = (size_t)read_value(&f, 8);
+
+    // The generator of the caller is only replaced once the whole file has been read
+    uint64_t outputs_drawn = read_value(&f, 8);
+
+    // Room for the rabbits, the cohorts and the months
+    sim->founder_rate = founder_rate;
+    if (f.ok && (with_rates != (sim->survival.method != SURVIVAL_STATIC) || !reserve_rabbits(sim, rabbit_count)))
+        f.ok = 0;
+    if (f.ok && cohort_count > sim->cohort_capacity)
+    {
+        s_cohort *temp = realloc(sim->cohorts, sizeof(s_cohort) * cohort_count);
+        if (temp)
+        {
+            sim->cohorts = temp;
+            sim->cohort_capacity = cohort_count;
+        }
+        else
+            f.ok = 0;
+    }
+    if (monthly_count > 0 && (!sim->monthly_data || monthly_count > sim->monthly_data_capacity))
+        monthly_count = -monthly_count;  // This run does not log the simulation, the months are skipped
+    if (f.ok && monthly_count >= 0 && age_row_count > sim->age_rows_allocated)
+    {
+        s_age_row *temp = realloc(sim->age_rows, sizeof(s_age_row) * age_row_count);
+        if (temp)
+        {
+            sim->age_rows = temp;
+            sim->age_rows_allocated = age_row_count;
+        }
+        else
+            f.ok = 0;
+    }
+
+    read_rabbits(&f, sim, rabbit_count, with_rates);
+    read_cohorts(&f, sim, cohort_count);
+    if (monthly_count >= 0)
+    {
+        transfer_months(&f, sim->monthly_data, monthly_count, 0);
+        transfer_age_rows(&f, sim->age_rows, age_row_count, 0);
+    }
+    else if (f.ok && fseek(f.fp, (long)(-monthly_count) * CHECKPOINT_MONTH_SIZE +
+                                 (long)age_row_count * CHECKPOINT_AGE_ROW_SIZE, SEEK_CUR) != 0)
+    {
+        f.ok = 0;
+    }
+    if (read_value(&f, 4) != CHECKPOINT_END)
+        f.ok = 0;
+    fclose(f.fp);
+
+    if (!f.ok)
+    {
+        LOG_PRINT("Warning: Could not read checkpoint file %s, starting over\n", target->path);
+        return 0;
+    }
+
+    sim->engine = engine;
+    sim->rabbit_count = rabbit_count;
+    sim->dead_rabbit_count = dead_rabbit_count;
+    sim->free_count = 0;
+    sim->sex_distribution[0] = sex_distribution[0];
+    sim->sex_distribution[1] = sex_distribution[1];
+    sim->deaths_this_month = deaths_this_month;
+    sim->births_this_month = births_this_month;
+    sim->stats = stats;
+    sim->last_births = last_births;
+    sim->cohort_count = cohort_count;
+    sim->cohort_alive = cohort_alive;
+    if (monthly_count >= 0 && sim->monthly_data)
+    {
+        sim->monthly_data_count = monthly_count;
+        sim->age_row_count = age_row_count;
+    }
+    // Same seed as multi_simulate, then a jump over the outputs the months before drew
+    pcg32x_srandom_r(rng, target->base_seed, (uint64_t)(target->sim_number - 1));
+    pcg32x_advance_r(rng, outputs_drawn);
+    *progress = p;
+    target->owned = 1;
+    return 1;
+}
+
+/**
+ * @brief Deletes the checkpoint file of a simulation that completed, unless it belongs to another simulation.
+ * @param target The checkpoint file.
+ * @return void
+ */
+void remove_checkpoint(const s_checkpoint_target *target)
+{
+    if (target->owned)
+        remove(target->path);
+}
@@ -0,0 +1,45 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+// Checkpoints of running simulations.
+// Every checkpoint_interval months simulate saves everything the rest of the run depends on
+// (rabbits or cohorts, counters, monthly statistics, the progress of its loop and the number of
+// outputs its generator drew) to a ".rck" file, and a simulation started with checkpoint_resume
+// continues from its file exactly as if it had never stopped. The generator is rebuilt from the
+// seed of the simulation (base_seed and its number, as multi_simulate seeds it) and jumped ahead
+// with pcg32x_advance_r, without drawing the outputs of the months before.
+// The rabbits are written in small blocks through the stdio buffer, never copied as a whole,
+// and the file replaces the previous checkpoint only once it is complete.
+// File layout (little-endian): header, generator, rabbits, cohorts, monthly statistics, age rows, end marker.
+
+#include "rabbitsim.h"
+
+#define CHECKPOINT_MAGIC "RABBITCK"
+#define CHECKPOINT_VERSION 4
+
+// Rabbits or cohorts encoded per fwrite
+#define CHECKPOINT_BLOCK 4096
+
+// Global variables for the months between two checkpoints (0 for none) and resuming from the checkpoint files
+extern int checkpoint_interval;
+extern int checkpoint_resume;
+
+// Checkpoint file of one simulation of multi_simulate, and what identifies the simulation
+typedef struct checkpoint_target {
+    char path[256];              // File name
+    uint64_t base_seed;          // Base seed of the run
+    int sim_number;              // Simulation number (from 1)
+    int months;                  // Months requested
+    int initial_population;      // Initial population size
+    int owned;                   // 1 once the file was written or resumed for this simulation
+} s_checkpoint_target;
+
+void checkpoint_target_for(s_checkpoint_target *target, uint64_t base_seed, int sim_number, int months,
+                           int initial_population);
+int write_checkpoint(s_checkpoint_target *target, const s_simulation_instance *sim,
+                     const pcg32x_random_t *rng, const s_simulation_progress *progress);
+int read_checkpoint(s_checkpoint_target *target, s_simulation_instance *sim,
+                    pcg32x_random_t *rng, s_simulation_progress *progress);
+void remove_checkpoint(const s_checkpoint_target *target);
+
+#endif
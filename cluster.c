@@ -0,0 +1,291 @@
+#include "cluster.h"
+
+#if defined(USE_MPI) && USE_MPI != 0
+#include <mpi.h>
+
+static int cluster_rank_id = 0;
+static int cluster_nb_ranks = 1;
+#endif
+
+/**
+ * @brief Starts MPI (once, from main) and reads the rank of this process.
+ * @param argc A pointer to the argument count of main.
+ * @param argv A pointer to the arguments of main.
+ * @return void
+ */
+void cluster_init(int *argc, char ***argv)
+{
+#if defined(USE_MPI) && USE_MPI != 0
+    // The OpenMP threads never call MPI, only the thread running main does
+    int provided;
+    MPI_Init_thread(argc, argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &cluster_rank_id);
+    MPI_Comm_size(MPI_COMM_WORLD, &cluster_nb_ranks);
+#else
+    (void)argc;
+    (void)argv;
+#endif
+}
+
+/**
+ * @brief Stops MPI before the program exits.
+ * @return void
+ */
+void cluster_finalize(void)
+{
+#if defined(USE_MPI) && USE_MPI != 0
+    MPI_Finalize();
+#endif
+}
+
+/**
+ * @brief Gets the rank of this process.
+ * @return The rank, 0 for the process writing the results.
+ */
+int cluster_rank(void)
+{
+#if defined(USE_MPI) && USE_MPI != 0
+    return cluster_rank_id;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Gets the number of processes of the run.
+ * @return The number of ranks (1 without MPI).
+ */
+int cluster_size(void)
+{
+#if defined(USE_MPI) && USE_MPI != 0
+    return cluster_nb_ranks;
+#else
+    return 1;
+#endif
+}
+
+/**
+ * @brief Gives the block of items (simulation indices) of this rank, the blocks of the ranks following each other.
+ * @param nb_items The number of items shared by the ranks.
+ * @param first Receives the first item of this rank.
+ * @param end Receives the item after the last one of this rank.
+ * @return void
+ */
+void cluster_share(int nb_items, int *first, int *end)
+{
+    int rank = cluster_rank(), size = cluster_size();
+    *first = (int)((long long)nb_items * rank / size);
+    *end = (int)((long long)nb_items * (rank + 1) / size);
+}
+
+/**
+ * @brief Gives every rank the seed of rank 0 (the default seed depends on the time and the process).
+ * @param seed A pointer to the seed, replaced by the one of rank 0.
+ * @return void
+ */
+void cluster_broadcast_seed(uint64_t *seed)
+{
+#if defined(USE_MPI) && USE_MPI != 0
+    MPI_Bcast(seed, 1, MPI_UINT64_T, 0, MPI_COMM_WORLD);
+#else
+    (void)seed;
+#endif
+}
+
+/**
+ * @brief Tells every rank whether a flag is set on all of them (to skip together something one rank could not allocate).
+ * @param flag The flag of this rank.
+ * @return 1 if the flag is set on every rank, 0 otherwise.
+ */
+int cluster_all(int flag)
+{
+#if defined(USE_MPI) && USE_MPI != 0
+    int all = 0;
+    MPI_Allreduce(&flag, &all, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+    return all;
+#else
+    return flag;
+#endif
+}
+
+// Largest number of values reduced in one call
+#define CLUSTER_MAX_VALUES 32
+
+/**
+ * @brief Sums counters over the ranks, the sums replace the counters of rank 0.
+ * @param values Pointers to the counters of this rank (at most CLUSTER_MAX_VALUES).
+ * @param count The number of counters.
+ * @return void
+ */
+void cluster_sum_ll(long long *const *values, int count)
+{
+#if defined(USE_MPI) && USE_MPI != 0
+    long long packed[CLUSTER_MAX_VALUES];
+    for (int v = 0; v < count; ++v)
+        packed[v] = *values[v];
+    if (cluster_rank_id == 0)
+        MPI_Reduce(MPI_IN_PLACE, packed, count, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    else
+        MPI_Reduce(packed, NULL, count, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    for (int v = 0; v < count; ++v)
+        *values[v] = packed[v];
+#else
+    (void)values;
+    (void)count;
+#endif
+}
+
+/**
+ * @brief Sums counters over the ranks, the sums replace the counters of rank 0.
+ * @param values Pointers to the counters of this rank (at most CLUSTER_MAX_VALUES).
+ * @param count The number of counters.
+ * @return void
+ */
+void cluster_sum_int(int *const *values, int count)
+{
+#if defined(USE_MPI) && USE_MPI != 0
+    int packed[CLUSTER_MAX_VALUES];
+    for (int v = 0; v < count; ++v)
+        packed[v] = *values[v];
+    if (cluster_rank_id == 0)
+        MPI_Reduce(MPI_IN_PLACE, packed, count, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+    else
+        MPI_Reduce(packed, NULL, count, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+    for (int v = 0; v < count; ++v)
+        *values[v] = packed[v];
+#else
+    (void)values;
+    (void)count;
+#endif
+}
+
+/**
+ * @brief Sums times over the ranks, the sums replace the times of rank 0.
+ * @param values Pointers to the times of this rank (at most CLUSTER_MAX_VALUES).
+ * @param count The number of times.
+ * @return void
+ */
+void cluster_sum_double(double *const *values, int count)
+{
+#if defined(USE_MPI) && USE_MPI != 0
+    double packed[CLUSTER_MAX_VALUES];
+    for (int v = 0; v < count; ++v)
+        packed[v] = *values[v];
+    if (cluster_rank_id == 0)
+        MPI_Reduce(MPI_IN_PLACE, packed, count, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    else
+        MPI_Reduce(packed, NULL, count, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    for (int v = 0; v < count; ++v)
+        *values[v] = packed[v];
+#else
+    (void)values;
+    (void)count;
+#endif
+}
+
+/**
+ * @brief Takes the maximum of a value over the ranks, which replaces the value of rank 0.
+ * @param value A pointer to the value of this rank.
+ * @return void
+ */
+void cluster_max_double(double *value)
+{
+#if defined(USE_MPI) && USE_MPI != 0
+    if (cluster_rank_id == 0)
+        MPI_Reduce(MPI_IN_PLACE, value, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    else
+        MPI_Reduce(value, NULL, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+#else
+    (void)value;
+#endif
+}
+
+/**
+ * @brief Gathers the results of every simulation on rank 0, in simulation order.
+ *        The ranks only share identical builds, so the results travel as raw structures.
+ * @param results On rank 0 the results of all nb_items simulations, its own block first;
+ *                on the other ranks the results of their block only.
+ * @param nb_items The total number of simulations.
+ * @return void
+ */
+void cluster_gather_results(s_simulation_results *results, int nb_items)
+{
+#if defined(USE_MPI) && USE_MPI != 0
+    MPI_Datatype result_type;
+    MPI_Type_contiguous((int)sizeof(s_simulation_results), MPI_BYTE, &result_type);
+    MPI_Type_commit(&result_type);
+
+    int first, end;
+    cluster_share(nb_items, &first, &end);
+    if (cluster_rank_id == 0)
+    {
+        int *counts = malloc(sizeof(int) * cluster_nb_ranks);
+        int *displacements = malloc(sizeof(int) * cluster_nb_ranks);
+        if (counts && displacements)
+        {
+            for (int r = 0; r < cluster_nb_ranks; ++r)
+            {
+                displacements[r] = (int)((long long)nb_items * r / cluster_nb_ranks);
+                counts[r] = (int)((long long)nb_items * (r + 1) / cluster_nb_ranks) - displacements[r];
+            }
+            MPI_Gatherv(MPI_IN_PLACE, 0, result_type, results, counts, displacements, result_type, 0, MPI_COMM_WORLD);
+        }
+        else
+        {
+            LOG_PRINT("Error: Could not allocate the gather of the results, MPI is aborted\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        free(counts);
+        free(displacements);
+    }
+    else
+    {
+        MPI_Gatherv(results, end - first, result_type, NULL, NULL, NULL, result_type, 0, MPI_COMM_WORLD);
+    }
+    MPI_Type_free(&result_type);
+#else
+    (void)results;
+    (void)nb_items;
+#endif
+}
+
+/**
+ * @brief Merges the ensemble accumulators of every rank into the one of rank 0, in rank order
+ *        so that a run always gives the same file.
+ * @param ensemble The accumulator of this rank (its threads already merged, not finished yet).
+ * @return void
+ */
+void cluster_merge_ensemble(s_ensemble *ensemble)
+{
+#if defined(USE_MPI) && USE_MPI != 0
+    MPI_Datatype month_type;
+    MPI_Type_contiguous((int)sizeof(s_ensemble_month), MPI_BYTE, &month_type);
+    MPI_Type_commit(&month_type);
+
+    if (cluster_rank_id == 0)
+    {
+        s_ensemble received;
+        if (!init_ensemble(&received, ensemble->nb_months))
+        {
+            LOG_PRINT("Error: Could not allocate the merge of the ensemble statistics, MPI is aborted\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        for (int r = 1; r < cluster_nb_ranks; ++r)
+        {
+            MPI_Recv(received.months, ensemble->nb_months, month_type, r, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Recv(received.extinctions, ensemble->nb_months, MPI_LONG_LONG, r, 1, MPI_COMM_WORLD,
+                     MPI_STATUS_IGNORE);
+            merge_ensemble(ensemble, &received);
+        }
+        free_ensemble(&received);
+    }
+    else
+    {
+        MPI_Send(ensemble->months, ensemble->nb_months, month_type, 0, 0, MPI_COMM_WORLD);
+        MPI_Send(ensemble->extinctions, ensemble->nb_months, MPI_LONG_LONG, 0, 1, MPI_COMM_WORLD);
+    }
+    MPI_Type_free(&month_type);
+#else
+    (void)ensemble;
+#endif
+}
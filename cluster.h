@@ -0,0 +1,34 @@
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+// Distribution of multi_simulate over several processes (MPI ranks), compiled in with "make mpi".
+// Every rank runs a contiguous block of the simulation indices (see cluster_share) with its own
+// OpenMP threads. Each simulation keeps its seed (base_seed, index), so the results of a run do not
+// depend on the number of ranks. The totals of the results box are reduced onto rank 0, which also
+// gathers the results of every simulation and the ensemble accumulators, and alone writes the summary
+// files and prints. Every rank writes the monthly logs of the simulations of its own block below
+// simulations_to_log, except into the single stream file (log_single_stream), which only rank 0 writes.
+// Without USE_MPI every function below behaves as the only rank of a one process run.
+
+#include "rabbitsim.h"
+#include "ensemble.h"
+
+#ifndef USE_MPI
+#define USE_MPI 0
+#endif
+
+void cluster_init(int *argc, char ***argv);
+void cluster_finalize(void);
+int cluster_rank(void);
+int cluster_size(void);
+void cluster_share(int nb_items, int *first, int *end);
+void cluster_broadcast_seed(uint64_t *seed);
+int cluster_all(int flag);
+void cluster_sum_ll(long long *const *values, int count);
+void cluster_sum_int(int *const *values, int count);
+void cluster_sum_double(double *const *values, int count);
+void cluster_max_double(double *value);
+void cluster_gather_results(s_simulation_results *results, int nb_items);
+void cluster_merge_ensemble(s_ensemble *ensemble);
+
+#endif
@@ -0,0 +1,576 @@
+#include "cohort.h"
+#include "variates.h"
+
+// Probability of each number of litters per year (3 to 9), same table as generate_litters_per_year
+static const double litters_per_year_prob[7] = {0.05, 0.10, 0.25, 0.30, 0.20, 0.07, 0.03};
+
+/**
+ * @brief Tail of the Stirling approximation of log(k!), used by the BTRD binomial sampler.
+ * @param k A non negative integer.
+ * @return log(k!) - [(k + 1/2) log(k + 1) - (k + 1) + log(2 pi) / 2].
+ */
+static double stirling_approx_tail(double k)
+{
+    static const double table[10] = {
+        0.08106146679532726, 0.04134069595540929, 0.02767792568499834,
+        0.02079067210376509, 0.01664469118982119, 0.01387612882307075,
+        0.01189670994589177, 0.01041126526197209, 0.009255462182712733,
+        0.008330563433362871
+    };
+    if (k < 10)
+        return table[(int)k];
+    double kp1 = k + 1.0;
+    double kp1sq = kp1 * kp1;
+    return (1.0 / 12.0 - (1.0 / 360.0 - 1.0 / 1260.0 / kp1sq) / kp1sq) / kp1;
+}
+
+/**
+ * @brief Draws the number of successes among n independent trials of probability p.
+ *        Small means use the geometric waiting time method, large ones use
+ *        Hormann's BTRD transformed rejection, so the cost does not grow with n.
+ * @param rng A pointer to the PCG random number generator state.
+ * @param n The number of trials.
+ * @param p The probability of success of each trial.
+ * @return A binomially distributed number between 0 and n.
+ */
+long long genrand_binomial(pcg32x_random_t *rng, long long n, double p)
+{
+    if (n <= 0 || !(p > 0.0))
+        return 0;
+    if (p >= 1.0)
+        return n;
+    if (p > 0.5)
+        return n - genrand_binomial(rng, n, 1.0 - p);
+
+    if ((double)n * p < 10.0)
+    {
+        // Count the successes by jumping from one to the next with geometric gaps
+        double log_q = log1p(-p);
+        long long successes = 0;
+        double position = 0.0;
+        for (;;)
+        {
+            position += ceil(log(genrand_open(rng)) / log_q);
+            if (position > (double)n)
+                return successes;
+            successes++;
+        }
+    }
+
+    double count = (double)n;
+    double r = p / (1.0 - p);
+    double m = floor((count + 1.0) * p);
+    double npq = count * p * (1.0 - p);
+    double sqrt_npq = sqrt(npq);
+    double b = 1.15 + 2.53 * sqrt_npq;
+    double a = -0.0873 + 0.0248 * b + 0.01 * p;
+    double c = count * p + 0.5;
+    double alpha = (2.83 + 5.1 / b) * sqrt_npq;
+    double v_r = 0.92 - 4.2 / b;
+
+    for (;;)
+    {
+        double u = genrand_open(rng) - 0.5;
+        double v = genrand_open(rng);
+        double us = 0.5 - fabs(u);
+        double k = floor((2.0 * a / us + b) * u + c);
+
+        // Inside the tight box the candidate is accepted right away
+        if (us >= 0.07 && v <= v_r)
+            return (long long)k;
+        if (k < 0 || k > count)
+            continue;
+
+        // Exact acceptance test against log(f(k) / f(m))
+        v = log(v * alpha / (a / (us * us) + b));
+        double bound = (m + 0.5) * log((m + 1.0) / (r * (count - m + 1.0))) +
+                       (count + 1.0) * log((count - m + 1.0) / (count - k + 1.0)) +
+                       (k + 0.5) * log(r * (count - k + 1.0) / (k + 1.0)) +
+                       stirling_approx_tail(m) + stirling_approx_tail(count - m) -
+                       stirling_approx_tail(k) - stirling_approx_tail(count - k);
+        if (v <= bound)
+            return (long long)k;
+    }
+}
+
+/**
+ * @brief Computes the mean of the survival rates drawn by a survival method around a base rate.
+ *        A rabbit whose rate is drawn at random survives with the mean probability of that draw,
+ *        so a cohort can use this single value for all its members.
+ * @param params The survival parameters of the simulation.
+ * @param base_rate The base survival rate (percentage).
+ * @return The mean survival rate (percentage) of the method of params.
+ */
+float cohort_survival_rate(const s_survival_params *params, float base_rate)
+{
+    switch (params->method)
+    {
+        case SURVIVAL_GAUSSIAN:
+        {
+            // Mean of N(base_rate, sigma) clamped to [0, 100]
+            double mu = base_rate;
+            double sigma = params->gaussian_sigma;
+            double alpha = (0.0 - mu) / sigma;
+            double beta = (100.0 - mu) / sigma;
+            double pdf_alpha = exp(-0.5 * alpha * alpha) / sqrt(2.0 * M_PI);
+            double pdf_beta = exp(-0.5 * beta * beta) / sqrt(2.0 * M_PI);
+            double mean = 100.0 * (1.0 - normal_cdf(beta))
+                        + mu * (normal_cdf(beta) - normal_cdf(alpha))
+                        + sigma * (pdf_alpha - pdf_beta);
+            return (float)mean;
+        }
+
+        case SURVIVAL_EXPONENTIAL:
+        {
+            // Mean of min(100, base_rate * (1 - spread + spread * F)) with F exponential of rate lambda
+            if (base_rate <= 0.0f)
+                return 0.0f;
+            double lambda = -log(1.0 - base_rate / 100.0) / params->exponential_scale;
+            double a = (1.0 - params->exponential_spread) * base_rate;
+            double b = params->exponential_spread * base_rate;
+            if (a >= 100.0)
+                return 100.0f;
+            if (isinf(lambda))
+                return (float)a;
+            double cap = (100.0 - a) / b;
+            return (float)(a + b * (1.0 - exp(-lambda * cap)) / lambda);
+        }
+
+        case SURVIVAL_STATIC:
+        default:
+            return calculate_survival_rate_static(base_rate);
+    }
+}
+
+/**
+ * @brief Converts a survival rate (percentage) into the probability of passing the monthly survival check.
+ * @param survival_rate The survival rate.
+ * @return The survival probability in [0, 1].
+ */
+static double survival_probability(float survival_rate)
+{
+    if (!(survival_rate > 0.0f))
+        return 0.0;
+    if (survival_rate >= 100.0f)
+        return 1.0;
+    return survival_rate / 100.0;
+}
+
+/**
+ * @brief Appends a cohort to the simulation, growing the cohorts array if needed.
+ *        Empty cohorts are ignored. The rabbits of the cohort are already counted in sex_distribution:
+ *        if the array cannot grow they are taken out of it and counted in lost_rabbits (simulate stops then).
+ * @param sim A pointer to the s_simulation_instance.
+ * @param cohort The cohort to append.
+ * @return 1 on success, 0 if the cohort could not be stored.
+ */
+static int push_cohort(s_simulation_instance *sim, const s_cohort *cohort)
+{
+    if (cohort->count <= 0)
+        return 1;
+    if (sim->cohort_count == sim->cohort_capacity)
+    {
+        size_t new_capacity = (sim->cohort_capacity == 0) ? 256 : sim->cohort_capacity * 2;
+        s_cohort *temp = realloc(sim->cohorts, sizeof(s_cohort) * new_capacity);
+        if (!temp)
+        {
+            sim->sex_distribution[cohort->sex] -= (int)cohort->count;
+            sim->lost_rabbits += cohort->count;
+            return 0;
+        }
+        sim->cohorts = temp;
+        sim->cohort_capacity = new_capacity;
+    }
+    sim->cohorts[sim->cohort_count++] = *cohort;
+    return 1;
+}
+
+/**
+ * @brief Appends a cohort of newly created rabbits (same arguments as add_rabbit) to the simulation.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param count The number of rabbits.
+ * @param is_mature 1 if the rabbits are mature, 0 otherwise.
+ * @param init_srv_rate The initial survival rate of the rabbits.
+ * @param age The initial age of the rabbits.
+ * @param sex The sex of the rabbits.
+ * @return 1 on success, 0 if the cohort could not be stored.
+ */
+static int add_cohort(s_simulation_instance *sim, long long count, int is_mature, float init_srv_rate, int age, int sex)
+{
+    s_cohort cohort = {0};
+    cohort.count = count;
+    cohort.sex = (uint8_t)sex;
+    cohort.age = (uint16_t)age;
+    cohort.mature = (uint8_t)is_mature;
+    cohort.survival_rate = cohort_survival_rate(&sim->survival, init_srv_rate);
+
+    sim->sex_distribution[sex] += (int)count;
+    return push_cohort(sim, &cohort);
+}
+
+/**
+ * @brief Initializes the cohorts of a simulation, with the same starting population as simulate uses
+ *        for the individual engine ("super" rabbits for 2, random adults otherwise).
+ * @param sim A pointer to the s_simulation_instance.
+ * @param nb_rabbits The number of rabbits in the initial population.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return 1 on success, 0 if some rabbits could not be stored (see push_cohort).
+ */
+int init_cohort_population(s_simulation_instance *sim, int nb_rabbits, pcg32x_random_t *rng)
+{
+    int stored = 1;
+    if (nb_rabbits == 2)
+    {
+        stored &= add_cohort(sim, 1, 1, SUPER_SRV_RATE, 9, 0);
+        stored &= add_cohort(sim, 1, 1, SUPER_SRV_RATE, 9, 1);
+    }
+    else
+    {
+        for (int i = 0; i < nb_rabbits; ++i)
+        {
+            int age = generate_random_age(rng);
+            stored &= add_cohort(sim, 1, 1, sim->survival.adult_rate, age, generate_sex(rng));
+        }
+    }
+    merge_cohorts(sim);
+    return stored;
+}
+
+/**
+ * @brief Splits a cohort between the rabbits that become pregnant this month and the others,
+ *        then stores the resulting cohorts (same rule as can_be_pregnant_this_month).
+ * @param sim A pointer to the s_simulation_instance.
+ * @param cohort The cohort to split.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return 1 on success, 0 if a cohort could not be stored (see push_cohort).
+ */
+static int split_pregnancy(s_simulation_instance *sim, s_cohort *cohort, pcg32x_random_t *rng)
+{
+    int stored = 1;
+    int remaining_litters = cohort->nb_litters_y - cohort->nb_litters;
+    if (cohort->sex == 1 && remaining_litters > 0)
+    {
+        int remaining_months = 12 - (cohort->age - cohort->maturity_age) % 12;
+        float base_prob = (float)remaining_litters / remaining_months;
+
+        s_cohort pregnant = *cohort;
+        pregnant.count = genrand_binomial(rng, cohort->count, base_prob);
+        pregnant.pregnant = 1;
+        cohort->count -= pregnant.count;
+        stored = push_cohort(sim, &pregnant);
+    }
+    return push_cohort(sim, cohort) && stored;
+}
+
+/**
+ * @brief Draws the number of litters per year of a cohort reaching its maturity anniversary
+ *        (multinomial split over 3 to 9 litters), then splits each part by pregnancy.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param cohort The cohort to update.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return 1 on success, 0 if a cohort could not be stored (see push_cohort).
+ */
+static int split_litters_per_year(s_simulation_instance *sim, s_cohort *cohort, pcg32x_random_t *rng)
+{
+    if (cohort->sex == 1 && cohort->mature && (cohort->age - cohort->maturity_age) % 12 == 0)
+    {
+        int stored = 1;
+        long long remaining = cohort->count;
+        double remaining_prob = 1.0;
+        for (int j = 0; j < 7 && remaining > 0; ++j)
+        {
+            s_cohort part = *cohort;
+            part.nb_litters_y = (uint8_t)(3 + j);
+            part.count = (j == 6) ? remaining : genrand_binomial(rng, remaining, litters_per_year_prob[j] / remaining_prob);
+            remaining -= part.count;
+            remaining_prob -= litters_per_year_prob[j];
+            stored &= split_pregnancy(sim, &part, rng);
+        }
+        return stored;
+    }
+    return split_pregnancy(sim, cohort, rng);
+}
+
+/**
+ * @brief Draws the total number of kittens born from a number of litters, each litter having 3 to 6 kittens.
+ * @param rng A pointer to the PCG random number generator state.
+ * @param nb_litters The number of litters.
+ * @return The total number of kittens.
+ */
+static long long draw_litter_sizes(pcg32x_random_t *rng, long long nb_litters)
+{
+    // Multinomial split of the litters over 0 to 3 extra kittens (equally likely)
+    long long extra_0 = genrand_binomial(rng, nb_litters, 1.0 / 4.0);
+    long long extra_1 = genrand_binomial(rng, nb_litters - extra_0, 1.0 / 3.0);
+    long long extra_2 = genrand_binomial(rng, nb_litters - extra_0 - extra_1, 1.0 / 2.0);
+    long long extra_3 = nb_litters - extra_0 - extra_1 - extra_2;
+    return 3 * nb_litters + extra_1 + 2 * extra_2 + 3 * extra_3;
+}
+
+/**
+ * @brief Updates every cohort of the simulation for one month.
+ *        Follows the same steps, in the same order, as update_rabbits does for each rabbit:
+ *        aging, survival, survival rate update, maturity, litters per year, births and pregnancies.
+ *        As in update_rabbits, pregnant rabbits dying this month still give birth.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return 1 on success, 0 if some rabbits could not be stored (see push_cohort).
+ */
+int update_cohorts(s_simulation_instance *sim, pcg32x_random_t *rng)
+{
+    long long nb_new_born = 0;
+    int stored = 1;
+
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    sim->deaths_this_month = 0;
+    sim->births_this_month = 0;
+    #endif
+
+    size_t old_count = sim->cohort_count;
+    for (size_t c = 0; c < old_count; ++c)
+    {
+        // Work on a copy: the split cohorts are appended and may move the array
+        s_cohort cohort = sim->cohorts[c];
+        sim->cohorts[c].count = 0;
+
+        cohort.age += 1;
+
+        long long survivors = genrand_binomial(rng, cohort.count, survival_probability(cohort.survival_rate));
+        long long deaths = cohort.count - survivors;
+        sim->dead_rabbit_count += deaths;
+        sim->sex_distribution[cohort.sex] -= (int)deaths;
+        #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+        sim->deaths_this_month += (int)deaths;
+        #endif
+
+        if (cohort.pregnant)
+        {
+            nb_new_born += draw_litter_sizes(rng, cohort.count);
+            cohort.pregnant = 0;
+            cohort.nb_litters += 1;
+        }
+
+        if (survivors == 0)
+            continue;
+        cohort.count = survivors;
+
+        // Survival rate for next month, same rules as update_survival_rate
+        float base_rate = calculate_base_survival_rate_for(&sim->survival, cohort.mature, cohort.age);
+        if (sim->survival.method != SURVIVAL_STATIC)
+        {
+            cohort.survival_rate = cohort_survival_rate(&sim->survival, base_rate);
+        }
+        else if ((cohort.mature && cohort.age == cohort.maturity_age) ||
+                 (cohort.age >= sim->survival.penalty_age && (cohort.age - sim->survival.penalty_age) % 12 == 0))
+        {
+            cohort.survival_rate = calculate_survival_rate_static(base_rate);
+        }
+
+        if (!cohort.mature && cohort.age >= 5)
+        {
+            float chance = (float)cohort.age / 8.0f;
+            s_cohort matured = cohort;
+            matured.count = genrand_binomial(rng, cohort.count, chance);
+            matured.mature = 1;
+            matured.maturity_age = matured.age;
+            cohort.count -= matured.count;
+            if (matured.count > 0)
+                stored &= split_litters_per_year(sim, &matured, rng);
+        }
+        if (cohort.count > 0)
+            stored &= split_litters_per_year(sim, &cohort, rng);
+    }
+
+    // New generation, same sex draw as generate_sex
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    sim->births_this_month += (int)nb_new_born;
+    #endif
+    sim->last_births = nb_new_born;
+    long long males = genrand_binomial(rng, nb_new_born, 0.5);
+    stored &= add_cohort(sim, nb_new_born - males, 0, sim->survival.init_rate, 0, 0);
+    stored &= add_cohort(sim, males, 0, sim->survival.init_rate, 0, 1);
+
+    merge_cohorts(sim);
+    return stored;
+}
+
+/**
+ * @brief Orders cohorts by state so that identical ones end up next to each other.
+ * @param a A pointer to the first s_cohort.
+ * @param b A pointer to the second s_cohort.
+ * @return A negative, zero or positive value as for qsort.
+ */
+static int compare_cohorts(const void *a, const void *b)
+{
+    const s_cohort *x = a;
+    const s_cohort *y = b;
+    if (x->age != y->age) return (int)x->age - (int)y->age;
+    if (x->sex != y->sex) return (int)x->sex - (int)y->sex;
+    if (x->mature != y->mature) return (int)x->mature - (int)y->mature;
+    if (x->maturity_age != y->maturity_age) return (int)x->maturity_age - (int)y->maturity_age;
+    if (x->pregnant != y->pregnant) return (int)x->pregnant - (int)y->pregnant;
+    if (x->nb_litters_y != y->nb_litters_y) return (int)x->nb_litters_y - (int)y->nb_litters_y;
+    if (x->nb_litters != y->nb_litters) return (int)x->nb_litters - (int)y->nb_litters;
+    if (x->survival_rate != y->survival_rate) return (x->survival_rate < y->survival_rate) ? -1 : 1;
+    return 0;
+}
+
+/**
+ * @brief Removes empty cohorts and merges the ones sharing the same state,
+ *        then recomputes the number of living rabbits.
+ * @param sim A pointer to the s_simulation_instance.
+ * @return void
+ */
+void merge_cohorts(s_simulation_instance *sim)
+{
+    size_t kept = 0;
+    for (size_t c = 0; c < sim->cohort_count; ++c)
+    {
+        if (sim->cohorts[c].count > 0)
+            sim->cohorts[kept++] = sim->cohorts[c];
+    }
+    sim->cohort_count = kept;
+
+    if (kept > 1)
+        qsort(sim->cohorts, kept, sizeof(s_cohort), compare_cohorts);
+
+    size_t merged = 0;
+    long long alive = 0;
+    for (size_t c = 0; c < sim->cohort_count; ++c)
+    {
+        alive += sim->cohorts[c].count;
+        if (merged > 0 && compare_cohorts(&sim->cohorts[merged - 1], &sim->cohorts[c]) == 0)
+            sim->cohorts[merged - 1].count += sim->cohorts[c].count;
+        else
+            sim->cohorts[merged++] = sim->cohorts[c];
+    }
+    sim->cohort_count = merged;
+    sim->cohort_alive = alive;
+}
+
+/**
+ * @brief Moves the living rabbits of an individual simulation into cohorts and switches it to the cohort engine.
+ *        Rabbits are grouped by state (see merge_cohorts). For the random survival methods the drawn rate of
+ *        each rabbit is replaced by the mean rate of its draw, as update_cohorts would have computed it.
+ *        The rabbits array keeps its capacity but is emptied.
+ * @param sim A pointer to the s_simulation_instance.
+ * @return 1 on success, 0 if some rabbits could not be stored (see push_cohort).
+ */
+int convert_rabbits_to_cohorts(s_simulation_instance *sim)
+{
+    int stored = 1;
+    reset_cohorts(sim);
+
+    for (size_t i = 0; i < sim->rabbit_count; ++i)
+    {
+        s_cohort cohort = {0};
+        cohort.count = 1;
+        cohort.age = RABBIT_FIELD(sim, i, age);
+        cohort.maturity_age = RABBIT_FIELD(sim, i, maturity_age);
+        cohort.sex = RABBIT_FLAG(sim, i, sex);
+        cohort.mature = RABBIT_FLAG(sim, i, mature);
+        cohort.pregnant = RABBIT_FLAG(sim, i, pregnant);
+        cohort.nb_litters_y = RABBIT_FIELD(sim, i, nb_litters_y);
+        cohort.nb_litters = RABBIT_FIELD(sim, i, nb_litters);
+
+        if (sim->survival.method == SURVIVAL_STATIC)
+        {
+            // Same rate as the threshold table of the individual engine used for the next check
+            int founder = cohort.mature && cohort.maturity_age == 0;
+            cohort.survival_rate = static_survival_rate(&sim->survival,
+                founder ? sim->founder_rate : sim->survival.init_rate, cohort.age);
+        }
+        else
+        {
+            // The rate was drawn before the maturity update of last month
+            int was_mature = cohort.mature && cohort.maturity_age != cohort.age;
+            cohort.survival_rate = cohort_survival_rate(&sim->survival,
+                calculate_base_survival_rate_for(&sim->survival, was_mature, cohort.age));
+        }
+        stored &= push_cohort(sim, &cohort);
+
+        // Keep the array small: there are few distinct states compared to the number of rabbits
+        if (sim->cohort_count >= COHORT_CONVERT_MERGE)
+            merge_cohorts(sim);
+    }
+    merge_cohorts(sim);
+
+    sim->rabbit_count = 0;
+    sim->free_count = 0;
+    sim->stats = (s_population_stats){0};
+    sim->engine = ENGINE_COHORT;
+    return stored;
+}
+
+/**
+ * @brief Computes the age and reproduction statistics of the living rabbits from the cohorts,
+ *        as record_monthly_stats does from the rabbits array.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param age_sum Receives the sum of the ages.
+ * @param min_age Receives the minimum age (left untouched if there are no cohorts).
+ * @param max_age Receives the maximum age (left untouched if there are no cohorts).
+ * @param mature_rabbits Receives the number of mature rabbits.
+ * @param pregnant_females Receives the number of pregnant females.
+ * @return void
+ */
+void collect_cohort_stats(s_simulation_instance *sim, long long *age_sum, int *min_age, int *max_age,
+                          int *mature_rabbits, int *pregnant_females)
+{
+    for (size_t c = 0; c < sim->cohort_count; ++c)
+    {
+        const s_cohort *cohort = &sim->cohorts[c];
+        *age_sum += cohort->count * cohort->age;
+        if (cohort->age < *min_age) *min_age = cohort->age;
+        if (cohort->age > *max_age) *max_age = cohort->age;
+        if (cohort->mature)
+            *mature_rabbits += (int)cohort->count;
+        if (cohort->pregnant)
+            *pregnant_females += (int)cohort->count;
+    }
+}
+
+/**
+ * @brief Rebuilds the age histogram of a logged simulation from its cohorts, for the age structure
+ *        of the month (the cohorts age and die by whole groups, the histogram is not kept up to date).
+ * @param sim A pointer to the s_simulation_instance, with sim->ages started.
+ * @return void
+ */
+void fill_cohort_age_histogram(s_simulation_instance *sim)
+{
+    s_age_histogram *ages = &sim->ages;
+    clear_age_histogram(ages);
+    for (size_t c = 0; c < sim->cohort_count; ++c)
+    {
+        const s_cohort *cohort = &sim->cohorts[c];
+        if (cohort->age <= ages->origin)
+            AGE_HISTOGRAM_CELL(ages, cohort->age, AGE_CLASS(cohort->sex, cohort->mature)) += cohort->count;
+    }
+}
+
+/**
+ * @brief Counts the pregnant rabbits of the cohorts, which give birth during the next update.
+ * @param sim A pointer to the s_simulation_instance.
+ * @return The number of pregnant rabbits.
+ */
+long long count_pregnant_cohorts(const s_simulation_instance *sim)
+{
+    long long pregnant = 0;
+    for (size_t c = 0; c < sim->cohort_count; ++c)
+        if (sim->cohorts[c].pregnant)
+            pregnant += sim->cohorts[c].count;
+    return pregnant;
+}
+
+/**
+ * @brief Frees the cohorts array of a simulation instance.
+ * @param sim A pointer to the s_simulation_instance.
+ * @return void
+ */
+void reset_cohorts(s_simulation_instance *sim)
+{
+    free(sim->cohorts);
+    sim->cohorts = NULL;
+    sim->cohort_count = 0;
+    sim->cohort_capacity = 0;
+    sim->cohort_alive = 0;
+}
@@ -0,0 +1,42 @@
+#ifndef COHORT_H
+#define COHORT_H
+
+// Cohort-aggregated simulation engine.
+// Instead of one record per rabbit, rabbits sharing exactly the same state are stored
+// once with a count, and each monthly event (death, maturity, litters, pregnancy, births)
+// is drawn for the whole cohort with binomial/multinomial sampling.
+// A month therefore costs O(number of distinct cohorts) instead of O(population),
+// while every rabbit still follows the same probabilities as in update_rabbits.
+
+#include "rabbitsim.h"
+
+// Number of cohorts after which convert_rabbits_to_cohorts merges the cohorts built so far
+#define COHORT_CONVERT_MERGE 65536
+
+// Structure representing a group of identical rabbits.
+typedef struct cohort {
+    long long count;             // Number of rabbits in this cohort
+    float survival_rate;         // Survival rate used at the next survival check (mean rate for the random methods)
+    uint16_t age;                // Age in months
+    uint16_t maturity_age;       // The age at which the rabbits became mature
+    uint8_t sex;                 // 0 for female, 1 for male
+    uint8_t mature;              // 0 for immature, 1 for mature
+    uint8_t pregnant;            // 0 for not pregnant, 1 for pregnant
+    uint8_t nb_litters_y;        // Number of litters per year
+    uint8_t nb_litters;          // Number of litters already had
+} s_cohort;
+
+long long genrand_binomial(pcg32x_random_t *rng, long long n, double p);
+
+float cohort_survival_rate(const s_survival_params *params, float base_rate);
+int init_cohort_population(s_simulation_instance *sim, int nb_rabbits, pcg32x_random_t *rng);
+int update_cohorts(s_simulation_instance *sim, pcg32x_random_t *rng);
+void merge_cohorts(s_simulation_instance *sim);
+int convert_rabbits_to_cohorts(s_simulation_instance *sim);
+void collect_cohort_stats(s_simulation_instance *sim, long long *age_sum, int *min_age, int *max_age,
+                          int *mature_rabbits, int *pregnant_females);
+void fill_cohort_age_histogram(s_simulation_instance *sim);
+long long count_pregnant_cohorts(const s_simulation_instance *sim);
+void reset_cohorts(s_simulation_instance *sim);
+
+#endif
@@ -0,0 +1,286 @@
+#include "deme.h"
+
+#include <string.h>
+
+// Global variables for the demes of the individual engine, see deme.h
+int deme_count = 0;
+int migration_interval = DEFAULT_MIGRATION_INTERVAL;
+
+/**
+ * @brief Tells whether the population of a simulation is currently split into demes.
+ * @param sim A pointer to the s_simulation_instance.
+ * @return 1 if the rabbits live in the demes, 0 if they live in the instance itself.
+ */
+int has_demes(const s_simulation_instance *sim)
+{
+    return sim->demes && sim->demes->count > 0;
+}
+
+/**
+ * @brief Makes sure the deme set of a simulation instance holds at least nb_demes instances.
+ *        Instances already allocated keep their buffers; new ones start empty.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param nb_demes The number of demes needed.
+ * @return The deme set, or NULL if the allocation failed.
+ */
+static s_deme_set *reserve_demes(s_simulation_instance *sim, int nb_demes)
+{
+    if (!sim->demes)
+        sim->demes = calloc(1, sizeof(s_deme_set));
+    s_deme_set *set = sim->demes;
+    if (!set || nb_demes <= set->allocated)
+        return set;
+
+    s_simulation_instance *demes = realloc(set->demes, sizeof(s_simulation_instance) * nb_demes);
+    if (!demes)
+        return NULL;
+    set->demes = demes;
+    pcg32x_random_t *rngs = realloc(set->rngs, sizeof(pcg32x_random_t) * nb_demes);
+    if (!rngs)
+        return NULL;
+    set->rngs = rngs;
+    for (int d = set->allocated; d < nb_demes; ++d)
+        set->demes[d] = (s_simulation_instance){0};
+    set->allocated = nb_demes;
+    return set;
+}
+
+/**
+ * @brief Adds up the counters and statistics of the demes into their parent instance,
+ *        where simulate, record_monthly_stats and the results read them.
+ * @param sim A pointer to the parent s_simulation_instance.
+ * @return void
+ */
+static void collect_demes(s_simulation_instance *sim)
+{
+    s_deme_set *set = sim->demes;
+    size_t alive = 0, dead = 0;
+    int females = 0, males = 0;
+    long long last_births = 0;
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    s_population_stats stats = { 0 };
+    int births = 0, deaths = 0;
+    if (sim->ages.rows > 0)
+        clear_age_histogram(&sim->ages);
+    #endif
+
+    for (int d = 0; d < set->count; ++d)
+    {
+        s_simulation_instance *deme = &set->demes[d];
+        sim->lost_rabbits += deme->lost_rabbits;
+        deme->lost_rabbits = 0;
+        alive += deme->rabbit_count;
+        dead += deme->dead_rabbit_count;
+        females += deme->sex_distribution[0];
+        males += deme->sex_distribution[1];
+        last_births += deme->last_births;
+        #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+        births += deme->births_this_month;
+        deaths += deme->deaths_this_month;
+        stats.pregnant_females += deme->stats.pregnant_females;
+        // The demes age with their parent, their histograms have the same origin
+        if (sim->ages.rows > 0 && deme->ages.rows > 0)
+        {
+            sim->ages.origin = deme->ages.origin;
+            add_age_histogram(&sim->ages, &deme->ages);
+        }
+        #endif
+    }
+
+    set->alive = alive;
+    sim->dead_rabbit_count = set->dead_before_split + dead;
+    sim->sex_distribution[0] = females;
+    sim->sex_distribution[1] = males;
+    sim->last_births = last_births;
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    sim->births_this_month = births;
+    sim->deaths_this_month = deaths;
+    sim->stats = stats;
+    #endif
+}
+
+/**
+ * @brief Splits the rabbits of a simulation into demes of (nearly) equal size, in contiguous blocks.
+ *        Each deme gets its own generator stream, seeded from a seed drawn from rng and the deme number.
+ *        On failure the simulation keeps its rabbits and goes on as a single population.
+ * @param sim A pointer to the s_simulation_instance, with its initial population (individual engine).
+ * @param nb_demes The number of demes.
+ * @param rng A pointer to the PCG random number generator state of the simulation.
+ * @return 1 on success, 0 if the demes could not be allocated.
+ */
+int split_into_demes(s_simulation_instance *sim, int nb_demes, pcg32x_random_t *rng)
+{
+    s_deme_set *set = reserve_demes(sim, nb_demes);
+    if (!set)
+        return 0;
+    set->count = 0;
+
+    uint64_t split_seed = ((uint64_t)pcg32x_random_r(rng) << 32) | pcg32x_random_r(rng);
+    size_t initial = sim->initial_capacity ? sim->initial_capacity : INIT_RABIT_CAPACITY;
+    size_t deme_capacity = initial / nb_demes;
+    if (deme_capacity < MIN_RABBIT_CAPACITY)
+        deme_capacity = MIN_RABBIT_CAPACITY;
+
+    for (int d = 0; d < nb_demes; ++d)
+    {
+        s_simulation_instance *deme = &set->demes[d];
+        size_t first = sim->rabbit_count * d / nb_demes;
+        size_t count = sim->rabbit_count * (d + 1) / nb_demes - first;
+
+        rewind_population(deme);
+        deme->initial_capacity = deme_capacity;
+        deme->engine = ENGINE_INDIVIDUAL;
+        deme->update_threads = 0;
+        deme->deme_count = 0;
+        deme->stop_mode = STOP_NONE;
+        deme->survival = sim->survival;
+        deme->founder_rate = sim->founder_rate;
+        deme->static_thresholds = sim->static_thresholds;
+        deme->static_table_ages = sim->static_table_ages;
+        prepare_survival_storage(deme);
+        if (!reserve_rabbits(deme, count > deme_capacity ? count : deme_capacity) ||
+            !append_rabbits(deme, sim, first, count))
+            return 0;
+        #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+        // The parent logs the age structure summed over its demes
+        if (sim->ages.rows > 0 && !start_age_histogram(&deme->ages, sim->ages.rows, sim->ages.origin))
+            return 0;
+        #endif
+        deme->update_kernel = NULL;
+        select_update_kernel(deme);
+        refresh_population_stats(deme);
+        pcg32x_srandom_r(&set->rngs[d], split_seed, (uint64_t)d);
+    }
+
+    set->count = nb_demes;
+    set->months_since_migration = 0;
+    set->dead_before_split = sim->dead_rabbit_count;
+    sim->rabbit_count = 0;
+    sim->free_count = 0;
+    collect_demes(sim);
+    return 1;
+}
+
+/**
+ * @brief Moves rabbits from the demes holding more than their share of the population to the ones
+ *        holding less, taking them from the end of the arrays, until every deme holds its share.
+ *        Nothing is done while the largest deme stays within DEME_IMBALANCE_TOLERANCE of its share.
+ *        If a deme cannot grow, the migration stops there and the demes stay as they are.
+ * @param set The demes.
+ * @return void
+ */
+static void migrate_demes(s_deme_set *set)
+{
+    int n = set->count;
+    size_t total = 0, largest = 0;
+    for (int d = 0; d < n; ++d)
+    {
+        total += set->demes[d].rabbit_count;
+        if (set->demes[d].rabbit_count > largest)
+            largest = set->demes[d].rabbit_count;
+    }
+    if (largest <= (total / n + 1) * DEME_IMBALANCE_TOLERANCE)
+        return;
+
+    // Deme d ends with total / n rabbits, plus one for the first total % n demes
+    int donor = 0;
+    int moved = 1;
+    for (int d = 0; moved && d < n; ++d)
+    {
+        s_simulation_instance *receiver = &set->demes[d];
+        size_t share = total / n + ((size_t)d < total % n);
+        while (moved && receiver->rabbit_count < share)
+        {
+            size_t donor_share = total / n + ((size_t)donor < total % n);
+            s_simulation_instance *from = &set->demes[donor];
+            if (from->rabbit_count <= donor_share)
+            {
+                donor++;
+                continue;
+            }
+            size_t surplus = from->rabbit_count - donor_share;
+            size_t deficit = share - receiver->rabbit_count;
+            size_t block = surplus < deficit ? surplus : deficit;
+            moved = append_rabbits(receiver, from, from->rabbit_count - block, block);
+            if (moved)
+                from->rabbit_count -= block;
+        }
+    }
+
+    // Block moves leave the counts and statistics of both sides to recompute
+    #pragma omp parallel for schedule(static, 1) num_threads(n)
+    for (int d = 0; d < n; ++d)
+        refresh_population_stats(&set->demes[d]);
+}
+
+/**
+ * @brief Updates every deme of a split simulation for one month, one thread per deme, then migrates
+ *        rabbits between the demes every migration_interval months.
+ *        Each deme uses the serial update_rabbits with its own generator.
+ * @param sim A pointer to the parent s_simulation_instance (see has_demes).
+ * @return void
+ */
+void update_demes(s_simulation_instance *sim)
+{
+    s_deme_set *set = sim->demes;
+
+    #pragma omp parallel for schedule(static, 1) num_threads(set->count)
+    for (int d = 0; d < set->count; ++d)
+        update_rabbits(&set->demes[d], &set->rngs[d]);
+
+    if (migration_interval > 0 && ++set->months_since_migration >= migration_interval)
+    {
+        migrate_demes(set);
+        set->months_since_migration = 0;
+    }
+    collect_demes(sim);
+}
+
+/**
+ * @brief Moves the rabbits of every deme back into the parent instance, which becomes a single population again
+ *        (used before the switch to the cohort engine, which converts the rabbits of the parent).
+ * @param sim A pointer to the parent s_simulation_instance.
+ * @return 1 if the simulation is not split (anymore), 0 if the parent storage could not hold the rabbits.
+ */
+int merge_demes(s_simulation_instance *sim)
+{
+    if (!has_demes(sim))
+        return 1;
+    s_deme_set *set = sim->demes;
+    if (!reserve_rabbits(sim, set->alive))
+        return 0;
+
+    sim->rabbit_count = 0;
+    for (int d = 0; d < set->count; ++d)
+    {
+        s_simulation_instance *deme = &set->demes[d];
+        append_rabbits(sim, deme, 0, deme->rabbit_count);
+        deme->rabbit_count = 0;
+    }
+    collect_demes(sim);
+    set->count = 0;
+    refresh_population_stats(sim);
+    return 1;
+}
+
+/**
+ * @brief Frees the demes of a simulation instance.
+ * @param sim A pointer to the s_simulation_instance.
+ * @return void
+ */
+void reset_demes(s_simulation_instance *sim)
+{
+    s_deme_set *set = sim->demes;
+    if (!set)
+        return;
+    for (int d = 0; d < set->allocated; ++d)
+    {
+        // The threshold table belongs to the parent
+        set->demes[d].static_thresholds = NULL;
+        reset_population(&set->demes[d]);
+    }
+    free(set->demes);
+    free(set->rngs);
+    free(set);
+    sim->demes = NULL;
+}
@@ -0,0 +1,46 @@
+#ifndef DEME_H
+#define DEME_H
+
+// Demes: independent sub-populations of one large simulation.
+// Rabbits never interact in this model (a litter only depends on its mother, a death on the rabbit
+// itself), so a population is the union of sub-populations that evolve independently.
+// With deme_count set, the individual engine splits the population into that many demes right after
+// the initial population is created. Each deme is a full simulation instance with its own rabbit
+// storage, statistics and generator stream, and the demes are updated by one thread each without any
+// shared state: no chunk table, no merge of the array and no global newborn insertion.
+// Deme sizes drift apart as some lineages grow and others die out, so every migration_interval months
+// the largest demes hand rabbits over to the smallest ones to give every thread the same share of the
+// work. Which deme holds a rabbit never changes what happens to it, so splitting gives the same
+// statistics as the single population; a given seed gives the same results for every thread count,
+// but they depend on deme_count and migration_interval.
+
+#include "rabbitsim.h"
+
+// Default months between two migrations
+#define DEFAULT_MIGRATION_INTERVAL 12
+
+// Demes are only rebalanced once the largest one holds this many times its share of the population
+#define DEME_IMBALANCE_TOLERANCE 1.05
+
+// Global variables for the number of demes of a simulation (0 for one population) and the months between two migrations (0 for none)
+extern int deme_count;
+extern int migration_interval;
+
+// Demes of a simulation, kept by a pooled instance between runs
+typedef struct deme_set {
+    s_simulation_instance *demes;    // One instance per deme (the static threshold table is the parent's one)
+    pcg32x_random_t *rngs;           // Generator of each deme
+    int count;                       // Demes in use (0 while the simulation is not split)
+    int allocated;                   // Instances allocated
+    int months_since_migration;      // Months updated since the last migration
+    size_t alive;                    // Living rabbits across the demes
+    size_t dead_before_split;        // Deaths of the parent instance before the split
+} s_deme_set;
+
+int has_demes(const s_simulation_instance *sim);
+int split_into_demes(s_simulation_instance *sim, int nb_demes, pcg32x_random_t *rng);
+void update_demes(s_simulation_instance *sim);
+int merge_demes(s_simulation_instance *sim);
+void reset_demes(s_simulation_instance *sim);
+
+#endif
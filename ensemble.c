@@ -0,0 +1,291 @@
+#include "ensemble.h"
+#include "rabbitsim.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Global variable to enable the ensemble statistics
+int ensemble_statistics = 1;
+
+// Fractions of the simulations below the quantiles written to the ensemble file
+static const double ensemble_quantiles[] = { 0.05, 0.25, 0.50, 0.75, 0.95 };
+#define NB_ENSEMBLE_QUANTILES (int)(sizeof(ensemble_quantiles) / sizeof(ensemble_quantiles[0]))
+
+/**
+ * @brief Gets the logarithm of the growth factor between two buckets of the population histogram.
+ * @return log(gamma), gamma = (1 + ENSEMBLE_QUANTILE_ACCURACY) / (1 - ENSEMBLE_QUANTILE_ACCURACY).
+ */
+static double sketch_log_gamma(void)
+{
+    return log((1.0 + ENSEMBLE_QUANTILE_ACCURACY) / (1.0 - ENSEMBLE_QUANTILE_ACCURACY));
+}
+
+/**
+ * @brief Adds a value to a running mean and variance.
+ * @param w The accumulator.
+ * @param x The value.
+ * @return void
+ */
+static void welford_add(s_welford *w, double x)
+{
+    w->n++;
+    double delta = x - w->mean;
+    w->mean += delta / w->n;
+    w->m2 += delta * (x - w->mean);
+}
+
+/**
+ * @brief Adds the values of another accumulator to a running mean and variance (Chan et al.).
+ * @param dst The accumulator receiving the values.
+ * @param src The accumulator to add.
+ * @return void
+ */
+static void welford_merge(s_welford *dst, const s_welford *src)
+{
+    if (src->n == 0)
+        return;
+    long long n = dst->n + src->n;
+    double delta = src->mean - dst->mean;
+    dst->mean += delta * src->n / n;
+    dst->m2 += src->m2 + delta * delta * ((double)dst->n * src->n / n);
+    dst->n = n;
+}
+
+/**
+ * @brief Gets the sample variance of an accumulator.
+ * @param w The accumulator.
+ * @return The variance, 0 with less than two values.
+ */
+static double welford_variance(const s_welford *w)
+{
+    return w->n > 1 ? w->m2 / (w->n - 1) : 0.0;
+}
+
+/**
+ * @brief Allocates an empty accumulator.
+ * @param ensemble The accumulator to initialize.
+ * @param months The number of months of the simulations.
+ * @return 1 on success, 0 if the allocation failed.
+ */
+int init_ensemble(s_ensemble *ensemble, int months)
+{
+    ensemble->months = calloc(months, sizeof(s_ensemble_month));
+    ensemble->extinctions = calloc(months, sizeof(long long));
+    ensemble->nb_months = months;
+    if (!ensemble->months || !ensemble->extinctions)
+    {
+        free_ensemble(ensemble);
+        return 0;
+    }
+    for (int m = 0; m < months; ++m)
+        ensemble->months[m].min_population = INT_MAX;
+    return 1;
+}
+
+/**
+ * @brief Frees the memory of an accumulator.
+ * @param ensemble The accumulator.
+ * @return void
+ */
+void free_ensemble(s_ensemble *ensemble)
+{
+    free(ensemble->months);
+    free(ensemble->extinctions);
+    ensemble->months = NULL;
+    ensemble->extinctions = NULL;
+    ensemble->nb_months = 0;
+}
+
+/**
+ * @brief Adds the statistics of one month of a simulation.
+ * @param ensemble The accumulator of the thread running the simulation.
+ * @param month The month number.
+ * @param population The living rabbits at the start of the month.
+ * @param previous The living rabbits at the start of the previous month (0 for the first month).
+ * @param births The births of the previous update.
+ * @param deaths The deaths of the previous update.
+ * @return void
+ */
+void ensemble_add_month(s_ensemble *ensemble, int month, int population, int previous, int births, int deaths)
+{
+    if (month < 0 || month >= ensemble->nb_months)
+        return;
+
+    s_ensemble_month *stats = &ensemble->months[month];
+    welford_add(&stats->population, population);
+    welford_add(&stats->births, births);
+    welford_add(&stats->deaths, deaths);
+    if (previous > 0)
+        welford_add(&stats->growth, 100.0 * (population - previous) / previous);
+    if (population < stats->min_population) stats->min_population = population;
+    if (population > stats->max_population) stats->max_population = population;
+
+    // Empty populations are not in the histogram, they are counted from population.n
+    if (population > 0)
+    {
+        int k = (int)ceil(log((double)population) / sketch_log_gamma());
+        if (k >= ENSEMBLE_SKETCH_BUCKETS) k = ENSEMBLE_SKETCH_BUCKETS - 1;
+        stats->buckets[k]++;
+    }
+}
+
+/**
+ * @brief Records that a simulation stays extinct from a month to the end.
+ *        The empty months are only counted here and added in one block by finish_ensemble.
+ * @param ensemble The accumulator of the thread running the simulation.
+ * @param month The first month without any record of the simulation.
+ * @return void
+ */
+void ensemble_add_extinction(s_ensemble *ensemble, int month)
+{
+    if (month >= 0 && month < ensemble->nb_months)
+        ensemble->extinctions[month]++;
+}
+
+/**
+ * @brief Adds the statistics of another accumulator of the same run.
+ * @param dst The accumulator receiving the statistics.
+ * @param src The accumulator to add.
+ * @return void
+ */
+void merge_ensemble(s_ensemble *dst, const s_ensemble *src)
+{
+    int months = dst->nb_months < src->nb_months ? dst->nb_months : src->nb_months;
+    for (int m = 0; m < months; ++m)
+    {
+        s_ensemble_month *d = &dst->months[m];
+        const s_ensemble_month *s = &src->months[m];
+        welford_merge(&d->population, &s->population);
+        welford_merge(&d->births, &s->births);
+        welford_merge(&d->deaths, &s->deaths);
+        welford_merge(&d->growth, &s->growth);
+        if (s->min_population < d->min_population) d->min_population = s->min_population;
+        if (s->max_population > d->max_population) d->max_population = s->max_population;
+        for (int k = 0; k < ENSEMBLE_SKETCH_BUCKETS; ++k)
+            d->buckets[k] += s->buckets[k];
+        dst->extinctions[m] += src->extinctions[m];
+    }
+}
+
+/**
+ * @brief Adds the months of the extinct simulations (empty population, no births or deaths),
+ *        once every accumulator has been merged.
+ * @param ensemble The merged accumulator.
+ * @return void
+ */
+void finish_ensemble(s_ensemble *ensemble)
+{
+    long long extinct = 0;
+    for (int m = 0; m < ensemble->nb_months; ++m)
+    {
+        extinct += ensemble->extinctions[m];
+        ensemble->extinctions[m] = 0;
+        if (extinct == 0)
+            continue;
+
+        s_ensemble_month *stats = &ensemble->months[m];
+        const s_welford empty = { extinct, 0.0, 0.0 };
+        welford_merge(&stats->population, &empty);
+        welford_merge(&stats->births, &empty);
+        welford_merge(&stats->deaths, &empty);
+        stats->min_population = 0;
+    }
+}
+
+/**
+ * @brief Counts the simulations without any living rabbit in a month (not in the population histogram).
+ * @param month The statistics of the month.
+ * @return The number of empty simulations.
+ */
+static long long ensemble_empty_simulations(const s_ensemble_month *month)
+{
+    long long empty = month->population.n;
+    for (int k = 0; k < ENSEMBLE_SKETCH_BUCKETS; ++k)
+        empty -= month->buckets[k];
+    return empty;
+}
+
+/**
+ * @brief Reads a quantile of the population of one month from its histogram.
+ *        The result is within ENSEMBLE_QUANTILE_ACCURACY of a population of that rank.
+ * @param month The statistics of the month.
+ * @param q The fraction of the simulations below the quantile (0 to 1).
+ * @return The quantile (a whole population), 0 if no simulation reached the month.
+ */
+double ensemble_quantile(const s_ensemble_month *month, double q)
+{
+    long long n = month->population.n;
+    if (n == 0)
+        return 0.0;
+
+    double rank = q * (double)(n - 1);
+    long long seen = ensemble_empty_simulations(month);
+    if (rank < (double)seen)
+        return 0.0;
+
+    double gamma = exp(sketch_log_gamma());
+    for (int k = 0; k < ENSEMBLE_SKETCH_BUCKETS; ++k)
+    {
+        seen += month->buckets[k];
+        if (rank < (double)seen)
+        {
+            // Middle of the bucket in relative terms, rounded to a whole population (the buckets
+            // narrower than one rabbit hold a single population, which gives it exactly) and kept
+            // within the populations seen
+            double value = floor(2.0 * pow(gamma, k) / (gamma + 1.0) + 0.5);
+            if (value < month->min_population) value = month->min_population;
+            if (value > month->max_population) value = month->max_population;
+            return value;
+        }
+    }
+    return month->max_population;
+}
+
+/**
+ * @brief Writes the ensemble statistics of a run to "ensemble_monthly_pop<N>.csv", one line per month.
+ * @param ensemble The merged and finished accumulator.
+ * @param initial_population The initial population size (for filename).
+ * @param nb_simulations The total number of simulations run.
+ * @return void
+ */
+void write_ensemble_log(const s_ensemble *ensemble, int initial_population, int nb_simulations)
+{
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%sensemble_monthly_pop%d.csv", log_file_prefix, initial_population);
+
+    FILE *fp = fopen(filename, "w");
+    if (!fp)
+    {
+        LOG_PRINT("Warning: Could not create ensemble file %s\n", filename);
+        return;
+    }
+
+    fprintf(fp, "# Rabbit Simulation Ensemble\n");
+    fprintf(fp, "# Initial Population: %d\n", initial_population);
+    fprintf(fp, "# Number of Simulations: %d\n", nb_simulations);
+    fprintf(fp, "# Quantile Relative Accuracy: %g\n", ENSEMBLE_QUANTILE_ACCURACY);
+    fprintf(fp, "#\n");
+    fprintf(fp, "Month,Simulations,Mean_Alive,Std_Alive,Min_Alive,Max_Alive,P05_Alive,P25_Alive,Median_Alive,"
+                "P75_Alive,P95_Alive,Mean_Births,Std_Births,Mean_Deaths,Std_Deaths,Extinct,Mean_Growth,"
+                "Std_Growth\n");
+
+    for (int m = 0; m < ensemble->nb_months; ++m)
+    {
+        const s_ensemble_month *stats = &ensemble->months[m];
+        if (stats->population.n == 0)
+            break;
+
+        fprintf(fp, "%d,%lld,%.4f,%.4f,%d,%d", m, stats->population.n, stats->population.mean,
+                sqrt(welford_variance(&stats->population)), stats->min_population, stats->max_population);
+        for (int q = 0; q < NB_ENSEMBLE_QUANTILES; ++q)
+            fprintf(fp, ",%.0f", ensemble_quantile(stats, ensemble_quantiles[q]));
+        fprintf(fp, ",%.4f,%.4f,%.4f,%.4f", stats->births.mean, sqrt(welford_variance(&stats->births)),
+                stats->deaths.mean, sqrt(welford_variance(&stats->deaths)));
+        fprintf(fp, ",%lld,%.4f,%.4f\n", ensemble_empty_simulations(stats), stats->growth.mean,
+                sqrt(welford_variance(&stats->growth)));
+    }
+
+    fclose(fp);
+}
@@ -0,0 +1,57 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+// Month by month statistics of every simulation of a multi_simulate run, in constant memory.
+// Each thread feeds its own accumulator while it simulates: running mean and variance
+// (Welford) of the population, births, deaths and monthly growth rate, and a logarithmic histogram
+// of the population from which quantiles are read with a bounded relative error (as in DDSketch).
+// Both merge exactly, so the accumulators of the threads are combined once at the end.
+// The file written at the end holds every aggregate analyze_simulation.py plots for the whole run
+// (population spread, growth rate, births and deaths, extinctions), so the plots of a huge run do
+// not need the monthly logs of its simulations.
+
+#include <stdint.h>
+
+// Relative accuracy of the population quantiles, and number of histogram buckets
+// (bucket k holds the populations in ]gamma^(k-1), gamma^k], gamma = (1 + a) / (1 - a))
+#define ENSEMBLE_QUANTILE_ACCURACY 0.02
+#define ENSEMBLE_SKETCH_BUCKETS 1024
+
+// Global variable to enable the ensemble statistics (written to ensemble_monthly_pop<N>.csv)
+extern int ensemble_statistics;
+
+// Running mean and sum of squared deviations of a series (Welford)
+typedef struct {
+    long long n;                 // Number of values
+    double mean;                 // Mean of the values
+    double m2;                   // Sum of the squared deviations to the mean
+} s_welford;
+
+// Statistics of one month across the simulations that reached it
+typedef struct {
+    s_welford population;        // Living rabbits
+    s_welford births;            // Births of the month
+    s_welford deaths;            // Deaths of the month
+    s_welford growth;            // Growth rate in percent since the previous month (simulations alive then)
+    int min_population;          // Smallest population
+    int max_population;          // Largest population
+    uint32_t buckets[ENSEMBLE_SKETCH_BUCKETS];  // Logarithmic histogram of the populations
+} s_ensemble_month;
+
+// Accumulator of one thread (or of the whole run once merged)
+typedef struct ensemble {
+    s_ensemble_month *months;    // One entry per month
+    long long *extinctions;      // Simulations extinct from each month on (until finish_ensemble)
+    int nb_months;               // Number of months
+} s_ensemble;
+
+int init_ensemble(s_ensemble *ensemble, int months);
+void free_ensemble(s_ensemble *ensemble);
+void ensemble_add_month(s_ensemble *ensemble, int month, int population, int previous, int births, int deaths);
+void ensemble_add_extinction(s_ensemble *ensemble, int month);
+void merge_ensemble(s_ensemble *dst, const s_ensemble *src);
+void finish_ensemble(s_ensemble *ensemble);
+double ensemble_quantile(const s_ensemble_month *month, double q);
+void write_ensemble_log(const s_ensemble *ensemble, int initial_population, int nb_simulations);
+
+#endif
@@ -0,0 +1,503 @@
+#include "event.h"
+#include "variates.h"
+
+#include <math.h>
+#include <string.h>
+
+/**
+ * @brief Gets the event engine of a simulation instance, allocating an empty one the first time.
+ * @param sim A pointer to the s_simulation_instance.
+ * @return The engine, or NULL if the allocation failed.
+ */
+static s_event_engine *get_event_engine(s_simulation_instance *sim)
+{
+    if (!sim->events)
+        sim->events = calloc(1, sizeof(s_event_engine));
+    return sim->events;
+}
+
+/**
+ * @brief Schedules an event, ignored past the end of the simulation.
+ * @param events The event engine.
+ * @param month The month of the event.
+ * @param type The event type.
+ * @param slot The slot of the rabbit.
+ * @return 1 on success, 0 if the bucket cannot grow (the event is not scheduled).
+ */
+static int push_event(s_event_engine *events, long long month, event_type_t type, uint32_t slot)
+{
+    if (month < 0 || month >= events->months)
+        return 1;
+    s_event_bucket *bucket = &events->buckets[month * NB_EVENT_TYPES + type];
+    if (bucket->count == bucket->capacity)
+    {
+        size_t new_capacity = (bucket->capacity == 0) ? 64 : bucket->capacity * 2;
+        uint32_t *temp = realloc(bucket->slots, sizeof(uint32_t) * new_capacity);
+        if (!temp)
+            return 0;
+        bucket->slots = temp;
+        bucket->capacity = new_capacity;
+    }
+    bucket->slots[bucket->count++] = slot;
+    return 1;
+}
+
+/**
+ * @brief Takes a slot for a new rabbit, reusing the slot of a dead one when there is one.
+ * @param events The event engine.
+ * @return The slot, or UINT32_MAX if the slots array cannot grow.
+ */
+static uint32_t take_slot(s_event_engine *events)
+{
+    if (events->free_count > 0)
+        return events->free_slots[--events->free_count];
+    if (events->rabbit_count == events->rabbit_capacity)
+    {
+        size_t new_capacity = (events->rabbit_capacity == 0) ? MIN_RABBIT_CAPACITY : events->rabbit_capacity * 2;
+        if (new_capacity > UINT32_MAX)
+            return UINT32_MAX;
+        s_event_rabbit *temp = realloc(events->rabbits, sizeof(s_event_rabbit) * new_capacity);
+        if (!temp)
+            return UINT32_MAX;
+        events->rabbits = temp;
+        events->rabbit_capacity = new_capacity;
+    }
+    return (uint32_t)events->rabbit_count++;
+}
+
+/**
+ * @brief Gives back the slot of a dead rabbit (lost if the free list cannot grow).
+ * @param events The event engine.
+ * @param slot The slot.
+ * @return void
+ */
+static void release_slot(s_event_engine *events, uint32_t slot)
+{
+    if (events->free_count == events->free_capacity)
+    {
+        size_t new_capacity = (events->free_capacity == 0) ? 1024 : events->free_capacity * 2;
+        uint32_t *temp = realloc(events->free_slots, sizeof(uint32_t) * new_capacity);
+        if (!temp)
+            return;
+        events->free_slots = temp;
+        events->free_capacity = new_capacity;
+    }
+    events->free_slots[events->free_count++] = slot;
+}
+
+/**
+ * @brief Finds the constant stretches of the static survival thresholds: for each entry of each row,
+ *        the first later entry with another threshold (INT_MAX when the threshold never changes again,
+ *        the last entry holding for every older age).
+ * @param sim A pointer to the s_simulation_instance (with its table built).
+ * @param events The event engine.
+ * @return 1 on success, 0 if the allocation failed.
+ */
+static int build_segments(const s_simulation_instance *sim, s_event_engine *events)
+{
+    size_t ages = sim->static_table_ages;
+    if (events->segment_allocated < 2 * ages)
+    {
+        int *temp = realloc(events->segment_end, sizeof(int) * 2 * ages);
+        if (!temp)
+            return 0;
+        events->segment_end = temp;
+        events->segment_allocated = 2 * ages;
+    }
+    for (size_t row = 0; row < 2; ++row)
+    {
+        const uint32_t *thresholds = sim->static_thresholds + row * ages;
+        int *end = events->segment_end + row * ages;
+        end[ages - 1] = INT_MAX;
+        for (size_t a = ages - 1; a-- > 0;)
+            end[a] = (thresholds[a + 1] == thresholds[a]) ? end[a + 1] : (int)a + 1;
+    }
+    return 1;
+}
+
+/**
+ * @brief Draws the month at which a rabbit fails its survival check.
+ *        Within a stretch of constant threshold the months survived follow a geometric distribution,
+ *        drawn with a single logarithm; a rabbit outliving the stretch starts over in the next one.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param events The event engine.
+ * @param founder 1 for the initial population (second row of the table), 0 otherwise.
+ * @param month The month of the first survival check.
+ * @param entry The table entry of the first survival check (the age reached that month).
+ * @param rng A pointer to the PCG random number generator state.
+ * @return The death month, EVENT_NEVER if the rabbit outlives the simulation.
+ */
+static int draw_death_month(const s_simulation_instance *sim, const s_event_engine *events, int founder,
+                            long long month, long long entry, pcg32x_random_t *rng)
+{
+    long long ages = (long long)sim->static_table_ages;
+    const uint32_t *thresholds = sim->static_thresholds + founder * ages;
+    const int *segment_end = events->segment_end + founder * ages;
+
+    while (month < events->months)
+    {
+        long long e = (entry < ages) ? entry : ages - 1;
+        long long end = (entry < ages) ? segment_end[e] : INT_MAX;
+        if (thresholds[e] != UINT32_MAX)
+        {
+            // P(surviving k months) = q^k, q = (threshold + 1) / 2^32 as in check_survival_static
+            double log_q = log(((double)thresholds[e] + 1.0) * (1.0 / 4294967296.0));
+            double survived = floor(log(genrand_open(rng)) / log_q);
+            if (end == INT_MAX || survived < (double)(end - entry))
+                return (month + survived < events->months) ? (int)(month + survived) : EVENT_NEVER;
+        }
+        if (end == INT_MAX)
+            return EVENT_NEVER;
+        month += end - entry;
+        entry = end;
+    }
+    return EVENT_NEVER;
+}
+
+/**
+ * @brief Draws the month of the next pregnancy of a breeding rabbit, starting with the check of this month,
+ *        and schedules the birth of the following month.
+ *        The checks of can_be_pregnant_this_month succeed with remaining_litters / remaining_months, so the
+ *        first success within the year is drawn from one uniform; the last month of the year always succeeds.
+ * @param events The event engine.
+ * @param slot The slot of the rabbit.
+ * @param month The month of the first check.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return 1 on success, 0 if the birth cannot be scheduled.
+ */
+static int schedule_pregnancy(s_event_engine *events, uint32_t slot, int month, pcg32x_random_t *rng)
+{
+    s_event_rabbit *rabbit = &events->rabbits[slot];
+    int remaining_litters = rabbit->nb_litters_y - rabbit->nb_litters;
+    if (remaining_litters <= 0)
+        return 1;
+
+    int age = month - rabbit->birth_month + 1;
+    int remaining_months = 12 - (age - rabbit->maturity_age) % 12;
+    double u = genrand_real(rng);
+    double none_yet = 1.0;
+    double cumulative = 0.0;
+    int k = 0;
+    for (; k < remaining_months - 1; ++k)
+    {
+        float chance = (float)remaining_litters / (remaining_months - k);
+        if (chance >= 1.0f)
+            break;
+        cumulative += none_yet * chance;
+        none_yet *= 1.0 - chance;
+        if (u < cumulative)
+            break;
+    }
+
+    // A pregnancy of the death month or later never ends with a birth
+    long long pregnancy_month = (long long)month + k;
+    if (pregnancy_month < rabbit->death_month && pregnancy_month + 1 < events->months)
+    {
+        rabbit->pregnant = 1;
+        return push_event(events, pregnancy_month + 1, EVENT_BIRTH, slot);
+    }
+    return 1;
+}
+
+/**
+ * @brief Adds a rabbit and schedules its death and, for the rabbits born in the simulation, its maturity;
+ *        breeding rabbits of the initial population get their first anniversary instead.
+ *        A rabbit without a slot or without its events is counted in sim->lost_rabbits.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param events The event engine.
+ * @param birth_month The month at which the rabbit is 0 months old.
+ * @param sex The sex of the rabbit.
+ * @param founder 1 for a rabbit of the initial population (mature, founder survival rate), 0 for a newborn.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return void
+ */
+static void add_event_rabbit(s_simulation_instance *sim, s_event_engine *events, int birth_month, int sex,
+                             int founder, pcg32x_random_t *rng)
+{
+    uint32_t slot = take_slot(events);
+    if (slot == UINT32_MAX)
+    {
+        sim->lost_rabbits++;
+        return;
+    }
+
+    // First survival check: month 0 for the initial population, the month after its birth for a newborn
+    int first_month = founder ? 0 : birth_month;
+    int death_month = draw_death_month(sim, events, founder, first_month, first_month - birth_month + 1, rng);
+
+    s_event_rabbit *rabbit = &events->rabbits[slot];
+    *rabbit = (s_event_rabbit){0};
+    rabbit->birth_month = birth_month;
+    rabbit->death_month = death_month;
+    rabbit->sex = (uint8_t)sex;
+    rabbit->mature = (uint8_t)founder;
+
+    events->alive++;
+    events->mature += founder;
+    events->born_alive[birth_month + EVENT_MAX_FOUNDER_AGE]++;
+    events->birth_month_sum += birth_month;
+    sim->sex_distribution[sex]++;
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    // The rows of the age histogram are birth months too
+    if (sim->ages.rows > 0)
+        AGE_HISTOGRAM_AT(&sim->ages, birth_month + AGE_HISTOGRAM_FOUNDER_AGE, AGE_CLASS(sex, founder))++;
+    #endif
+
+    // A rabbit without its death would never die
+    int scheduled = push_event(events, death_month, EVENT_DEATH, slot);
+    if (founder)
+    {
+        // Anniversaries of the initial population fall on the ages multiple of 12
+        int age = first_month - birth_month + 1;
+        int anniversary = first_month + (12 - age % 12) % 12;
+        if (sex == 1 && anniversary <= death_month)
+            scheduled &= push_event(events, anniversary, EVENT_LITTERS, slot);
+    }
+    else if ((long long)birth_month + 4 <= death_month)
+    {
+        // Same checks as update_maturity from age 5, the last one always succeeds
+        int maturity = 5;
+        while (maturity < 8 && !check_maturity(maturity, rng))
+            maturity++;
+        long long maturity_month = (long long)birth_month + maturity - 1;
+        if (maturity_month <= death_month)
+            scheduled &= push_event(events, maturity_month, EVENT_MATURITY, slot);
+    }
+    if (!scheduled)
+        sim->lost_rabbits++;
+}
+
+/**
+ * @brief Initializes the event engine of a simulation, with the same starting population as simulate uses
+ *        for the individual engine ("super" rabbits for 2, random adults otherwise).
+ *        The static survival table of the simulation must already be built.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param nb_rabbits The number of rabbits in the initial population.
+ * @param months The number of months of the simulation (length of the calendar).
+ * @param rng A pointer to the PCG random number generator state.
+ * @return 1 on success, 0 if the calendar cannot be allocated (no rabbit is added then).
+ */
+int init_event_population(s_simulation_instance *sim, int nb_rabbits, int months, pcg32x_random_t *rng)
+{
+    s_event_engine *events = get_event_engine(sim);
+    if (!events || !build_segments(sim, events))
+        return 0;
+
+    if (events->buckets_allocated < months)
+    {
+        s_event_bucket *temp = realloc(events->buckets, sizeof(s_event_bucket) * NB_EVENT_TYPES * months);
+        if (!temp)
+            return 0;
+        for (size_t b = (size_t)events->buckets_allocated * NB_EVENT_TYPES; b < (size_t)months * NB_EVENT_TYPES; ++b)
+            temp[b] = (s_event_bucket){0};
+        events->buckets = temp;
+        events->buckets_allocated = months;
+    }
+    for (size_t b = 0; b < (size_t)months * NB_EVENT_TYPES; ++b)
+        events->buckets[b].count = 0;
+
+    int born_length = months + EVENT_MAX_FOUNDER_AGE + 1;
+    if (events->born_allocated < born_length)
+    {
+        long long *temp = realloc(events->born_alive, sizeof(long long) * born_length);
+        if (!temp)
+            return 0;
+        events->born_alive = temp;
+        events->born_allocated = born_length;
+    }
+    memset(events->born_alive, 0, sizeof(long long) * born_length);
+
+    events->months = months;
+    events->rabbit_count = 0;
+    events->free_count = 0;
+    events->oldest = 0;
+    events->alive = 0;
+    events->mature = 0;
+    events->birth_month_sum = 0;
+    events->month = 0;
+
+    if (nb_rabbits == 2)
+    {
+        add_event_rabbit(sim, events, -9, 0, 1, rng);
+        add_event_rabbit(sim, events, -9, 1, 1, rng);
+    }
+    else
+    {
+        for (int i = 0; i < nb_rabbits; ++i)
+        {
+            int age = generate_random_age(rng);
+            add_event_rabbit(sim, events, -age, generate_sex(rng), 1, rng);
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Processes the events of the next month of the simulation and adds its newborns.
+ *        The event types follow the order update_rabbits uses for one rabbit: maturity, litters per year,
+ *        births (and the next pregnancy), then deaths, so that rabbits dying this month still give birth.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return 1 on success, 0 if the engine is not initialized or an event cannot be scheduled
+ *         (the newborns that cannot be stored are counted in sim->lost_rabbits).
+ */
+int update_events(s_simulation_instance *sim, pcg32x_random_t *rng)
+{
+    s_event_engine *events = sim->events;
+    if (!events)
+        return 0;
+    int month = events->month;
+    int nb_new_born = 0;
+    int scheduled = 1;
+
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    sim->deaths_this_month = 0;
+    sim->births_this_month = 0;
+    #endif
+
+    s_event_bucket *buckets = &events->buckets[(size_t)month * NB_EVENT_TYPES];
+    for (size_t e = 0; e < buckets[EVENT_MATURITY].count; ++e)
+    {
+        uint32_t slot = buckets[EVENT_MATURITY].slots[e];
+        s_event_rabbit *rabbit = &events->rabbits[slot];
+        rabbit->mature = 1;
+        rabbit->maturity_age = (uint16_t)(month - rabbit->birth_month + 1);
+        events->mature++;
+        #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+        if (sim->ages.rows > 0)
+        {
+            int row = rabbit->birth_month + AGE_HISTOGRAM_FOUNDER_AGE;
+            AGE_HISTOGRAM_AT(&sim->ages, row, AGE_CLASS(rabbit->sex, 0))--;
+            AGE_HISTOGRAM_AT(&sim->ages, row, AGE_CLASS(rabbit->sex, 1))++;
+        }
+        #endif
+        if (rabbit->sex == 1)
+        {
+            rabbit->nb_litters_y = (uint8_t)generate_litters_per_year(rng);
+            scheduled &= schedule_pregnancy(events, slot, month, rng);
+            if (month + 12 <= rabbit->death_month)
+                scheduled &= push_event(events, month + 12, EVENT_LITTERS, slot);
+        }
+    }
+
+    for (size_t e = 0; e < buckets[EVENT_LITTERS].count; ++e)
+    {
+        uint32_t slot = buckets[EVENT_LITTERS].slots[e];
+        s_event_rabbit *rabbit = &events->rabbits[slot];
+        rabbit->nb_litters_y = (uint8_t)generate_litters_per_year(rng);
+        // A pregnant rabbit draws its next pregnancy after this month's birth
+        if (!rabbit->pregnant)
+            scheduled &= schedule_pregnancy(events, slot, month, rng);
+        if (month + 12 <= rabbit->death_month)
+            scheduled &= push_event(events, month + 12, EVENT_LITTERS, slot);
+    }
+
+    for (size_t e = 0; e < buckets[EVENT_BIRTH].count; ++e)
+    {
+        uint32_t slot = buckets[EVENT_BIRTH].slots[e];
+        s_event_rabbit *rabbit = &events->rabbits[slot];
+        rabbit->pregnant = 0;
+        rabbit->nb_litters += 1;
+        nb_new_born += 3 + (int)pcg32x_boundedrand_r(rng, 4);
+        scheduled &= schedule_pregnancy(events, slot, month, rng);
+    }
+
+    for (size_t e = 0; e < buckets[EVENT_DEATH].count; ++e)
+    {
+        uint32_t slot = buckets[EVENT_DEATH].slots[e];
+        const s_event_rabbit *rabbit = &events->rabbits[slot];
+        events->alive--;
+        events->mature -= rabbit->mature;
+        events->born_alive[rabbit->birth_month + EVENT_MAX_FOUNDER_AGE]--;
+        events->birth_month_sum -= rabbit->birth_month;
+        #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+        if (sim->ages.rows > 0)
+            AGE_HISTOGRAM_AT(&sim->ages, rabbit->birth_month + AGE_HISTOGRAM_FOUNDER_AGE,
+                             AGE_CLASS(rabbit->sex, rabbit->mature))--;
+        #endif
+        sim->sex_distribution[rabbit->sex]--;
+        sim->dead_rabbit_count++;
+        release_slot(events, slot);
+    }
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    sim->deaths_this_month = (int)buckets[EVENT_DEATH].count;
+    #endif
+
+    for (int t = 0; t < NB_EVENT_TYPES; ++t)
+        buckets[t].count = 0;
+    events->month = month + 1;
+
+    // The newborns are 0 months old next month, as after create_new_generation
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    sim->births_this_month = nb_new_born;
+    #endif
+    sim->last_births = nb_new_born;
+    for (int j = 0; j < nb_new_born; ++j)
+        add_event_rabbit(sim, events, month + 1, generate_sex(rng), 0, rng);
+    return scheduled;
+}
+
+/**
+ * @brief Counts the living rabbits of the event engine.
+ * @param sim A pointer to the s_simulation_instance.
+ * @return The number of living rabbits.
+ */
+long long count_event_rabbits(const s_simulation_instance *sim)
+{
+    return sim->events ? sim->events->alive : 0;
+}
+
+/**
+ * @brief Collects the age and maturity statistics of the living rabbits, at the start of the next month.
+ *        Ages come from the birth-month counts, the pregnant rabbits are the births scheduled this month.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param age_sum Receives the sum of the ages.
+ * @param min_age Receives the minimum age (left untouched if there are no rabbits).
+ * @param max_age Receives the maximum age (left untouched if there are no rabbits).
+ * @param mature_rabbits Receives the number of mature rabbits.
+ * @param pregnant_females Receives the number of pregnant females.
+ * @return void
+ */
+void collect_event_stats(s_simulation_instance *sim, long long *age_sum, int *min_age, int *max_age,
+                         int *mature_rabbits, int *pregnant_females)
+{
+    s_event_engine *events = sim->events;
+    if (!events || events->alive == 0)
+        return;
+
+    int month = events->month;
+    *age_sum = events->alive * month - events->birth_month_sum;
+    *mature_rabbits = events->mature;
+    *pregnant_females = (month < events->months)
+                      ? (int)events->buckets[(size_t)month * NB_EVENT_TYPES + EVENT_BIRTH].count : 0;
+
+    // The oldest birth month only moves forward, the youngest is at most this month
+    while (events->born_alive[events->oldest] == 0)
+        events->oldest++;
+    int youngest = month + EVENT_MAX_FOUNDER_AGE;
+    while (events->born_alive[youngest] == 0)
+        youngest--;
+    *max_age = month - (events->oldest - EVENT_MAX_FOUNDER_AGE);
+    *min_age = month - (youngest - EVENT_MAX_FOUNDER_AGE);
+}
+
+/**
+ * @brief Frees the event engine of a simulation instance.
+ * @param sim A pointer to the s_simulation_instance.
+ * @return void
+ */
+void reset_events(s_simulation_instance *sim)
+{
+    s_event_engine *events = sim->events;
+    if (!events)
+        return;
+    for (size_t b = 0; b < (size_t)events->buckets_allocated * NB_EVENT_TYPES; ++b)
+        free(events->buckets[b].slots);
+    free(events->buckets);
+    free(events->rabbits);
+    free(events->free_slots);
+    free(events->born_alive);
+    free(events->segment_end);
+    free(events);
+    sim->events = NULL;
+}
@@ -0,0 +1,88 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+// Event-driven simulation engine for the static survival method.
+// Most monthly checks of update_rabbits cannot fire: a mature rabbit never matures again,
+// litters per year only change on anniversaries and only pregnant rabbits give birth.
+// Under the static method the survival of a rabbit only depends on its age, so this engine
+// draws everything that can be known in advance when a rabbit is created: its death month
+// (geometric waiting times over the constant stretches of the threshold table, see
+// build_static_survival_table), its maturity month, its anniversaries and the month of its
+// next pregnancy. Each lands in a calendar queue with one bucket per month and event type,
+// and a month only processes the events it holds, so its cost follows the events that
+// actually happen instead of the population. The old age penalty is part of the death
+// month, it needs no event of its own.
+// Every rabbit follows the same probabilities as in update_rabbits, only the order of the
+// random draws differs, so runs are statistically identical but not bit-identical.
+
+#include "rabbitsim.h"
+
+#include <limits.h>
+
+// Oldest founder the birth-month counts can hold (generate_random_age stays below it)
+#define EVENT_MAX_FOUNDER_AGE 32
+
+// Death month of a rabbit that outlives the simulation
+#define EVENT_NEVER INT_MAX
+
+// Events of a month, processed in this order (the order of update_rabbits for one rabbit)
+typedef enum {
+    EVENT_MATURITY,     // The rabbit becomes mature (and, for a breeding rabbit, draws its litters)
+    EVENT_LITTERS,      // Anniversary of the maturity of a breeding rabbit, new litters per year
+    EVENT_BIRTH,        // The pregnancy of the previous month ends with a litter
+    EVENT_DEATH,        // The survival check of the month fails
+    NB_EVENT_TYPES
+} event_type_t;
+
+// State of one rabbit, in a slot that never moves while the rabbit lives
+typedef struct {
+    int birth_month;             // Month at which the rabbit is 0 months old (negative for the initial population)
+    int death_month;             // Month of the failed survival check (EVENT_NEVER past the end of the simulation)
+    uint16_t maturity_age;       // The age at which the rabbit became mature (0 for the initial population)
+    uint8_t sex;                 // 0 for female, 1 for male
+    uint8_t mature;              // 0 for immature, 1 for mature
+    uint8_t pregnant;            // 1 while a birth is scheduled
+    uint8_t nb_litters_y;        // Number of litters per year
+    uint8_t nb_litters;          // Number of litters already had
+} s_event_rabbit;
+
+// Rabbits (slots) with an event in one month
+typedef struct {
+    uint32_t *slots;
+    size_t count;
+    size_t capacity;
+} s_event_bucket;
+
+// State of the event engine, kept by a pooled instance between runs
+typedef struct event_engine {
+    s_event_rabbit *rabbits;     // Rabbit slots
+    size_t rabbit_count;         // Slots in use or free
+    size_t rabbit_capacity;      // Allocated slots
+    uint32_t *free_slots;        // Slots of dead rabbits, reused by the newborns
+    size_t free_count;
+    size_t free_capacity;
+
+    s_event_bucket *buckets;     // NB_EVENT_TYPES buckets per month of the simulation
+    int months;                  // Months of the current simulation
+    int buckets_allocated;       // Months the buckets array can hold
+
+    long long *born_alive;       // Living rabbits per birth month (index birth_month + EVENT_MAX_FOUNDER_AGE)
+    int born_allocated;          // Length of born_alive
+    int oldest;                  // No living rabbit below this index of born_alive
+    long long alive;             // Living rabbits
+    int mature;                  // Living mature rabbits
+    long long birth_month_sum;   // Sum of the birth months of the living rabbits (for the age sum)
+    int month;                   // Next month to process
+
+    int *segment_end;            // Per threshold table entry, the first later entry with another threshold
+    size_t segment_allocated;    // Length of segment_end (two rows, like static_thresholds)
+} s_event_engine;
+
+int init_event_population(s_simulation_instance *sim, int nb_rabbits, int months, pcg32x_random_t *rng);
+int update_events(s_simulation_instance *sim, pcg32x_random_t *rng);
+long long count_event_rabbits(const s_simulation_instance *sim);
+void collect_event_stats(s_simulation_instance *sim, long long *age_sum, int *min_age, int *max_age,
+                         int *mature_rabbits, int *pregnant_females);
+void reset_events(s_simulation_instance *sim);
+
+#endif
@@ -0,0 +1,44 @@
+#include "instrument.h"
+
+#if defined(ENABLE_INSTRUMENTATION) && ENABLE_INSTRUMENTATION != 0
+// Counters of the calling thread
+_Thread_local s_instrument_counters instrument_counters;
+#endif
+
+/**
+ * @brief Gets the name of a timed phase, as written in the results box and the summary file.
+ * @param phase The phase (instrument_phase_t).
+ * @return A constant string naming the phase.
+ */
+const char *get_instrument_phase_name(int phase)
+{
+    switch (phase)
+    {
+        case PHASE_SETUP: return "Setup";
+        case PHASE_UPDATE: return "Update";
+        case PHASE_COMPACTION: return "Compaction";
+        case PHASE_SHRINK: return "Shrink";
+        case PHASE_BIRTHS: return "Births";
+        case PHASE_COHORTS: return "Cohorts";
+        case PHASE_RECORD: return "Record";
+        case PHASE_LOG: return "Log";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * @brief Adds counters to a total (the largest month is kept instead of added).
+ * @param dst The total.
+ * @param src The counters to add.
+ * @return void
+ */
+void add_instrument_counters(s_instrument_counters *dst, const s_instrument_counters *src)
+{
+    dst->capacity_grows += src->capacity_grows;
+    dst->capacity_shrinks += src->capacity_shrinks;
+    dst->rng_outputs += src->rng_outputs;
+    if (src->max_free_slots > dst->max_free_slots)
+        dst->max_free_slots = src->max_free_slots;
+    for (int p = 0; p < NB_INSTRUMENT_PHASES; ++p)
+        dst->phase_cycles[p] += src->phase_cycles[p];
+}
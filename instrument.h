@@ -0,0 +1,78 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+// Hot path counters and cycle timers, compiled in with "make INSTRUMENT=1".
+// Each thread counts into its own instrument_counters, without any synchronization;
+// multi_simulate takes them after every simulation, stores them with its results and
+// adds them up per thread for the results box and the summary file.
+// Without ENABLE_INSTRUMENTATION the macros below compile to nothing.
+
+#include <stdint.h>
+
+#ifndef ENABLE_INSTRUMENTATION
+#define ENABLE_INSTRUMENTATION 0
+#endif
+
+// Phases timed by the cycle timers
+typedef enum {
+    PHASE_SETUP,        // Survival storage, threshold table and initial population of simulate
+    PHASE_UPDATE,       // Update pass over the rabbits (survival, aging, maturity, pregnancies, compaction)
+    PHASE_COMPACTION,   // Filling the holes between the chunks of the chunked update
+    PHASE_SHRINK,       // shrink_capacity
+    PHASE_BIRTHS,       // create_new_generation
+    PHASE_COHORTS,      // update_cohorts
+    PHASE_RECORD,       // record_monthly_stats and the ensemble statistics
+    PHASE_LOG,          // Hand-off of the monthly log to the log writer
+    NB_INSTRUMENT_PHASES
+} instrument_phase_t;
+
+// Counters of one thread, or of one simulation once taken by multi_simulate
+typedef struct {
+    long long capacity_grows;    // Reallocations of the rabbit storage by ensure_capacity
+    long long capacity_shrinks;  // Reallocations of the rabbit storage by shrink_capacity
+    long long rng_outputs;       // Raw outputs generated by the batch generators (PCG32X_BUFFER_SIZE per refill)
+    long long max_free_slots;    // Largest number of slots freed by deaths in one month (compacted by the update pass)
+    uint64_t phase_cycles[NB_INSTRUMENT_PHASES];  // Cycles spent in each phase
+} s_instrument_counters;
+
+const char *get_instrument_phase_name(int phase);
+void add_instrument_counters(s_instrument_counters *dst, const s_instrument_counters *src);
+
+#if defined(ENABLE_INSTRUMENTATION) && ENABLE_INSTRUMENTATION != 0
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+extern _Thread_local s_instrument_counters instrument_counters;
+
+// Time stamp counter, or nanoseconds on other processors
+static inline uint64_t instrument_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#endif
+}
+
+#define INSTRUMENT_COUNT(counter, n) (instrument_counters.counter += (n))
+#define INSTRUMENT_MAX(counter, value) \
+    do { if ((long long)(value) > instrument_counters.counter) instrument_counters.counter = (long long)(value); } while (0)
+#define INSTRUMENT_PHASE_START(start) uint64_t start = instrument_cycles()
+#define INSTRUMENT_PHASE_END(phase, start) (instrument_counters.phase_cycles[(phase)] += instrument_cycles() - (start))
+
+#else
+
+#define INSTRUMENT_COUNT(counter, n) do { } while (0)
+#define INSTRUMENT_MAX(counter, value) do { } while (0)
+#define INSTRUMENT_PHASE_START(start) do { } while (0)
+#define INSTRUMENT_PHASE_END(phase, start) do { } while (0)
+
+#endif
+
+#endif
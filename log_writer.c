@@ -0,0 +1,272 @@
+#define _POSIX_C_SOURCE 200809L  // For nanosleep and sched_yield with -std=c11
+
+#include "log_writer.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+// Global variables for the log writer mode and the single stream file
+log_writer_mode_t log_writer_mode = LOG_WRITER_ASYNC;
+int log_single_stream = 0;
+
+// Time the writer thread sleeps when the queue is empty
+#define LOG_WRITER_IDLE_NS 200000L
+
+// Slot of the queue. sequence tells whose turn it is: the producer of position p waits for
+// sequence == p, the consumer for sequence == p + 1 (bounded MPMC queue of D. Vyukov).
+typedef struct {
+    atomic_size_t sequence;
+    s_monthly_log log;
+} s_log_slot;
+
+static s_log_slot log_queue[LOG_QUEUE_CAPACITY];
+static atomic_size_t log_enqueue_pos;
+static size_t log_dequeue_pos;          // Only used by the writer thread
+
+static pthread_mutex_t log_write_lock = PTHREAD_MUTEX_INITIALIZER;  // Serialises the writes (stream file, log_written)
+static pthread_t log_thread;
+static int log_thread_running = 0;
+static atomic_int log_writer_stopping;
+static atomic_llong log_queue_full_waits;
+static long long log_written;
+static double log_write_time;
+static FILE *log_stream = NULL;
+static char *log_stream_buffer = NULL;
+
+/**
+ * @brief Adds a log at the back of the queue.
+ * @param log The log to add (its data now belongs to the queue).
+ * @return 1 on success, 0 if the queue is full.
+ */
+static int log_queue_push(const s_monthly_log *log)
+{
+    size_t pos = atomic_load_explicit(&log_enqueue_pos, memory_order_relaxed);
+    for (;;)
+    {
+        s_log_slot *slot = &log_queue[pos & (LOG_QUEUE_CAPACITY - 1)];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&log_enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                slot->log = *log;
+                atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+                return 1;
+            }
+        }
+        else if (diff < 0)
+        {
+            return 0;
+        }
+        else
+        {
+            pos = atomic_load_explicit(&log_enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Takes the log at the front of the queue (writer thread only).
+ * @param log Receives the log.
+ * @return 1 on success, 0 if the queue is empty.
+ */
+static int log_queue_pop(s_monthly_log *log)
+{
+    s_log_slot *slot = &log_queue[log_dequeue_pos & (LOG_QUEUE_CAPACITY - 1)];
+    size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    if (sequence != log_dequeue_pos + 1)
+        return 0;
+
+    *log = slot->log;
+    atomic_store_explicit(&slot->sequence, log_dequeue_pos + LOG_QUEUE_CAPACITY, memory_order_release);
+    log_dequeue_pos++;
+    return 1;
+}
+
+/**
+ * @brief Gets the seconds elapsed since a time of the monotonic clock.
+ * @param start The start time.
+ * @return The elapsed seconds.
+ */
+static double seconds_since(const struct timespec *start)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+/**
+ * @brief Writes one log to its own file or to the stream file.
+ * @param log The log to write.
+ * @return void
+ */
+static void write_log(const s_monthly_log *log)
+{
+    struct timespec start;
+    pthread_mutex_lock(&log_write_lock);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (log_stream)
+        append_monthly_log(log_stream, log);
+    else
+        write_monthly_log(log);
+    log_write_time += seconds_since(&start);
+    log_written++;
+    pthread_mutex_unlock(&log_write_lock);
+}
+
+/**
+ * @brief Writes a log taken from the queue and frees its buffers.
+ * @param log The log.
+ * @return void
+ */
+static void write_queued_log(s_monthly_log *log)
+{
+    write_log(log);
+    free(log->data);
+    free(log->age_rows);
+}
+
+/**
+ * @brief Body of the writer thread: writes the queued logs until stop_log_writer is called and the queue is empty.
+ * @param arg Unused.
+ * @return NULL.
+ */
+static void *log_writer_main(void *arg)
+{
+    (void)arg;
+    const struct timespec idle = { 0, LOG_WRITER_IDLE_NS };
+    s_monthly_log log;
+
+    for (;;)
+    {
+        if (log_queue_pop(&log))
+        {
+            write_queued_log(&log);
+            continue;
+        }
+        if (atomic_load_explicit(&log_writer_stopping, memory_order_acquire))
+        {
+            // Logs submitted between the failed pop and the stop flag are still queued, and every
+            // submit happened before the flag was raised, so the queue is final once drained
+            while (log_queue_pop(&log))
+                write_queued_log(&log);
+            break;
+        }
+        nanosleep(&idle, NULL);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Prepares the writing of the monthly logs of a multi_simulate run: opens the stream file
+ *        when log_single_stream is set and starts the writer thread in LOG_WRITER_ASYNC mode.
+ *        Falls back to synchronous writing if the thread cannot be created.
+ * @param initial_population The initial population size (for filenames).
+ * @return 1 if a background thread was started, 0 otherwise.
+ */
+int start_log_writer(int initial_population)
+{
+    log_written = 0;
+    log_write_time = 0.0;
+    atomic_store(&log_queue_full_waits, 0);
+    atomic_store(&log_writer_stopping, 0);
+
+    if (log_single_stream)
+    {
+        log_stream = open_monthly_log_stream(initial_population);
+        log_stream_buffer = log_stream ? malloc(LOG_STREAM_BUFFER_SIZE) : NULL;
+        if (log_stream_buffer)
+            setvbuf(log_stream, log_stream_buffer, _IOFBF, LOG_STREAM_BUFFER_SIZE);
+    }
+
+    if (log_writer_mode != LOG_WRITER_ASYNC)
+        return 0;
+
+    for (size_t i = 0; i < LOG_QUEUE_CAPACITY; ++i)
+        atomic_store(&log_queue[i].sequence, i);
+    atomic_store(&log_enqueue_pos, 0);
+    log_dequeue_pos = 0;
+
+    log_thread_running = (pthread_create(&log_thread, NULL, log_writer_main, NULL) == 0);
+    if (!log_thread_running)
+        LOG_PRINT("Warning: Could not start the log writer thread, logs are written synchronously\n");
+    return log_thread_running;
+}
+
+/**
+ * @brief Hands the monthly statistics of a finished simulation to the writer.
+ *        With the writer thread they are copied (the instance is reused for the next simulation) and
+ *        queued; the caller only waits if the queue is full. Otherwise they are written right away.
+ * @param sim A pointer to the s_simulation_instance of the finished simulation.
+ * @param sim_number The simulation number (for filename).
+ * @param initial_population The initial population size (for filename).
+ * @return void
+ */
+void submit_simulation_log(const s_simulation_instance *sim, int sim_number, int initial_population)
+{
+    s_monthly_log log = { sim->monthly_data, sim->monthly_data_count, sim->monthly_data_capacity,
+                          sim_number, initial_population, sim->age_rows, sim->age_row_count };
+    if (!log.data || log.count == 0)
+        return;
+
+    if (log_thread_running)
+    {
+        s_monthly_log copy = log;
+        copy.data = malloc(sizeof(s_monthly_stats) * log.count);
+        copy.age_rows = log.age_row_count > 0 ? malloc(sizeof(s_age_row) * log.age_row_count) : NULL;
+        if (copy.data && (copy.age_rows || log.age_row_count == 0))
+        {
+            memcpy(copy.data, log.data, sizeof(s_monthly_stats) * log.count);
+            if (copy.age_rows)
+                memcpy(copy.age_rows, log.age_rows, sizeof(s_age_row) * log.age_row_count);
+            while (!log_queue_push(&copy))
+            {
+                atomic_fetch_add_explicit(&log_queue_full_waits, 1, memory_order_relaxed);
+                sched_yield();
+            }
+            return;
+        }
+        free(copy.data);
+        free(copy.age_rows);
+    }
+
+    // Synchronous writing
+    write_log(&log);
+}
+
+/**
+ * @brief Waits for every queued log to be written, stops the writer thread and closes the stream file.
+ * @return The counters of this run of the writer.
+ */
+s_log_writer_stats stop_log_writer(void)
+{
+    s_log_writer_stats stats = { 0, 0, log_thread_running, 0.0 };
+
+    if (log_thread_running)
+    {
+        atomic_store_explicit(&log_writer_stopping, 1, memory_order_release);
+        pthread_join(log_thread, NULL);
+        log_thread_running = 0;
+    }
+    if (log_stream)
+    {
+        // The last buffered simulations are written here
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        fclose(log_stream);
+        log_write_time += seconds_since(&start);
+        log_stream = NULL;
+    }
+    free(log_stream_buffer);
+    log_stream_buffer = NULL;
+
+    stats.logs_written = log_written;
+    stats.write_time = log_write_time;
+    stats.queue_full_waits = atomic_load(&log_queue_full_waits);
+    return stats;
+}
@@ -0,0 +1,40 @@
+#ifndef LOG_WRITER_H
+#define LOG_WRITER_H
+
+// Background writer of the monthly logs.
+// The simulation threads of multi_simulate hand the monthly statistics of each finished
+// simulation to a bounded lock-free queue and go straight back to simulating; a dedicated
+// thread takes them out and writes them, to one file per simulation or appended to a
+// single stream file (see open_monthly_log_stream).
+
+#include "rabbitsim.h"
+
+// Number of finished simulations that can wait in the queue (power of two)
+#define LOG_QUEUE_CAPACITY 256
+
+// Buffer of the single stream file, so the writer thread batches many simulations per write
+#define LOG_STREAM_BUFFER_SIZE (1 << 20)
+
+// Who writes the monthly logs
+typedef enum {
+    LOG_WRITER_ASYNC,   // A background thread fed by the queue (default)
+    LOG_WRITER_SYNC     // The simulation thread itself, as soon as the simulation ends
+} log_writer_mode_t;
+
+// Global variables for the log writer mode and the single stream file (0 for one file per simulation)
+extern log_writer_mode_t log_writer_mode;
+extern int log_single_stream;
+
+// Counters of the last run of the writer
+typedef struct {
+    long long logs_written;      // Simulations written by the writer
+    long long queue_full_waits;  // Times a simulation thread found the queue full and had to wait
+    int background;              // 1 if a background thread did the writing
+    double write_time;           // Seconds spent writing, summed over the writing threads
+} s_log_writer_stats;
+
+int start_log_writer(int initial_population);
+void submit_simulation_log(const s_simulation_instance *sim, int sim_number, int initial_population);
+s_log_writer_stats stop_log_writer(void);
+
+#endif
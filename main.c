@@ -3,9 +3,20 @@
 #include <stdint.h>
 #include <inttypes.h>
 #include <time.h>
+#include <string.h>
+#include <sys/resource.h>
 
 #include "rabbitsim.h"
 #include "pcg_basic.h"
+#include "variates.h"
+#include "log_writer.h"
+#include "ensemble.h"
+#include "checkpoint.h"
+#include "deme.h"
+#include "cluster.h"
+#include "progress.h"
+#include "result_store.h"
+#include "replay.h"
 
 
 // Helper function to get survival method name
@@ -18,14 +29,483 @@ const char* get_survival_method_name(survival_method_t method) {
     }
 }
 
+// Helper function to get simulation engine name
+const char* get_simulation_engine_name(simulation_engine_t engine) {
+    switch (engine) {
+        case ENGINE_INDIVIDUAL: return "Individual (one record per rabbit)";
+        case ENGINE_COHORT: return "Cohort (binomial draws per cohort)";
+        case ENGINE_EVENT: return "Event (scheduled events per month, static method)";
+        default: return "Unknown";
+    }
+}
+
+// Helper function to describe the stop condition
+void print_stop_condition(void) {
+    switch (stop_mode) {
+        case STOP_CEILING:
+            printf("Stop at %lld rabbits\n", population_ceiling);
+            break;
+        case STOP_SWITCH_TO_COHORT:
+            printf("Switch to the cohort engine at %lld rabbits\n", population_ceiling);
+            break;
+        case STOP_CONFIDENCE:
+            printf("Stop when extinction is less likely than %g\n", extinction_confidence);
+            break;
+        case STOP_NONE:
+        default:
+            printf("None (extinction only)\n");
+            break;
+    }
+}
+
 // Helper function to clear invalid input from stdin
 void clear_input_buffer() {
     int c;
     while ((c = getchar()) != '\n' && c != EOF);
 }
 
-int main()
+// ===== BATCH MODE =====
+
+// Settings of one run of the batch mode (one line of a sweep file)
+typedef struct {
+    int months;
+    int initial_population;
+    int nb_simulations;
+    s_survival_params survival;
+} s_batch_point;
+
+// Fixed seed of the benchmark scenarios, so every release simulates exactly the same rabbits
+#define BENCH_SEED 42
+
+// A benchmark scenario run by "--bench NAME" (see the bench target of the Makefile)
+typedef struct {
+    const char *name;
+    int months;
+    int initial_population;
+    int nb_simulations;
+    survival_method_t method;
+    float init_rate;
+    float adult_rate;
+    stop_mode_t stop;
+} s_bench_scenario;
+
+static const s_bench_scenario bench_scenarios[] = {
+    { "small-extinct", 120,  3, 100000, SURVIVAL_STATIC,      70.0f,         85.0f,          STOP_NONE    },
+    { "exploding",      84, 10,      4, SURVIVAL_STATIC,      INIT_SRV_RATE, ADULT_SRV_RATE, STOP_NONE    },
+    { "long-horizon",  600,  3,    100, SURVIVAL_STATIC,      INIT_SRV_RATE, ADULT_SRV_RATE, STOP_CEILING },
+    { "static",         60,  3,    150, SURVIVAL_STATIC,      INIT_SRV_RATE, ADULT_SRV_RATE, STOP_NONE    },
+    { "gaussian",       60,  3,    150, SURVIVAL_GAUSSIAN,    INIT_SRV_RATE, ADULT_SRV_RATE, STOP_NONE    },
+    { "exponential",    60,  3,   2000, SURVIVAL_EXPONENTIAL, INIT_SRV_RATE, ADULT_SRV_RATE, STOP_NONE    },
+};
+#define NB_BENCH_SCENARIOS (int)(sizeof(bench_scenarios) / sizeof(bench_scenarios[0]))
+
+// Population ceiling of the long-horizon scenario
+#define BENCH_CEILING 100000
+
+// Helper function to print the command line usage
+void print_usage(const char *program) {
+    printf("Usage: %s [options]\n"
+           "Without options the interactive menu is started.\n\n"
+           "  --months N            Months per simulation (default 80)\n"
+           "  --population N        Initial population (default 3)\n"
+           "  --simulations N       Number of simulations (default 5)\n"
+           "  --seed S              Base seed, shared by every sweep point (default: random)\n"
+           "  --method M            Survival method: static, gaussian or exponential\n"
+           "  --init-rate R         Survival rate of young rabbits (default %.2f)\n"
+           "  --adult-rate R        Survival rate of adult rabbits (default %.2f)\n"
+           "  --sigma X             Standard deviation of the Gaussian method (default %.2f)\n"
+           "  --exp-scale X         Divisor of lambda in the exponential method (default %.2f)\n"
+           "  --exp-spread X        Weight of the exponential factor (default %.2f)\n"
+           "  --penalty-age N       Age in months from which old rabbits lose survival, at least 20 (default %d)\n"
+           "  --penalty-rate R      Survival rate lost per year past that age (default %.2f)\n"
+           "  --engine E            Simulation engine: individual, cohort or event (static method only)\n"
+           "  --threads N           Threads running simulations (0 = all cores)\n"
+           "  --schedule S          Scheduling: static, dynamic or guided\n"
+           "  --update-threads N    Threads updating a single simulation, started by each of the --threads ones (0 = serial update)\n"
+           "  --demes N             Split each simulation into N independent sub-populations, one thread each per simulation thread (0 = none)\n"
+           "  --migration N         Months between two rebalancings of the demes (default %d, 0 = never)\n"
+           "  --storage-growth G    Rabbit storage: realloc, or reserve (address space reserved once, grown in place)\n"
+           "  --reserve-rabbits N   Rabbits the reserved storage of one simulation can hold (default %u)\n"
+           "  --stop S              Early stop: none, ceiling, cohort or confidence\n"
+           "  --ceiling N           Population ceiling of the ceiling and cohort stops\n"
+           "  --confidence P        Extinction probability threshold of the confidence stop\n"
+           "  --prefix P            Prefix of the log file names\n"
+           "  --log-format F        Log files: csv, or binary (columnar .rlog files, see analyze_simulation.py)\n"
+           "  --log-simulations N   Number of simulations logged month by month (default %d)\n"
+           "  --log-writer W        Monthly logs written by a background thread (async) or by the simulations (sync)\n"
+           "  --log-stream B        1 to append every monthly log to a single simulation_monthly file\n"
+           "  --age-structure B     1 to write the age structure of every month of the logged simulations (default), 0 to skip\n"
+           "  --ensemble B          1 to write month by month statistics of all simulations (default), 0 to skip\n"
+           "  --result-store FILE   Write the results of every simulation into a memory-mapped file (.rstore) as they complete\n"
+           "  --checkpoint N        Save each running simulation to a checkpoint file every N months (default 0, none)\n"
+           "  --resume B            1 to continue the simulations from their checkpoint files (same options and --seed)\n"
+           "  --replay LIST         Only run the simulations of LIST again (e.g. 17 or 3,40-45) with their full logs,\n"
+           "                        same options and --seed as the original run (their checkpoint files are kept)\n"
+           "  --progress-interval N Milliseconds between two progress reports (default %d, 0 = no progress line)\n"
+           "  --progress-output F   File (or named pipe) receiving one JSON line of progress per report\n"
+           "  --sweep FILE          Run every point of FILE back to back, one line per point:\n"
+           "                        months population simulations [method [init_rate [adult_rate]]]\n"
+           "                        (missing columns take the values of the options, # starts a comment)\n"
+           "  --check-variates N    Check the normal and exponential samplers on N draws and exit\n"
+           "  --bench NAME          Run a benchmark scenario (list to show them) and append its metrics to the output\n"
+           "  --bench-output FILE   File receiving one JSON line per benchmark run (default bench.jsonl)\n"
+           "  --help                Show this help\n",
+           program, INIT_SRV_RATE, ADULT_SRV_RATE, GAUSSIAN_SRV_SIGMA, EXPONENTIAL_SRV_SCALE,
+           EXPONENTIAL_SRV_SPREAD, SRV_PENALTY_AGE, SRV_PENALTY_PER_YEAR, DEFAULT_MIGRATION_INTERVAL, DEFAULT_RESERVED_RABBITS,
+           MAX_SIMULATIONS_TO_LOG, DEFAULT_PROGRESS_INTERVAL_MS);
+}
+
+// Helper functions to parse option values, they return 1 on success and 0 otherwise
+int parse_int(const char *text, int min_value, int *value) {
+    char *end;
+    long parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || parsed < min_value || parsed > INT_MAX)
+        return 0;
+    *value = (int)parsed;
+    return 1;
+}
+
+int parse_rate(const char *text, float *value) {
+    char *end;
+    double parsed = strtod(text, &end);
+    if (end == text || *end != '\0' || parsed < 0.0 || parsed > 100.0)
+        return 0;
+    *value = (float)parsed;
+    return 1;
+}
+
+int parse_positive(const char *text, double *value) {
+    char *end;
+    double parsed = strtod(text, &end);
+    if (end == text || *end != '\0' || !(parsed > 0.0))
+        return 0;
+    *value = parsed;
+    return 1;
+}
+
+int parse_survival_method(const char *text, survival_method_t *method) {
+    if (strcmp(text, "static") == 0 || strcmp(text, "1") == 0) *method = SURVIVAL_STATIC;
+    else if (strcmp(text, "gaussian") == 0 || strcmp(text, "2") == 0) *method = SURVIVAL_GAUSSIAN;
+    else if (strcmp(text, "exponential") == 0 || strcmp(text, "3") == 0) *method = SURVIVAL_EXPONENTIAL;
+    else return 0;
+    return 1;
+}
+
+int parse_engine(const char *text, simulation_engine_t *engine) {
+    if (strcmp(text, "individual") == 0) *engine = ENGINE_INDIVIDUAL;
+    else if (strcmp(text, "cohort") == 0) *engine = ENGINE_COHORT;
+    else if (strcmp(text, "event") == 0) *engine = ENGINE_EVENT;
+    else return 0;
+    return 1;
+}
+
+int parse_log_format(const char *text, log_format_t *format) {
+    if (strcmp(text, "csv") == 0) *format = LOG_FORMAT_CSV;
+    else if (strcmp(text, "binary") == 0) *format = LOG_FORMAT_BINARY;
+    else return 0;
+    return 1;
+}
+
+int parse_log_writer(const char *text, log_writer_mode_t *mode) {
+    if (strcmp(text, "async") == 0) *mode = LOG_WRITER_ASYNC;
+    else if (strcmp(text, "sync") == 0) *mode = LOG_WRITER_SYNC;
+    else return 0;
+    return 1;
+}
+
+int parse_schedule(const char *text, simulation_schedule_t *schedule) {
+    if (strcmp(text, "static") == 0) *schedule = SCHEDULE_STATIC;
+    else if (strcmp(text, "dynamic") == 0) *schedule = SCHEDULE_DYNAMIC;
+    else if (strcmp(text, "guided") == 0) *schedule = SCHEDULE_GUIDED;
+    else return 0;
+    return 1;
+}
+
+int parse_storage_growth(const char *text, storage_growth_t *growth) {
+    if (strcmp(text, "realloc") == 0) *growth = GROWTH_REALLOC;
+    else if (strcmp(text, "reserve") == 0) *growth = GROWTH_RESERVE;
+    else return 0;
+    return 1;
+}
+
+int parse_stop_mode(const char *text, stop_mode_t *mode) {
+    if (strcmp(text, "none") == 0) *mode = STOP_NONE;
+    else if (strcmp(text, "ceiling") == 0) *mode = STOP_CEILING;
+    else if (strcmp(text, "cohort") == 0) *mode = STOP_SWITCH_TO_COHORT;
+    else if (strcmp(text, "confidence") == 0) *mode = STOP_CONFIDENCE;
+    else return 0;
+    return 1;
+}
+
+// Reads the points of a sweep file, columns missing from a line take the values of defaults.
+// Returns the number of points (stored in *points, to free) or -1 on error.
+int load_sweep_file(const char *path, const s_batch_point *defaults, s_batch_point **points) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open sweep file %s\n", path);
+        return -1;
+    }
+
+    int count = 0, capacity = 0, line_number = 0;
+    s_batch_point *list = NULL;
+    char line[512];
+    while (fgets(line, sizeof(line), fp)) {
+        line_number++;
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+
+        char *fields[6];
+        int nb_fields = 0;
+        for (char *token = strtok(line, " \t\r\n,;"); token && nb_fields < 6; token = strtok(NULL, " \t\r\n,;"))
+            fields[nb_fields++] = token;
+        if (nb_fields == 0)
+            continue;
+
+        s_batch_point point = *defaults;
+        int valid = nb_fields >= 3
+                 && parse_int(fields[0], 1, &point.months)
+                 && parse_int(fields[1], 1, &point.initial_population)
+                 && parse_int(fields[2], 1, &point.nb_simulations)
+                 && (nb_fields < 4 || parse_survival_method(fields[3], &point.survival.method))
+                 && (nb_fields < 5 || parse_rate(fields[4], &point.survival.init_rate))
+                 && (nb_fields < 6 || parse_rate(fields[5], &point.survival.adult_rate));
+        if (!valid) {
+            fprintf(stderr, "Error: Invalid sweep point at %s:%d\n", path, line_number);
+            free(list);
+            fclose(fp);
+            return -1;
+        }
+
+        if (count == capacity) {
+            capacity = (capacity == 0) ? 16 : capacity * 2;
+            s_batch_point *temp = realloc(list, sizeof(s_batch_point) * capacity);
+            if (!temp) {
+                fprintf(stderr, "Error: Could not allocate the sweep points\n");
+                free(list);
+                fclose(fp);
+                return -1;
+            }
+            list = temp;
+        }
+        list[count++] = point;
+    }
+    fclose(fp);
+
+    *points = list;
+    return count;
+}
+
+// Finds a benchmark scenario by name, prints the names and returns NULL if there is none.
+const s_bench_scenario *find_bench_scenario(const char *name) {
+    for (int s = 0; s < NB_BENCH_SCENARIOS; ++s)
+        if (strcmp(bench_scenarios[s].name, name) == 0)
+            return &bench_scenarios[s];
+
+    if (strcmp(name, "list") != 0)
+        fprintf(stderr, "Error: Unknown benchmark scenario %s\n", name);
+    printf("Benchmark scenarios:\n");
+    for (int s = 0; s < NB_BENCH_SCENARIOS; ++s) {
+        const s_bench_scenario *b = &bench_scenarios[s];
+        printf("  %-14s %4d months, population %2d, %6d simulations, %s survival\n", b->name, b->months,
+               b->initial_population, b->nb_simulations, get_survival_method_name(b->method));
+    }
+    return NULL;
+}
+
+// Appends the metrics of the last multi_simulate run to the benchmark output, as one JSON object per line.
+// Returns 1 on success and 0 if the file could not be written.
+int write_bench_metrics(const char *path, const s_bench_scenario *scenario) {
+    FILE *fp = fopen(path, "a");
+    if (!fp) {
+        fprintf(stderr, "Error: Could not open benchmark output %s\n", path);
+        return 0;
+    }
+
+    // Peak resident memory of the whole process, in kilobytes on Linux
+    struct rusage usage;
+    long peak_rss = (getrusage(RUSAGE_SELF, &usage) == 0) ? usage.ru_maxrss : -1;
+
+    const s_run_metrics *r = &last_run_metrics;
+    double elapsed = r->elapsed > 0.0 ? r->elapsed : 1e-9;
+    fprintf(fp, "{\"scenario\": \"%s\", \"months\": %d, \"population\": %d, \"simulations\": %d, "
+                "\"method\": \"%s\", \"seed\": %d, \"threads\": %d, \"storage\": \"%s\", "
+                "\"elapsed_s\": %.6f, \"busy_s\": %.6f, \"months_simulated\": %lld, \"months_per_s\": %.1f, "
+                "\"rabbit_updates\": %lld, \"rabbit_updates_per_s\": %.1f, \"peak_rss_kb\": %ld, "
+                "\"phases\": {\"update_rabbits_s\": %.6f, \"record_monthly_stats_s\": %.6f, "
+                "\"log_writing_s\": %.6f, \"logs_written\": %lld}}\n",
+            scenario->name, scenario->months, scenario->initial_population, scenario->nb_simulations,
+            get_survival_method_name(scenario->method), BENCH_SEED, r->nb_threads,
+            RABBIT_STORAGE_SOA ? "soa" : "aos", r->elapsed, r->busy_time, r->months_simulated,
+            r->months_simulated / elapsed, r->rabbit_updates, r->rabbit_updates / elapsed, peak_rss,
+            r->update_time, r->record_time, r->log_write_time, r->logs_written);
+    fclose(fp);
+    return 1;
+}
+
+// Runs the simulations described by the command line, without any prompt.
+// Every sweep point runs in the same process, so the OpenMP threads and the
+// simulation instances of multi_simulate are reused from one point to the next.
+int run_batch(int argc, char *argv[]) {
+    s_batch_point defaults = { 80, 3, 5, default_survival_params() };
+    uint64_t base_seed = (uint64_t)time(NULL) ^ (uintptr_t)&defaults;
+    const char *sweep_path = NULL;
+    const char *prefix = "";
+    int check_samples = 0;
+    const char *bench_name = NULL;
+    const char *bench_output = "bench.jsonl";
+
+    for (int a = 1; a < argc; ++a) {
+        const char *option = argv[a];
+        if (strcmp(option, "--help") == 0 || strcmp(option, "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        }
+        if (a + 1 >= argc) {
+            fprintf(stderr, "Error: Missing value for %s (see --help)\n", option);
+            return 1;
+        }
+        const char *value = argv[++a];
+
+        int valid;
+        if (strcmp(option, "--months") == 0) valid = parse_int(value, 1, &defaults.months);
+        else if (strcmp(option, "--population") == 0) valid = parse_int(value, 1, &defaults.initial_population);
+        else if (strcmp(option, "--simulations") == 0) valid = parse_int(value, 1, &defaults.nb_simulations);
+        else if (strcmp(option, "--method") == 0) valid = parse_survival_method(value, &defaults.survival.method);
+        else if (strcmp(option, "--init-rate") == 0) valid = parse_rate(value, &defaults.survival.init_rate);
+        else if (strcmp(option, "--adult-rate") == 0) valid = parse_rate(value, &defaults.survival.adult_rate);
+        else if (strcmp(option, "--sigma") == 0) valid = parse_positive(value, &defaults.survival.gaussian_sigma);
+        else if (strcmp(option, "--exp-scale") == 0) valid = parse_positive(value, &defaults.survival.exponential_scale);
+        else if (strcmp(option, "--exp-spread") == 0) valid = parse_positive(value, &defaults.survival.exponential_spread);
+        else if (strcmp(option, "--penalty-age") == 0) valid = parse_int(value, SRV_PENALTY_MIN_AGE, &defaults.survival.penalty_age);
+        else if (strcmp(option, "--penalty-rate") == 0) valid = parse_rate(value, &defaults.survival.penalty_per_year);
+        else if (strcmp(option, "--engine") == 0) valid = parse_engine(value, &simulation_engine);
+        else if (strcmp(option, "--threads") == 0) valid = parse_int(value, 0, &simulation_threads);
+        else if (strcmp(option, "--schedule") == 0) valid = parse_schedule(value, &simulation_schedule);
+        else if (strcmp(option, "--update-threads") == 0) valid = parse_int(value, 0, &update_threads);
+        else if (strcmp(option, "--demes") == 0) valid = parse_int(value, 0, &deme_count);
+        else if (strcmp(option, "--migration") == 0) valid = parse_int(value, 0, &migration_interval);
+        else if (strcmp(option, "--storage-growth") == 0) valid = parse_storage_growth(value, &storage_growth);
+        else if (strcmp(option, "--reserve-rabbits") == 0) valid = sscanf(value, "%zu", &reserved_rabbits) == 1 && reserved_rabbits >= MIN_RABBIT_CAPACITY;
+        else if (strcmp(option, "--stop") == 0) valid = parse_stop_mode(value, &stop_mode);
+        else if (strcmp(option, "--ceiling") == 0) valid = sscanf(value, "%lld", &population_ceiling) == 1 && population_ceiling > 0;
+        else if (strcmp(option, "--confidence") == 0) valid = sscanf(value, "%lf", &extinction_confidence) == 1 && extinction_confidence > 0.0 && extinction_confidence < 1.0;
+        else if (strcmp(option, "--seed") == 0) valid = sscanf(value, "%" SCNu64, &base_seed) == 1;
+        else if (strcmp(option, "--prefix") == 0) { prefix = value; valid = 1; }
+        else if (strcmp(option, "--log-format") == 0) valid = parse_log_format(value, &log_format);
+        else if (strcmp(option, "--log-simulations") == 0) valid = parse_int(value, 0, &simulations_to_log);
+        else if (strcmp(option, "--log-writer") == 0) valid = parse_log_writer(value, &log_writer_mode);
+        else if (strcmp(option, "--log-stream") == 0) valid = parse_int(value, 0, &log_single_stream) && log_single_stream <= 1;
+        else if (strcmp(option, "--age-structure") == 0) valid = parse_int(value, 0, &age_structure_log) && age_structure_log <= 1;
+        else if (strcmp(option, "--ensemble") == 0) valid = parse_int(value, 0, &ensemble_statistics) && ensemble_statistics <= 1;
+        else if (strcmp(option, "--result-store") == 0) { result_store_path = value; valid = 1; }
+        else if (strcmp(option, "--checkpoint") == 0) valid = parse_int(value, 0, &checkpoint_interval);
+        else if (strcmp(option, "--resume") == 0) valid = parse_int(value, 0, &checkpoint_resume) && checkpoint_resume <= 1;
+        else if (strcmp(option, "--replay") == 0) { replay_list = value; valid = 1; }
+        else if (strcmp(option, "--progress-interval") == 0) valid = parse_int(value, 0, &progress_interval_ms);
+        else if (strcmp(option, "--progress-output") == 0) { progress_output = value; valid = 1; }
+        else if (strcmp(option, "--sweep") == 0) { sweep_path = value; valid = 1; }
+        else if (strcmp(option, "--check-variates") == 0) valid = parse_int(value, 2, &check_samples);
+        else if (strcmp(option, "--bench") == 0) { bench_name = value; valid = 1; }
+        else if (strcmp(option, "--bench-output") == 0) { bench_output = value; valid = 1; }
+        else {
+            fprintf(stderr, "Error: Unknown option %s (see --help)\n", option);
+            return 1;
+        }
+        if (!valid) {
+            fprintf(stderr, "Error: Invalid value '%s' for %s\n", value, option);
+            return 1;
+        }
+    }
+
+    // Every process runs with the seed of rank 0
+    cluster_broadcast_seed(&base_seed);
+    int is_root = (cluster_rank() == 0);
+
+    if (check_samples > 0)
+        return (!is_root || check_variate_distributions(check_samples, base_seed)) ? 0 : 1;
+
+    // A benchmark scenario replaces the simulation settings, the other options (threads, engine, logs) still apply
+    const s_bench_scenario *scenario = NULL;
+    if (bench_name) {
+        scenario = find_bench_scenario(bench_name);
+        if (!scenario)
+            return strcmp(bench_name, "list") == 0 ? 0 : 1;
+        defaults.months = scenario->months;
+        defaults.initial_population = scenario->initial_population;
+        defaults.nb_simulations = scenario->nb_simulations;
+        defaults.survival.method = scenario->method;
+        defaults.survival.init_rate = scenario->init_rate;
+        defaults.survival.adult_rate = scenario->adult_rate;
+        stop_mode = scenario->stop;
+        population_ceiling = BENCH_CEILING;
+        base_seed = BENCH_SEED;
+        sweep_path = NULL;
+        measure_phases = 1;
+    }
+
+    s_batch_point *points = &defaults;
+    int nb_points = 1;
+    if (sweep_path) {
+        nb_points = load_sweep_file(sweep_path, &defaults, &points);
+        if (nb_points < 0)
+            return 1;
+    }
+
+    char point_prefix[256];
+    for (int p = 0; p < nb_points; ++p) {
+        const s_batch_point *point = &points[p];
+        // Each sweep point gets its own set of log files
+        if (sweep_path)
+            snprintf(point_prefix, sizeof(point_prefix), "%spoint%03d_", prefix, p + 1);
+        else
+            snprintf(point_prefix, sizeof(point_prefix), "%s", prefix);
+        log_file_prefix = point_prefix;
+
+        if (is_root)
+            printf("\n--> Point %d / %d: %d months, population %d, %d simulations, %s survival (%.2f / %.2f), seed %" PRIu64 "\n",
+                   p + 1, nb_points, point->months, point->initial_population, point->nb_simulations,
+                   get_survival_method_name(point->survival.method), point->survival.init_rate, point->survival.adult_rate, base_seed);
+        if (replay_list) {
+            if (!replay_simulations(point->months, point->initial_population, point->nb_simulations, base_seed,
+                                    &point->survival)) {
+                free_simulation_pool();
+                return 1;
+            }
+            continue;
+        }
+        multi_simulate(point->months, point->initial_population, point->nb_simulations, base_seed, &point->survival);
+    }
+
+    if (scenario && is_root && !write_bench_metrics(bench_output, scenario)) {
+        free_simulation_pool();
+        return 1;
+    }
+
+    log_file_prefix = "";
+    if (points != &defaults)
+        free(points);
+    free_simulation_pool();
+    return 0;
+}
+
+// ===== END BATCH MODE =====
+
+int main(int argc, char *argv[])
 {
+    cluster_init(&argc, &argv);
+    if (argc > 1) {
+        int status = run_batch(argc, argv);
+        cluster_finalize();
+        return status;
+    }
+    if (cluster_size() > 1) {
+        // Only rank 0 would get the answers of the menu
+        if (cluster_rank() == 0)
+            fprintf(stderr, "Error: Runs over several MPI processes take their settings from the command line (see --help)\n");
+        cluster_finalize();
+        return 1;
+    }
+
     int exit_program = 0;
     int user_choice;
 
@@ -37,8 +517,13 @@ int main()
     //uint64_t base_seed = 1234997890123456700ULL;
     int seed_is_custom = 0;
 
+    // Survival model of the simulations, changed by the menu
+    s_survival_params survival = default_survival_params();
+
     if(!PRINT_OUTPUT){
-        multi_simulate(months, initial_population, nb_simulations, base_seed);
+        multi_simulate(months, initial_population, nb_simulations, base_seed, &survival);
+        free_simulation_pool();
+        cluster_finalize();
         return 0;
     }
     printf("Welcome to the Rabbit Simulation\n");
@@ -52,18 +537,37 @@ int main()
         printf("  - Months: %d\n", months);
         printf("  - Population: %d\n", initial_population);
         printf("  - Simulations: %d\n", nb_simulations);
+        printf("  - Threads per Simulation: %d%s\n", update_threads, update_threads == 0 ? " (serial update)" : "");
+        if (deme_count > 0)
+            printf("  - Demes per Simulation: %d (migration every %d months)\n", deme_count, migration_interval);
         printf("  - Seed: %" PRIu64 " (%s)\n", base_seed, seed_is_custom ? "User-Defined" : "Random");
-        printf("  - Survival Method: %s\n", get_survival_method_name(survival_method));
+        printf("  - Survival Method: %s\n", get_survival_method_name(survival.method));
+        printf("  - Engine: %s\n", get_simulation_engine_name(simulation_engine));
+        if (simulation_threads > 0)
+            printf("  - Parallel Simulations: %d threads, %s scheduling\n", simulation_threads, get_simulation_schedule_name(simulation_schedule));
+        else
+            printf("  - Parallel Simulations: all cores, %s scheduling\n", get_simulation_schedule_name(simulation_schedule));
+        printf("  - Early Stop: ");
+        print_stop_condition();
         
         printf("\nWhat do you want to do?\n");
         printf("    1. Change Simulation Parameters\n"
                "    2. Set a Custom Seed\n"
                "    3. Change Survival Method\n"
-               "    4. Start Simulation\n"
-               "    5. Exit\n"
+               "    4. Change Simulation Engine\n"
+               "    5. Change Parallel Settings\n"
+               "    6. Change Stop Conditions\n"
+               "    7. Start Simulation\n"
+               "    8. Exit\n"
                "Answer: ");
         
-        if (scanf("%d", &user_choice) != 1) {
+        int scanned = scanf("%d", &user_choice);
+        if (scanned == EOF) {
+            // No more input (closed or redirected stdin): leave instead of looping on the menu
+            printf("\nEnd of input. Exiting simulation. Goodbye!\n");
+            break;
+        }
+        if (scanned != 1) {
             clear_input_buffer();
             user_choice = -1; // Force default case
         } else {
@@ -95,6 +599,16 @@ int main()
                 clear_input_buffer();
             } else { clear_input_buffer(); }
 
+            printf("Enter threads per simulation (0 = serial update): ");
+            int threads_choice;
+            if (scanf("%d", &threads_choice) != 1 || threads_choice < 0) {
+                printf("Invalid input. Parameter not changed.\n");
+                clear_input_buffer();
+            } else {
+                update_threads = threads_choice;
+                clear_input_buffer();
+            }
+
             printf("Parameters updated.\n");
             break;
 
@@ -125,15 +639,15 @@ int main()
                 clear_input_buffer();
                 switch (method_choice) {
                     case 1:
-                        survival_method = SURVIVAL_STATIC;
+                        survival.method = SURVIVAL_STATIC;
                         printf("Survival method set to Static.\n");
                         break;
                     case 2:
-                        survival_method = SURVIVAL_GAUSSIAN;
+                        survival.method = SURVIVAL_GAUSSIAN;
                         printf("Survival method set to Gaussian.\n");
                         break;
                     case 3:
-                        survival_method = SURVIVAL_EXPONENTIAL;
+                        survival.method = SURVIVAL_EXPONENTIAL;
                         printf("Survival method set to Exponential.\n");
                         break;
                     default:
@@ -144,21 +658,146 @@ int main()
             break;
 
         case 4:
+            printf("Choose simulation engine:\n");
+            printf("  1. Individual (one record per rabbit)\n");
+            printf("  2. Cohort (identical rabbits grouped, faster for large populations)\n");
+            printf("  3. Event (only the events of each month, static method)\n");
+            printf("Enter choice (1-3): ");
+
+            int engine_choice;
+            if (scanf("%d", &engine_choice) != 1) {
+                printf("Invalid input. Simulation engine not changed.\n");
+                clear_input_buffer();
+            } else {
+                clear_input_buffer();
+                switch (engine_choice) {
+                    case 1:
+                        simulation_engine = ENGINE_INDIVIDUAL;
+                        printf("Simulation engine set to Individual.\n");
+                        break;
+                    case 2:
+                        simulation_engine = ENGINE_COHORT;
+                        printf("Simulation engine set to Cohort.\n");
+                        break;
+                    case 3:
+                        simulation_engine = ENGINE_EVENT;
+                        printf("Simulation engine set to Event.\n");
+                        break;
+                    default:
+                        printf("Invalid choice. Simulation engine not changed.\n");
+                        break;
+                }
+            }
+            break;
+
+        case 5:
+            printf("Enter number of threads running simulations (0 = all cores): ");
+            int sim_threads_choice;
+            if (scanf("%d", &sim_threads_choice) != 1 || sim_threads_choice < 0) {
+                printf("Invalid input. Thread count not changed.\n");
+                clear_input_buffer();
+            } else {
+                simulation_threads = sim_threads_choice;
+                clear_input_buffer();
+            }
+
+            printf("Choose scheduling of the simulations over the threads:\n");
+            printf("  1. Static (fixed blocks of simulations per thread)\n");
+            printf("  2. Dynamic (next simulation to the first free thread)\n");
+            printf("  3. Guided (shrinking blocks)\n");
+            printf("Enter choice (1-3): ");
+
+            int schedule_choice;
+            if (scanf("%d", &schedule_choice) != 1) {
+                printf("Invalid input. Scheduling not changed.\n");
+                clear_input_buffer();
+            } else {
+                clear_input_buffer();
+                switch (schedule_choice) {
+                    case 1:
+                        simulation_schedule = SCHEDULE_STATIC;
+                        printf("Scheduling set to Static.\n");
+                        break;
+                    case 2:
+                        simulation_schedule = SCHEDULE_DYNAMIC;
+                        printf("Scheduling set to Dynamic.\n");
+                        break;
+                    case 3:
+                        simulation_schedule = SCHEDULE_GUIDED;
+                        printf("Scheduling set to Guided.\n");
+                        break;
+                    default:
+                        printf("Invalid choice. Scheduling not changed.\n");
+                        break;
+                }
+            }
+            break;
+
+        case 6:
+            printf("Choose early stop condition:\n");
+            printf("  1. None (stop on extinction only)\n");
+            printf("  2. Stop at a population ceiling\n");
+            printf("  3. Switch to the cohort engine at a population ceiling\n");
+            printf("  4. Stop when extinction becomes less likely than a threshold\n");
+            printf("Enter choice (1-4): ");
+
+            int stop_choice;
+            if (scanf("%d", &stop_choice) != 1 || stop_choice < 1 || stop_choice > 4) {
+                printf("Invalid input. Stop condition not changed.\n");
+                clear_input_buffer();
+                break;
+            }
+            clear_input_buffer();
+
+            if (stop_choice == 2 || stop_choice == 3) {
+                printf("Enter population ceiling: ");
+                long long ceiling_choice;
+                if (scanf("%lld", &ceiling_choice) != 1 || ceiling_choice <= 0) {
+                    printf("Invalid input. Stop condition not changed.\n");
+                    clear_input_buffer();
+                    break;
+                }
+                clear_input_buffer();
+                population_ceiling = ceiling_choice;
+            } else if (stop_choice == 4) {
+                printf("Enter extinction probability threshold (e.g. 1e-9): ");
+                double confidence_choice;
+                if (scanf("%lf", &confidence_choice) != 1 || confidence_choice <= 0.0 || confidence_choice >= 1.0) {
+                    printf("Invalid input. Stop condition not changed.\n");
+                    clear_input_buffer();
+                    break;
+                }
+                clear_input_buffer();
+                extinction_confidence = confidence_choice;
+            }
+
+            switch (stop_choice) {
+                case 1: stop_mode = STOP_NONE; break;
+                case 2: stop_mode = STOP_CEILING; break;
+                case 3: stop_mode = STOP_SWITCH_TO_COHORT; break;
+                case 4: stop_mode = STOP_CONFIDENCE; break;
+            }
+            printf("Stop condition updated.\n");
+            break;
+
+        case 7:
             printf("--> Starting simulation with the current settings...\n");
-            multi_simulate(months, initial_population, nb_simulations, base_seed);
+            multi_simulate(months, initial_population, nb_simulations, base_seed, &survival);
             printf("\n\n--> Simulation finished.\n");
             break;
 
-        case 5:
+        case 8:
             exit_program = 1;
             printf("Exiting simulation. Goodbye!\n");
             break;
 
         default:
-            printf("Invalid answer! Please choose an option from 1 to 5.\n");
+            printf("Invalid answer! Please choose an option from 1 to 8.\n");
             break;
         }
     }
 
+    free_simulation_pool();
+    cluster_finalize();
     return 0;
 }
\ No newline at end of file
@@ -114,3 +114,26 @@ uint32_t pcg32_boundedrand(uint32_t bound)
     return pcg32_boundedrand_r(&pcg32_global, bound);
 }
 
+// pcg32_advance_r(rng, delta)
+//     Multi-step advance function (jump-ahead, jump-back), as in the full C
+//     implementation: moves the rng delta steps in O(log delta) by composing
+//     the LCG step with itself (Brown, "Random Number Generation with
+//     Arbitrary Stride").
+
+void pcg32_advance_r(pcg32_random_t* rng, uint64_t delta)
+{
+    uint64_t cur_mult = 6364136223846793005ULL;
+    uint64_t cur_plus = rng->inc;
+    uint64_t acc_mult = 1u;
+    uint64_t acc_plus = 0u;
+    while (delta > 0) {
+        if (delta & 1) {
+            acc_mult *= cur_mult;
+            acc_plus = acc_plus * cur_mult + cur_plus;
+        }
+        cur_plus = (cur_mult + 1) * cur_plus;
+        cur_mult *= cur_mult;
+        delta /= 2;
+    }
+    rng->state = acc_mult * rng->state + acc_plus;
+}
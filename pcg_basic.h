@@ -71,6 +71,11 @@ uint32_t pcg32_random_r(pcg32_random_t* rng);
 uint32_t pcg32_boundedrand(uint32_t bound);
 uint32_t pcg32_boundedrand_r(pcg32_random_t* rng, uint32_t bound);
 
+// pcg32_advance_r(rng, delta):
+//     Advance the rng by delta steps (as if delta numbers had been drawn) in O(log delta)
+
+void pcg32_advance_r(pcg32_random_t* rng, uint64_t delta);
+
 #if __cplusplus
 }
 #endif
@@ -0,0 +1,115 @@
+#include "pcg_batch.h"
+#include "instrument.h"
+
+/**
+ * @brief Seeds every lane of a multi-stream generator.
+ *        Lane k uses stream initseq * PCG32X_LANES + k, so different initseq values
+ *        (e.g. simulation indices) never share a lane stream.
+ * @param rng A pointer to the multi-stream generator.
+ * @param initstate The state initializer, common to all lanes.
+ * @param initseq The sequence selection constant.
+ * @return void
+ */
+void pcg32x_srandom_r(pcg32x_random_t *rng, uint64_t initstate, uint64_t initseq)
+{
+    for (int k = 0; k < PCG32X_LANES; ++k)
+    {
+        pcg32_random_t lane;
+        pcg32_srandom_r(&lane, initstate, initseq * PCG32X_LANES + (uint64_t)k);
+        rng->state[k] = lane.state;
+        rng->inc[k] = lane.inc;
+    }
+    // The buffer is filled on first use
+    rng->pos = PCG32X_BUFFER_SIZE;
+    rng->refills = 0;
+}
+
+/**
+ * @brief Refills the output buffer by stepping all lanes in lockstep.
+ *        The inner loop has no dependency between lanes and is written so the compiler can vectorize it.
+ * @param rng A pointer to the multi-stream generator.
+ * @return void
+ */
+void pcg32x_refill_r(pcg32x_random_t *rng)
+{
+    uint64_t state[PCG32X_LANES];
+    uint64_t inc[PCG32X_LANES];
+    for (int k = 0; k < PCG32X_LANES; ++k)
+    {
+        state[k] = rng->state[k];
+        inc[k] = rng->inc[k];
+    }
+
+    for (int j = 0; j < PCG32X_BUFFER_SIZE; j += PCG32X_LANES)
+    {
+        for (int k = 0; k < PCG32X_LANES; ++k)
+        {
+            uint64_t oldstate = state[k];
+            state[k] = oldstate * 6364136223846793005ULL + inc[k];
+            uint32_t xorshifted = (uint32_t)(((oldstate >> 18u) ^ oldstate) >> 27u);
+            uint32_t rot = (uint32_t)(oldstate >> 59u);
+            rng->buffer[j + k] = (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+        }
+    }
+
+    for (int k = 0; k < PCG32X_LANES; ++k)
+        rng->state[k] = state[k];
+    rng->pos = 0;
+    rng->refills++;
+    INSTRUMENT_COUNT(rng_outputs, PCG32X_BUFFER_SIZE);
+}
+
+/**
+ * @brief Generates a uniformly distributed number r, where 0 <= r < bound,
+ *        with the same unbiased rejection scheme as pcg32_boundedrand_r.
+ * @param rng A pointer to the multi-stream generator.
+ * @param bound The exclusive upper bound.
+ * @return A random number in [0, bound).
+ */
+uint32_t pcg32x_boundedrand_r(pcg32x_random_t *rng, uint32_t bound)
+{
+    uint32_t threshold = -bound % bound;
+    for (;;) {
+        uint32_t r = pcg32x_random_r(rng);
+        if (r >= threshold)
+            return r % bound;
+    }
+}
+
+/**
+ * @brief Skips outputs of a multi-stream generator, leaving it exactly as if they had been drawn
+ *        with pcg32x_random_r. Whole buffers are jumped over in every lane with pcg32_advance_r,
+ *        so the cost is O(log delta) instead of O(delta).
+ * @param rng A pointer to the multi-stream generator.
+ * @param delta The number of outputs to skip.
+ * @return void
+ */
+void pcg32x_advance_r(pcg32x_random_t *rng, uint64_t delta)
+{
+    uint64_t left = (uint64_t)(PCG32X_BUFFER_SIZE - rng->pos);
+    if (delta <= left)
+    {
+        rng->pos += (int)delta;
+        return;
+    }
+    delta -= left;
+
+    // Every lane steps PCG32X_BUFFER_SIZE / PCG32X_LANES times per buffer
+    uint64_t buffers = delta / PCG32X_BUFFER_SIZE;
+    for (int k = 0; k < PCG32X_LANES; ++k)
+    {
+        pcg32_random_t lane = { rng->state[k], rng->inc[k] };
+        pcg32_advance_r(&lane, buffers * (PCG32X_BUFFER_SIZE / PCG32X_LANES));
+        rng->state[k] = lane.state;
+    }
+    rng->refills += buffers;
+    rng->pos = PCG32X_BUFFER_SIZE;
+
+    // The rest of the outputs come from the next buffer
+    uint64_t rest = delta % PCG32X_BUFFER_SIZE;
+    if (rest > 0)
+    {
+        pcg32x_refill_r(rng);
+        rng->pos = (int)rest;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef PCG_BATCH_H
+#define PCG_BATCH_H
+
+// Multi-stream PCG32 generator for the simulation hot loop.
+// PCG32X_LANES independent PCG32 streams (same LCG step and output permutation as pcg_basic.c)
+// are advanced in lockstep to fill a buffer of raw 32-bit outputs in one vectorizable loop.
+// Callers then consume the buffer one value at a time with pcg32x_random_r, which only
+// costs a load and an index increment until the buffer needs refilling.
+// The sequence is fully determined by (initstate, initseq), like pcg32_srandom_r, so the generator
+// at any point is also determined by the number of outputs drawn since seeding: pcg32x_advance_r
+// jumps over outputs without generating them (see checkpoint.h).
+
+#include <stdint.h>
+#include "pcg_basic.h"
+
+// Number of PCG32 streams stepped together (4, 8 or 16)
+#ifndef PCG32X_LANES
+#define PCG32X_LANES 8
+#endif
+
+// Number of outputs produced by one refill, must be a multiple of PCG32X_LANES
+#define PCG32X_BUFFER_SIZE 1024
+
+typedef struct {
+    uint64_t state[PCG32X_LANES];       // RNG state of each lane
+    uint64_t inc[PCG32X_LANES];         // Stream selector of each lane, always odd
+    uint32_t buffer[PCG32X_BUFFER_SIZE];// Outputs not consumed yet
+    int pos;                            // Index of the next output to consume in buffer
+    uint64_t refills;                   // Buffers filled since seeding (see pcg32x_outputs_drawn)
+} pcg32x_random_t;
+
+void pcg32x_srandom_r(pcg32x_random_t *rng, uint64_t initstate, uint64_t initseq);
+void pcg32x_refill_r(pcg32x_random_t *rng);
+uint32_t pcg32x_boundedrand_r(pcg32x_random_t *rng, uint32_t bound);
+void pcg32x_advance_r(pcg32x_random_t *rng, uint64_t delta);
+
+// pcg32x_outputs_drawn(rng)
+//     Return the number of outputs consumed since the generator was seeded
+static inline uint64_t pcg32x_outputs_drawn(const pcg32x_random_t *rng)
+{
+    return rng->refills * PCG32X_BUFFER_SIZE + (uint64_t)rng->pos - PCG32X_BUFFER_SIZE;
+}
+
+// pcg32x_random_r(rng)
+//     Return the next uniformly distributed 32-bit random number from the buffer
+static inline uint32_t pcg32x_random_r(pcg32x_random_t *rng)
+{
+    if (rng->pos == PCG32X_BUFFER_SIZE)
+        pcg32x_refill_r(rng);
+    return rng->buffer[rng->pos++];
+}
+
+#endif
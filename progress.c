@@ -0,0 +1,157 @@
+#define _POSIX_C_SOURCE 200809L  // For clock_gettime with -std=c11
+
+#include "progress.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+// Global variables for the reports of the progress reporter
+int progress_interval_ms = DEFAULT_PROGRESS_INTERVAL_MS;
+const char *progress_output = NULL;
+
+// Counters fed by the simulation threads
+static atomic_llong progress_completed;
+static atomic_llong progress_months;
+static atomic_llong progress_updates;
+static atomic_llong progress_extinctions;
+
+static pthread_mutex_t progress_lock = PTHREAD_MUTEX_INITIALIZER;  // Guards progress_stopping for the timed wait
+static pthread_cond_t progress_wakeup = PTHREAD_COND_INITIALIZER;
+static int progress_stopping = 0;
+static pthread_t progress_thread;
+static int progress_thread_running = 0;
+static int progress_total = 0;
+static double progress_start = 0.0;
+static FILE *progress_file = NULL;
+
+/**
+ * @brief Reads the monotonic clock.
+ * @return The time in seconds.
+ */
+static double progress_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Reports the counters once: the progress line of the terminal and a JSON line.
+ * @param final 1 for the last report of the run.
+ * @return void
+ */
+static void report_progress(int final)
+{
+    long long completed = atomic_load_explicit(&progress_completed, memory_order_relaxed);
+    double elapsed = progress_now() - progress_start;
+
+    if (PRINT_OUTPUT && progress_interval_ms > 0 && !final)
+    {
+        LOG_PRINT("\r    Completed Simulations: %3lld / %3d (%3.0f%%)", completed, progress_total,
+                  progress_total > 0 ? (float)completed * 100.0f / progress_total : 100.0f);
+        fflush(stdout);
+    }
+    if (progress_file)
+    {
+        fprintf(progress_file, "{\"elapsed_s\": %.3f, \"completed\": %lld, \"total\": %d, \"simulations_per_s\": %.2f, "
+                               "\"months_simulated\": %lld, \"rabbit_updates\": %lld, \"extinctions\": %lld, "
+                               "\"final\": %s}\n",
+                elapsed, completed, progress_total, elapsed > 0.0 ? completed / elapsed : 0.0,
+                atomic_load_explicit(&progress_months, memory_order_relaxed),
+                atomic_load_explicit(&progress_updates, memory_order_relaxed),
+                atomic_load_explicit(&progress_extinctions, memory_order_relaxed), final ? "true" : "false");
+        fflush(progress_file);
+    }
+}
+
+/**
+ * @brief Main loop of the reporter thread: one report every progress_interval_ms until the run stops.
+ * @param arg Unused.
+ * @return NULL
+ */
+static void *progress_reporter_main(void *arg)
+{
+    (void)arg;
+    int interval = progress_interval_ms > 0 ? progress_interval_ms : DEFAULT_PROGRESS_INTERVAL_MS;
+    pthread_mutex_lock(&progress_lock);
+    while (!progress_stopping)
+    {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += interval / 1000;
+        deadline.tv_nsec += (long)(interval % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        if (pthread_cond_timedwait(&progress_wakeup, &progress_lock, &deadline) != 0 && !progress_stopping)
+            report_progress(0);
+    }
+    pthread_mutex_unlock(&progress_lock);
+    return NULL;
+}
+
+/**
+ * @brief Resets the counters and starts the reporter thread for a run (nothing to start without any report).
+ *        If the thread cannot be created the run goes on without progress reports.
+ * @param nb_simulations The number of simulations of the run (of this process, see cluster.h).
+ * @return void
+ */
+void start_progress_reporter(int nb_simulations)
+{
+    atomic_store(&progress_completed, 0);
+    atomic_store(&progress_months, 0);
+    atomic_store(&progress_updates, 0);
+    atomic_store(&progress_extinctions, 0);
+    progress_total = nb_simulations;
+    progress_start = progress_now();
+    progress_stopping = 0;
+
+    progress_file = NULL;
+    if (progress_output)
+    {
+        progress_file = fopen(progress_output, "a");
+        if (!progress_file)
+            LOG_PRINT("Warning: Could not open the progress output %s\n", progress_output);
+    }
+    progress_thread_running = (progress_interval_ms > 0 || progress_file) &&
+                              pthread_create(&progress_thread, NULL, progress_reporter_main, NULL) == 0;
+}
+
+/**
+ * @brief Adds a finished simulation to the counters (called by the simulation threads, lock-free).
+ * @param results The results of the simulation.
+ * @return void
+ */
+void report_simulation_done(const s_simulation_results *results)
+{
+    atomic_fetch_add_explicit(&progress_months, results->months_simulated, memory_order_relaxed);
+    atomic_fetch_add_explicit(&progress_updates, results->rabbit_updates, memory_order_relaxed);
+    atomic_fetch_add_explicit(&progress_extinctions, results->extinction_month > 0, memory_order_relaxed);
+    atomic_fetch_add_explicit(&progress_completed, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Stops the reporter thread once every simulation is done and writes the final JSON line.
+ * @return void
+ */
+void stop_progress_reporter(void)
+{
+    if (progress_thread_running)
+    {
+        pthread_mutex_lock(&progress_lock);
+        progress_stopping = 1;
+        pthread_cond_signal(&progress_wakeup);
+        pthread_mutex_unlock(&progress_lock);
+        pthread_join(progress_thread, NULL);
+        progress_thread_running = 0;
+    }
+    report_progress(1);
+    if (progress_file)
+    {
+        fclose(progress_file);
+        progress_file = NULL;
+    }
+}
@@ -0,0 +1,25 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+// Progress of a multi_simulate run, reported by a dedicated thread.
+// The simulation threads only add their finished simulations to a few atomic counters and
+// never print; the reporter thread reads the counters every progress_interval_ms milliseconds,
+// rewrites the "Completed Simulations" line of the terminal and, with progress_output, appends one
+// JSON object per line to that file (a named pipe works too, for a monitoring process):
+//   {"elapsed_s": ..., "completed": ..., "total": ..., "simulations_per_s": ..., "months_simulated": ...,
+//    "rabbit_updates": ..., "extinctions": ..., "final": false}
+// The last line of a run has "final": true. What is reported never depends on which thread ran what.
+
+#include "rabbitsim.h"
+
+#define DEFAULT_PROGRESS_INTERVAL_MS 500
+
+// Global variables for the milliseconds between two reports (0 for none) and the JSON lines file (NULL for none)
+extern int progress_interval_ms;
+extern const char *progress_output;
+
+void start_progress_reporter(int nb_simulations);
+void report_simulation_done(const s_simulation_results *results);
+void stop_progress_reporter(void);
+
+#endif
@@ -1,20 +1,69 @@
+#define _DEFAULT_SOURCE  // For MAP_ANONYMOUS, MAP_NORESERVE and madvise with -std=c11
 #include "rabbitsim.h" 
+#include "cohort.h"
+#include "event.h"
+#include "variates.h"
+#include "log_writer.h"
+#include "ensemble.h"
+#include "checkpoint.h"
+#include "deme.h"
+#include "cluster.h"
+#include "progress.h"
+#include "result_store.h"
 
-// Global variable for survival calculation method
-survival_method_t survival_method = SURVIVAL_STATIC;
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Global variable for the simulation engine
+simulation_engine_t simulation_engine = ENGINE_INDIVIDUAL;
+
+// Global variable for the number of threads updating a single simulation (0 for serial)
+int update_threads = 0;
+
+// Global variable prepended to the names of the log files (used by the batch mode to keep one set of files per sweep point)
+const char *log_file_prefix = "";
+
+// Global variables for the format of the log files and the number of simulations logged month by month
+log_format_t log_format = LOG_FORMAT_CSV;
+int simulations_to_log = MAX_SIMULATIONS_TO_LOG;
+int age_structure_log = 1;
+
+// Global variables for the phase timers and the metrics of the last multi_simulate run
+int measure_phases = 0;
+s_run_metrics last_run_metrics;
+
+// Global variables for the early stop conditions of simulate
+stop_mode_t stop_mode = STOP_NONE;
+long long population_ceiling = DEFAULT_POPULATION_CEILING;
+double extinction_confidence = DEFAULT_EXTINCTION_CONFIDENCE;
+
+// Global variables for the threads running simulations in parallel and how they are scheduled
+int simulation_threads = NUM_THREADS;
+simulation_schedule_t simulation_schedule = SCHEDULE_DYNAMIC;
+
+// Global variables for the growth policy of the rabbit storage
+storage_growth_t storage_growth = GROWTH_REALLOC;
+size_t reserved_rabbits = DEFAULT_RESERVED_RABBITS;
+
+// One simulation instance per OpenMP thread, reused by multi_simulate from one run to the next
+static s_simulation_instance *simulation_pool = NULL;
+static int simulation_pool_size = 0;
 
 
 
 
 
 /**
- * @brief Generates a random double-precision floating-point number between 0 (inclusive) and 1 (exclusive).
+ * @brief Generates a random double-precision floating-point number between 0 and 1 (inclusive).
+ *        The raw output comes from the buffered multi-stream generator, and the scaling uses
+ *        a multiplication by a constant instead of a division.
  * @param rng A pointer to the PCG random number generator state.
- * @return A double representing a random number in [0, 1).
+ * @return A double representing a random number in [0, 1].
  */
-double genrand_real(pcg32_random_t *rng)
+double genrand_real(pcg32x_random_t *rng)
 {
-    return (double)pcg32_random_r(rng) / (double)UINT32_MAX;
+    return (double)pcg32x_random_r(rng) * (1.0 / (double)UINT32_MAX);
 }
 
 /**
@@ -29,30 +78,312 @@ int fibonacci(int n)
     return fibonacci(n - 1) + fibonacci(n - 2);
 }
 
+/**
+ * @brief Rounds a size in bytes up to whole pages.
+ * @param size The size in bytes.
+ * @return The rounded size.
+ */
+static size_t page_round_up(size_t size)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (size + page - 1) / page * page;
+}
+
+/**
+ * @brief Resizes one array of the rabbit storage (the AoS array or a SoA column).
+ *        Heap arrays are reallocated. Reserved arrays (see storage_growth) are mapped once to
+ *        their reserved size without memory behind them, then only the pages up to the new
+ *        capacity are made usable; pages past it are given back, nothing is ever copied.
+ * @param array A pointer to the array pointer, updated on success.
+ * @param elem_size The size in bytes of one element of the array.
+ * @param old_capacity The number of elements the array holds now.
+ * @param new_capacity The number of elements the array must be able to hold.
+ * @param reserved The elements of address space reserved for the array (0 for a heap array).
+ * @return 1 on success, 0 if the allocation failed (the array is left untouched).
+ */
+static int resize_array(void **array, size_t elem_size, size_t old_capacity, size_t new_capacity, size_t reserved)
+{
+    if (reserved == 0)
+    {
+        void *temp = realloc(*array, elem_size * new_capacity);
+        if (!temp)
+            return 0;
+        *array = temp;
+        return 1;
+    }
+
+    if (new_capacity > reserved)
+        return 0;
+    if (!*array)
+    {
+        void *base = mmap(NULL, page_round_up(elem_size * reserved), PROT_NONE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (base == MAP_FAILED)
+            return 0;
+        *array = base;
+        old_capacity = 0;
+    }
+
+    size_t old_size = page_round_up(elem_size * old_capacity);
+    size_t new_size = page_round_up(elem_size * new_capacity);
+    char *base = *array;
+    if (new_size > old_size)
+        return mprotect(base + old_size, new_size - old_size, PROT_READ | PROT_WRITE) == 0;
+    if (new_size < old_size)
+    {
+        madvise(base + new_size, old_size - new_size, MADV_DONTNEED);
+        mprotect(base + new_size, old_size - new_size, PROT_NONE);
+    }
+    return 1;
+}
+
+/**
+ * @brief Releases one array of the rabbit storage allocated by resize_array.
+ * @param array A pointer to the array pointer, set to NULL.
+ * @param elem_size The size in bytes of one element of the array.
+ * @param reserved The elements of address space reserved for the array (0 for a heap array).
+ * @return void
+ */
+static void release_array(void **array, size_t elem_size, size_t reserved)
+{
+    if (*array && reserved > 0)
+        munmap(*array, page_round_up(elem_size * reserved));
+    else
+        free(*array);
+    *array = NULL;
+}
+
+/**
+ * @brief Releases the whole rabbit storage of a simulation instance.
+ * @param sim A pointer to the s_simulation_instance.
+ * @return void
+ */
+static void release_storage(s_simulation_instance *sim)
+{
+    size_t reserved = sim->rabbit_reserved;
+#if RABBIT_STORAGE_SOA
+    release_array((void **)&sim->columns.age, sizeof(uint16_t), reserved);
+    release_array((void **)&sim->columns.maturity_age, sizeof(uint16_t), reserved);
+    release_array((void **)&sim->columns.flags, sizeof(uint8_t), reserved);
+    release_array((void **)&sim->columns.nb_litters_y, sizeof(uint8_t), reserved);
+    release_array((void **)&sim->columns.nb_litters, sizeof(uint8_t), reserved);
+    release_array((void **)&sim->columns.survival_rate, sizeof(float), reserved);
+#else
+    release_array((void **)&sim->rabbits, sizeof(s_rabbit), reserved);
+#endif
+    sim->rabbit_capacity = 0;
+    sim->rabbit_reserved = 0;
+}
+
+/**
+ * @brief Reallocates the rabbit storage of a simulation instance to a new capacity (larger or smaller).
+ *        The first allocation follows storage_growth, and the storage keeps that policy until it is released.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param new_capacity The number of rabbits the storage must be able to hold (at least rabbit_count).
+ * @return 1 on success, 0 if the allocation failed (the current capacity is kept).
+ */
+static int resize_storage(s_simulation_instance *sim, size_t new_capacity)
+{
+    if (sim->rabbit_capacity == 0)
+    {
+        release_storage(sim);
+        sim->rabbit_reserved = (storage_growth == GROWTH_RESERVE) ? reserved_rabbits : 0;
+    }
+    size_t old = sim->rabbit_capacity;
+    size_t reserved = sim->rabbit_reserved;
+#if RABBIT_STORAGE_SOA
+    if (!resize_array((void **)&sim->columns.age, sizeof(uint16_t), old, new_capacity, reserved) ||
+        !resize_array((void **)&sim->columns.maturity_age, sizeof(uint16_t), old, new_capacity, reserved) ||
+        !resize_array((void **)&sim->columns.flags, sizeof(uint8_t), old, new_capacity, reserved) ||
+        !resize_array((void **)&sim->columns.nb_litters_y, sizeof(uint8_t), old, new_capacity, reserved) ||
+        !resize_array((void **)&sim->columns.nb_litters, sizeof(uint8_t), old, new_capacity, reserved))
+        return 0;
+    // The static method compares raw draws with its threshold table and never needs the rate column
+    if (sim->survival.method != SURVIVAL_STATIC &&
+        !resize_array((void **)&sim->columns.survival_rate, sizeof(float), old, new_capacity, reserved))
+        return 0;
+#else
+    if (!resize_array((void **)&sim->rabbits, sizeof(s_rabbit), old, new_capacity, reserved))
+        return 0;
+#endif
+
+    sim->rabbit_capacity = new_capacity;
+    return 1;
+}
+
+/**
+ * @brief Matches the rabbit storage with the growth policy and the survival method of a simulation about to start.
+ *        Storage of the other growth policy is released, ensure_capacity allocates it again.
+ *        The static method frees the survival rate column; the random methods allocate it again if a static run
+ *        dropped it. If that allocation fails the whole storage is released.
+ * @param sim A pointer to the s_simulation_instance (empty, see rewind_population).
+ * @return void
+ */
+void prepare_survival_storage(s_simulation_instance *sim)
+{
+    if ((sim->rabbit_reserved != 0) != (storage_growth == GROWTH_RESERVE) ||
+        (sim->rabbit_reserved != 0 && sim->rabbit_reserved != reserved_rabbits))
+        release_storage(sim);
+#if RABBIT_STORAGE_SOA
+    if (sim->survival.method == SURVIVAL_STATIC)
+    {
+        release_array((void **)&sim->columns.survival_rate, sizeof(float), sim->rabbit_reserved);
+    }
+    else if (!sim->columns.survival_rate && sim->rabbit_capacity > 0 &&
+             !resize_array((void **)&sim->columns.survival_rate, sizeof(float), 0, sim->rabbit_capacity,
+                           sim->rabbit_reserved))
+    {
+        release_storage(sim);
+    }
+#endif
+}
+
+/**
+ * @brief Grows the rabbit storage, by the usual 1.3 factor or more, until it can hold a number of rabbits.
+ *        Reserved storage grows at most to its reservation: past it, the storage is filled up to the
+ *        reservation and the rabbits beyond it do not fit.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param needed The number of rabbits the storage must be able to hold.
+ * @return 1 if the capacity is sufficient or successfully increased, 0 otherwise.
+ */
+static int ensure_room(s_simulation_instance *sim, size_t needed)
+{
+    if (needed <= sim->rabbit_capacity)
+        return 1;
+    size_t initial = sim->initial_capacity ? sim->initial_capacity : INIT_RABIT_CAPACITY;
+    size_t new_capacity = (sim->rabbit_capacity == 0) ? initial : sim->rabbit_capacity * 1.3;
+    if (new_capacity < needed)
+        new_capacity = needed;
+    if (sim->rabbit_reserved != 0 && new_capacity > sim->rabbit_reserved)
+    {
+        new_capacity = sim->rabbit_reserved;
+        if (new_capacity <= sim->rabbit_capacity)
+            return 0;
+    }
+    INSTRUMENT_COUNT(capacity_grows, 1);
+    return resize_storage(sim, new_capacity) && needed <= new_capacity;
+}
+
 /**
  * @brief Ensures that the simulation instance has enough capacity to add more rabbits.
- *        If not, it reallocates memory for the rabbits and free_indices arrays to increase the current capacity.
+ *        If not, it reallocates memory for the rabbits array to increase the current capacity.
  * @param sim A pointer to the s_simulation_instance.
  * @return 1 if the capacity is sufficient or successfully increased, 0 otherwise.
  */
 int ensure_capacity(s_simulation_instance *sim)
 {
-    if (sim->rabbit_count < sim->rabbit_capacity)
+    return ensure_room(sim, sim->rabbit_count + 1);
+}
+
+/**
+ * @brief Makes room for a number of rabbits in one reallocation (used to restore a checkpoint).
+ * @param sim A pointer to the s_simulation_instance.
+ * @param count The number of rabbits the storage must be able to hold.
+ * @return 1 if the capacity is sufficient or successfully increased, 0 otherwise.
+ */
+int reserve_rabbits(s_simulation_instance *sim, size_t count)
+{
+    if (count <= sim->rabbit_capacity)
         return 1;
-    size_t new_capacity = (sim->rabbit_capacity == 0) ? INIT_RABIT_CAPACITY : sim->rabbit_capacity * 1.3;
+    INSTRUMENT_COUNT(capacity_grows, 1);
+    return resize_storage(sim, count);
+}
 
-    s_rabbit *temp_rabbits = realloc(sim->rabbits, sizeof(s_rabbit) * new_capacity);
-    if (!temp_rabbits)
+/**
+ * @brief Copies a range of the rabbits of one instance to the end of the array of another (used by the demes).
+ *        Only the rabbits are copied: the counts and statistics of both instances are left to
+ *        refresh_population_stats, and the source keeps its rabbits until its rabbit_count is lowered.
+ * @param dst A pointer to the s_simulation_instance receiving the rabbits (same survival method as src).
+ * @param src A pointer to the s_simulation_instance holding the rabbits.
+ * @param first The index of the first rabbit to copy.
+ * @param count The number of rabbits to copy.
+ * @return 1 on success, 0 if the storage of dst could not grow (nothing is copied).
+ */
+int append_rabbits(s_simulation_instance *dst, const s_simulation_instance *src, size_t first, size_t count)
+{
+    if (!ensure_room(dst, dst->rabbit_count + count))
         return 0;
-    sim->rabbits = temp_rabbits;
+    size_t at = dst->rabbit_count;
+#if RABBIT_STORAGE_SOA
+    memcpy(dst->columns.age + at, src->columns.age + first, count * sizeof(uint16_t));
+    memcpy(dst->columns.maturity_age + at, src->columns.maturity_age + first, count * sizeof(uint16_t));
+    memcpy(dst->columns.flags + at, src->columns.flags + first, count * sizeof(uint8_t));
+    memcpy(dst->columns.nb_litters_y + at, src->columns.nb_litters_y + first, count * sizeof(uint8_t));
+    memcpy(dst->columns.nb_litters + at, src->columns.nb_litters + first, count * sizeof(uint8_t));
+    if (dst->columns.survival_rate && src->columns.survival_rate)
+        memcpy(dst->columns.survival_rate + at, src->columns.survival_rate + first, count * sizeof(float));
+#else
+    memcpy(dst->rabbits + at, src->rabbits + first, count * sizeof(s_rabbit));
+#endif
+    dst->rabbit_count += count;
+    return 1;
+}
 
-    int *temp_indices = realloc(sim->free_indices, sizeof(int) * new_capacity);
-    if (!temp_indices)
-        return 0;
-    sim->free_indices = temp_indices;
+/**
+ * @brief Recomputes the sex distribution and the statistics of the living rabbits from the rabbits array,
+ *        after rabbits were moved in or out of it as a block (see append_rabbits).
+ * @param sim A pointer to the s_simulation_instance.
+ * @return void
+ */
+void refresh_population_stats(s_simulation_instance *sim)
+{
+    int males = 0;
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    s_population_stats stats = { 0 };
+    s_age_histogram *ages = &sim->ages;
+    if (ages->rows > 0)
+        clear_age_histogram(ages);
+    #endif
+    for (size_t i = 0; i < sim->rabbit_count; ++i)
+    {
+        males += RABBIT_FLAG(sim, i, sex);
+        #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+        if (ages->rows > 0)
+            AGE_HISTOGRAM_CELL(ages, RABBIT_FIELD(sim, i, age),
+                               AGE_CLASS(RABBIT_FLAG(sim, i, sex), RABBIT_FLAG(sim, i, mature)))++;
+        stats.pregnant_females += RABBIT_FLAG(sim, i, pregnant);
+        #endif
+    }
+    sim->sex_distribution[1] = males;
+    sim->sex_distribution[0] = (int)sim->rabbit_count - males;
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    sim->stats = stats;
+    #endif
+}
 
-    sim->rabbit_capacity = new_capacity;
-    return 1;
+/**
+ * @brief Computes the initial capacity of the rabbits array for a given starting population,
+ *        INIT_CAPACITY_FACTOR rabbits per starting rabbit, between MIN_RABBIT_CAPACITY and INIT_RABIT_CAPACITY.
+ *        Small populations that die out quickly no longer pay for a million rabbits.
+ * @param initial_population_nb The initial number of rabbits.
+ * @return The initial capacity in rabbits.
+ */
+size_t initial_rabbit_capacity(int initial_population_nb)
+{
+    size_t capacity = (initial_population_nb > 0) ? (size_t)initial_population_nb * INIT_CAPACITY_FACTOR : 0;
+    if (capacity < MIN_RABBIT_CAPACITY)
+        capacity = MIN_RABBIT_CAPACITY;
+    if (capacity > INIT_RABIT_CAPACITY)
+        capacity = INIT_RABIT_CAPACITY;
+    return capacity;
+}
+
+/**
+ * @brief Releases memory when the rabbits array is grossly oversized, typically after a population crash.
+ *        The capacity is halved down to twice the living population, never below the initial capacity.
+ * @param sim A pointer to the s_simulation_instance.
+ * @return void
+ */
+void shrink_capacity(s_simulation_instance *sim)
+{
+    size_t initial = sim->initial_capacity ? sim->initial_capacity : INIT_RABIT_CAPACITY;
+    if (sim->rabbit_capacity <= initial || sim->rabbit_count >= sim->rabbit_capacity / RABBIT_SHRINK_FACTOR)
+        return;
+    size_t new_capacity = sim->rabbit_count * 2;
+    if (new_capacity < initial)
+        new_capacity = initial;
+    INSTRUMENT_COUNT(capacity_shrinks, 1);
+    resize_storage(sim, new_capacity);
 }
 
 /**
@@ -60,7 +391,7 @@ int ensure_capacity(s_simulation_instance *sim)
  * @param rng A pointer to the PCG random number generator state.
  * @return An integer representing the sex (0 or 1).
  */
-int generate_sex(pcg32_random_t *rng)
+int generate_sex(pcg32x_random_t *rng)
 {
     return (genrand_real(rng) < 0.5) ? 0 : 1;
 }
@@ -70,13 +401,12 @@ int generate_sex(pcg32_random_t *rng)
  * @param rng A pointer to the PCG random number generator state.
  * @return An integer representing the random age.
  */
-int generate_random_age(pcg32_random_t *rng){
+int generate_random_age(pcg32x_random_t *rng){
     return (int)(genrand_real(rng)*10) + 10;
 }
 
 /**
- * @brief Adds a new rabbit to the simulation instance.
- *        If there are free slots (dead rabbits), it reuses one; otherwise, it appends to the end.
+ * @brief Adds a new rabbit at the end of the simulation's rabbits array.
  * @param sim A pointer to the s_simulation_instance.
  * @param is_mature An integer indicating if the rabbit is mature (1) or not (0).
  * @param init_srv_rate The initial survival rate for the rabbit.
@@ -84,47 +414,42 @@ int generate_random_age(pcg32_random_t *rng){
  * @param sex the sex of the rabbit
  * @return void
  */
-void add_rabbit(s_simulation_instance *sim, pcg32_random_t* rng, int is_mature, float init_srv_rate, int age, int sex)
+void add_rabbit(s_simulation_instance *sim, pcg32x_random_t* rng, int is_mature, float init_srv_rate, int age, int sex)
 {
     if (!ensure_capacity(sim))
-        return;
-
-    s_rabbit *r;
-    if (sim->free_count > 0)
-    {
-        r = &sim->rabbits[sim->free_indices[--sim->free_count]];
-    }
-    else
     {
-        r = &sim->rabbits[sim->rabbit_count++];
+        sim->lost_rabbits++;
+        return;
     }
 
-    r->sex = sex;
-    r->status = 1;
-    r->age = age;
-    r->mature = is_mature;
-    r->maturity_age = 0;
-    r->pregnant = 0;
-    r->nb_litters_y = 0;
-    r->nb_litters = 0;
+    size_t r = sim->rabbit_count++;
+
+#if RABBIT_STORAGE_SOA
+    sim->columns.flags[r] = 0;
+#endif
+    RABBIT_SET_FLAG(sim, r, sex, sex);
+    RABBIT_SET_FLAG(sim, r, status, 1);
+    RABBIT_FIELD(sim, r, age) = age;
+    RABBIT_SET_FLAG(sim, r, mature, is_mature);
+    RABBIT_FIELD(sim, r, maturity_age) = 0;
+    RABBIT_SET_FLAG(sim, r, pregnant, 0);
+    RABBIT_FIELD(sim, r, nb_litters_y) = 0;
+    RABBIT_FIELD(sim, r, nb_litters) = 0;
     
-    // Use the selected survival calculation method
-    switch (survival_method)
-    {
-        case SURVIVAL_STATIC:
-            r->survival_rate = calculate_survival_rate_static(init_srv_rate);
-            break;
-        case SURVIVAL_GAUSSIAN:
-            r->survival_rate = calculate_survival_rate_gaussian(init_srv_rate, rng);
-            break;
-        case SURVIVAL_EXPONENTIAL:
-            r->survival_rate = calculate_survival_rate_exponential(init_srv_rate, rng);
-            break;
-    }
+    // Use the survival calculation method of this simulation
+#if RABBIT_STORAGE_SOA
+    if (sim->columns.survival_rate)
+#endif
+    RABBIT_FIELD(sim, r, survival_rate) = draw_survival_rate(&sim->survival, init_srv_rate, rng);
     
-    r->survival_check_flag = 0;
+    RABBIT_SET_FLAG(sim, r, survival_check_flag, 0);
 
     sim->sex_distribution[sex]++;
+
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    if (sim->ages.rows > 0 && age <= sim->ages.origin)
+        AGE_HISTOGRAM_CELL(&sim->ages, age, AGE_CLASS(sex, is_mature ? 1 : 0))++;
+    #endif
 }
 
 /**
@@ -132,10 +457,10 @@ void add_rabbit(s_simulation_instance *sim, pcg32_random_t* rng, int is_mature,
  * @param sim A pointer to the s_simulation_instance.
  * @return void
  */
-void init_2_super_rabbits(s_simulation_instance *sim, pcg32_random_t* rng)
+void init_2_super_rabbits(s_simulation_instance *sim, pcg32x_random_t* rng)
 {
-    add_rabbit(sim, rng, 1, 100, 9, 0);
-    add_rabbit(sim, rng, 1, 100, 9, 1);
+    add_rabbit(sim, rng, 1, SUPER_SRV_RATE, 9, 0);
+    add_rabbit(sim, rng, 1, SUPER_SRV_RATE, 9, 1);
 }
 
 /**
@@ -145,37 +470,155 @@ void init_2_super_rabbits(s_simulation_instance *sim, pcg32_random_t* rng)
  * @param rng A pointer to the PCG random number generator state.
  * @return void
  */
-void init_starting_population(s_simulation_instance *sim, int nb_rabbits, pcg32_random_t *rng)
+void init_starting_population(s_simulation_instance *sim, int nb_rabbits, pcg32x_random_t *rng)
 {
     for (int i = 0; i < nb_rabbits; ++i)
     {
-        add_rabbit(sim, rng, 1, ADULT_SRV_RATE, generate_random_age(rng), generate_sex(rng));
+        add_rabbit(sim, rng, 1, sim->survival.adult_rate, generate_random_age(rng), generate_sex(rng));
     }
 }
 
 /**
- * @brief Frees all dynamically allocated memory for rabbits and free_indices, resetting the simulation instance to an empty state.
+ * @brief Frees all dynamically allocated memory for rabbits, resetting the simulation instance to an empty state.
  * @param sim A pointer to the s_simulation_instance.
  * @return void
  */
 void reset_population(s_simulation_instance *sim)
 {
-    free(sim->rabbits);
-    sim->rabbits = NULL;
-    free(sim->free_indices);
-    sim->free_indices = NULL;
+    release_storage(sim);
     
     #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
     free(sim->monthly_data);
     sim->monthly_data = NULL;
+    sim->monthly_data_allocated = 0;
     sim->monthly_data_capacity = 0;
     sim->monthly_data_count = 0;
+    free_age_histogram(&sim->ages);
+    free(sim->age_rows);
+    sim->age_rows = NULL;
+    sim->age_row_count = 0;
+    sim->age_rows_allocated = 0;
     #endif
     
+    reset_cohorts(sim);
+    reset_events(sim);
+    reset_demes(sim);
+
+    free(sim->static_thresholds);
+    sim->static_thresholds = NULL;
+    sim->static_table_ages = 0;
+    sim->static_table_allocated = 0;
+
     sim->rabbit_count = 0;
     sim->free_count = 0;
     sim->dead_rabbit_count = 0;
-    sim->rabbit_capacity = 0;
+    sim->sex_distribution[0] = 0;
+    sim->sex_distribution[1] = 0;
+    sim->stats = (s_population_stats){0};
+    sim->update_kernel = NULL;
+}
+
+/**
+ * @brief Empties a simulation instance for a new run without releasing its buffers.
+ *        Only the counts are rewound; the rabbits, cohorts and monthly_data arrays keep their
+ *        capacity, so a pooled instance does not go back to the allocator between simulations.
+ *        Logging stays disabled until init_monthly_logging is called for the new run.
+ * @param sim A pointer to the s_simulation_instance.
+ * @return void
+ */
+void rewind_population(s_simulation_instance *sim)
+{
+    sim->rabbit_count = 0;
+    sim->free_count = 0;
+    sim->dead_rabbit_count = 0;
+    sim->lost_rabbits = 0;
+    sim->sex_distribution[0] = 0;
+    sim->sex_distribution[1] = 0;
+    sim->stats = (s_population_stats){0};
+    sim->update_kernel = NULL;
+
+    sim->monthly_data_capacity = 0;
+    sim->monthly_data_count = 0;
+    sim->deaths_this_month = 0;
+    sim->births_this_month = 0;
+    sim->ages.rows = 0;
+    sim->age_row_count = 0;
+
+    sim->cohort_count = 0;
+    sim->cohort_alive = 0;
+    sim->last_births = 0;
+    if (sim->demes)
+        sim->demes->count = 0;
+}
+
+/**
+ * @brief Makes sure the pool holds at least nb_instances simulation instances (one per OpenMP thread).
+ *        Instances already in the pool keep their buffers; new ones start empty.
+ * @param nb_instances The number of instances needed.
+ * @return A pointer to the first instance of the pool, or NULL if the allocation failed.
+ */
+s_simulation_instance *reserve_simulation_pool(int nb_instances)
+{
+    if (nb_instances <= simulation_pool_size)
+        return simulation_pool;
+
+    s_simulation_instance *temp = realloc(simulation_pool, sizeof(s_simulation_instance) * nb_instances);
+    if (!temp)
+        return NULL;
+    for (int t = simulation_pool_size; t < nb_instances; ++t)
+        temp[t] = (s_simulation_instance){0};
+
+    simulation_pool = temp;
+    simulation_pool_size = nb_instances;
+    return simulation_pool;
+}
+
+/**
+ * @brief Rewinds a pooled instance for a new simulation of multi_simulate, with the engine, update mode,
+ *        early stop and survival model of the run.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param initial_capacity The rabbits allocated first (see initial_rabbit_capacity).
+ * @param survival The survival model of the simulation.
+ * @return void
+ */
+void prepare_simulation_instance(s_simulation_instance *sim, size_t initial_capacity, const s_survival_params *survival)
+{
+    rewind_population(sim);
+    sim->initial_capacity = initial_capacity;
+    sim->engine = simulation_engine;
+    sim->update_threads = update_threads;
+    sim->deme_count = deme_count;
+    sim->stop_mode = stop_mode;
+    sim->survival = *survival;
+}
+
+/**
+ * @brief Frees every instance of the simulation pool and the pool itself.
+ * @return void
+ */
+void free_simulation_pool(void)
+{
+    for (int t = 0; t < simulation_pool_size; ++t)
+        reset_population(&simulation_pool[t]);
+    free(simulation_pool);
+    simulation_pool = NULL;
+    simulation_pool_size = 0;
+}
+
+/**
+ * @brief Counts the living rabbits of a simulation, whichever engine it uses.
+ * @param sim A pointer to the s_simulation_instance.
+ * @return The number of living rabbits.
+ */
+long long count_alive_rabbits(const s_simulation_instance *sim)
+{
+    if (sim->engine == ENGINE_COHORT)
+        return sim->cohort_alive;
+    if (sim->engine == ENGINE_EVENT)
+        return count_event_rabbits(sim);
+    if (has_demes(sim))
+        return (long long)sim->demes->alive;
+    return (long long)(sim->rabbit_count - sim->free_count);
 }
 
 /**
@@ -185,7 +628,7 @@ void reset_population(s_simulation_instance *sim)
  * @param rng A pointer to the PCG random number generator state.
  * @return 1 if the rabbit becomes mature, 0 otherwise.
  */
-int check_maturity(int age, pcg32_random_t *rng)
+int check_maturity(int age, pcg32x_random_t *rng)
 {
     float chance = (float)age / 8.0f;
     return (genrand_real(rng) <= chance);
@@ -199,16 +642,16 @@ int check_maturity(int age, pcg32_random_t *rng)
  * @param rng A pointer to the PCG random number generator state.
  * @return void
  */
-void update_maturity(s_simulation_instance *sim, size_t i, pcg32_random_t *rng)
+void update_maturity(s_simulation_instance *sim, size_t i, pcg32x_random_t *rng)
 {
-    if (sim->rabbits[i].mature)
+    if (RABBIT_FLAG(sim, i, mature))
         return;
-    if (sim->rabbits[i].age >= 5)
+    if (RABBIT_FIELD(sim, i, age) >= 5)
     {
-        if (check_maturity(sim->rabbits[i].age, rng))
+        if (check_maturity(RABBIT_FIELD(sim, i, age), rng))
         {
-            sim->rabbits[i].mature = 1;
-            sim->rabbits[i].maturity_age = sim->rabbits[i].age;
+            RABBIT_SET_FLAG(sim, i, mature, 1);
+            RABBIT_FIELD(sim, i, maturity_age) = RABBIT_FIELD(sim, i, age);
         }
     }
 }
@@ -221,22 +664,23 @@ void update_maturity(s_simulation_instance *sim, size_t i, pcg32_random_t *rng)
  * @param rng A pointer to the PCG random number generator state.
  * @return 1 if the rabbit survives, 0 otherwise.
  */
-int check_survival_rate(s_simulation_instance *sim, size_t i, pcg32_random_t *rng)
+int check_survival_rate(s_simulation_instance *sim, size_t i, pcg32x_random_t *rng)
 {
-    return sim->rabbits[i].survival_check_flag ? 1 : (genrand_real(rng) * 100.0 <= sim->rabbits[i].survival_rate);
+    return RABBIT_FLAG(sim, i, survival_check_flag) ? 1 : (genrand_real(rng) * 100.0 <= RABBIT_FIELD(sim, i, survival_rate));
 }
 
 /**
- * @brief Sets a rabbit's status to dead and adds its index to the list of free indices.
+ * @brief Sets a rabbit's status to dead. Its slot is reclaimed by the compaction at the end of update_rabbits.
  * @param sim A pointer to the s_simulation_instance.
  * @param i The index of the rabbit to kill.
  * @return void
  */
 void kill_rabbit(s_simulation_instance *sim, size_t i)
 {
-    sim->rabbits[i].status = 0;
-    sim->free_indices[sim->free_count++] = i;
+    RABBIT_SET_FLAG(sim, i, status, 0);
+    sim->free_count++;
     sim->dead_rabbit_count++;
+    sim->sex_distribution[RABBIT_FLAG(sim, i, sex)]--;
     
     #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
     sim->deaths_this_month++;
@@ -251,9 +695,9 @@ void kill_rabbit(s_simulation_instance *sim, size_t i)
  * @param rng A pointer to the PCG random number generator state.
  * @return void
  */
-void check_survival(s_simulation_instance *sim, size_t i, pcg32_random_t *rng)
+void check_survival(s_simulation_instance *sim, size_t i, pcg32x_random_t *rng)
 {
-    if (sim->rabbits[i].status == 1)
+    if (RABBIT_FLAG(sim, i, status) == 1)
     {
         if (!check_survival_rate(sim, i, rng))
         {
@@ -261,7 +705,7 @@ void check_survival(s_simulation_instance *sim, size_t i, pcg32_random_t *rng)
         }
         else
         {
-            sim->rabbits[i].survival_check_flag = 1;
+            RABBIT_SET_FLAG(sim, i, survival_check_flag, 1);
         }
     }
 }
@@ -273,71 +717,132 @@ void check_survival(s_simulation_instance *sim, size_t i, pcg32_random_t *rng)
  * @return The base survival rate.
  */
 float calculate_base_survival_rate(s_simulation_instance *sim, size_t i)
+{
+    return calculate_base_survival_rate_for(&sim->survival, RABBIT_FLAG(sim, i, mature), RABBIT_FIELD(sim, i, age));
+}
+
+/**
+ * @brief Returns the default survival model: static method, INIT_SRV_RATE/ADULT_SRV_RATE and the default
+ *        Gaussian, exponential and old age penalty parameters.
+ * @return The default survival parameters.
+ */
+s_survival_params default_survival_params(void)
+{
+    s_survival_params params;
+    params.method = SURVIVAL_STATIC;
+    params.init_rate = INIT_SRV_RATE;
+    params.adult_rate = ADULT_SRV_RATE;
+    params.gaussian_sigma = GAUSSIAN_SRV_SIGMA;
+    params.exponential_scale = EXPONENTIAL_SRV_SCALE;
+    params.exponential_spread = EXPONENTIAL_SRV_SPREAD;
+    params.penalty_age = SRV_PENALTY_AGE;
+    params.penalty_per_year = SRV_PENALTY_PER_YEAR;
+    return params;
+}
+
+/**
+ * @brief Calculates the base survival rate for a given maturity status and age.
+ * @param params The survival parameters of the simulation.
+ * @param mature 1 if the rabbit is mature, 0 otherwise.
+ * @param age The age of the rabbit in months.
+ * @return The base survival rate.
+ */
+float calculate_base_survival_rate_for(const s_survival_params *params, int mature, int age)
 {
     float base_rate;
     
-    if (!sim->rabbits[i].mature) {
+    if (!mature) {
         // Young rabbits use initial survival rate
-        base_rate = INIT_SRV_RATE;
+        base_rate = params->init_rate;
     } else {
         // Mature rabbits use adult survival rate
-        base_rate = ADULT_SRV_RATE;
+        base_rate = params->adult_rate;
     }
     
-    // Apply age penalty for very old rabbits (120 months and older)
-    if (sim->rabbits[i].age >= 120) {
-        base_rate -= 10 * ((sim->rabbits[i].age - 120) / 12);
+    // Apply age penalty for very old rabbits (penalty_age months and older)
+    if (age >= params->penalty_age) {
+        base_rate -= params->penalty_per_year * (float)((age - params->penalty_age) / 12);
         if (base_rate < 0.0f) base_rate = 0.0f;
     }
     
     return base_rate;
 }
 
+// Last 1 / lambda computed by an update loop of the exponential method, with the base rate it belongs to
+typedef struct {
+    float base_rate;
+    double inverse_lambda;
+} s_lambda_cache;
+
 /**
- * @brief Updates the survival rate of a rabbit based on its age and maturity.
- *        Resets the survival check flag monthly.
- *        Applies age-based penalties and uses the selected survival calculation method.
+ * @brief Updates the survival rate of a rabbit with a given survival method.
+ *        Inlined with a constant method by the specialised update loops, so the switch disappears from them.
  * @param sim A pointer to the s_simulation_instance.
  * @param i The index of the rabbit to update.
  * @param rng A pointer to the PCG random number generator state.
+ * @param method The survival method of the simulation.
+ * @param cache The lambda of the previous rabbit (exponential method), updated when the base rate changes.
  * @return void
  */
-void update_survival_rate(s_simulation_instance *sim, size_t i, pcg32_random_t *rng)
+static RABBIT_ALWAYS_INLINE void update_survival_rate_with(s_simulation_instance *sim, size_t i, pcg32x_random_t *rng,
+                                                       survival_method_t method, s_lambda_cache *cache)
 {
     // monthly 
-    sim->rabbits[i].survival_check_flag = 0;
+    RABBIT_SET_FLAG(sim, i, survival_check_flag, 0);
 
     // Calculate base survival rate based on age and maturity
     float base_rate = calculate_base_survival_rate(sim, i);
     
-    // Apply the selected survival calculation method
-    switch (survival_method)
+    // Apply the survival calculation method
+    switch (method)
     {
         case SURVIVAL_STATIC:
             // For static method, only update when becoming mature or yearly for old age penalty
-            if (sim->rabbits[i].mature && sim->rabbits[i].age == sim->rabbits[i].maturity_age)
+            if (RABBIT_FLAG(sim, i, mature) && RABBIT_FIELD(sim, i, age) == RABBIT_FIELD(sim, i, maturity_age))
             {
-                sim->rabbits[i].survival_rate = calculate_survival_rate_static(base_rate);
+                RABBIT_FIELD(sim, i, survival_rate) = calculate_survival_rate_static(base_rate);
             }
-            else if (sim->rabbits[i].age % 12 == 0 && sim->rabbits[i].age >= 120)
+            else if (RABBIT_FIELD(sim, i, age) >= sim->survival.penalty_age &&
+                     (RABBIT_FIELD(sim, i, age) - sim->survival.penalty_age) % 12 == 0)
             {
                 // Apply age penalty for very old rabbits
-                sim->rabbits[i].survival_rate = calculate_survival_rate_static(base_rate);
+                RABBIT_FIELD(sim, i, survival_rate) = calculate_survival_rate_static(base_rate);
             }
             break;
             
         case SURVIVAL_GAUSSIAN:
             // Apply Gaussian variation every month
-            sim->rabbits[i].survival_rate = calculate_survival_rate_gaussian(base_rate, rng);
+            RABBIT_FIELD(sim, i, survival_rate) = calculate_survival_rate_gaussian(&sim->survival, base_rate, rng);
             break;
             
         case SURVIVAL_EXPONENTIAL:
             // Apply exponential variation every month
-            sim->rabbits[i].survival_rate = calculate_survival_rate_exponential(base_rate, rng);
+            if (base_rate != cache->base_rate)
+            {
+                cache->base_rate = base_rate;
+                cache->inverse_lambda = exponential_inverse_lambda(&sim->survival, base_rate);
+            }
+            RABBIT_FIELD(sim, i, survival_rate) =
+                calculate_survival_rate_exponential_with(&sim->survival, base_rate, cache->inverse_lambda, rng);
             break;
     }
 }
 
+/**
+ * @brief Updates the survival rate of a rabbit based on its age and maturity.
+ *        Resets the survival check flag monthly.
+ *        Applies age-based penalties and uses the survival calculation method of the simulation.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param i The index of the rabbit to update.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return void
+ */
+void update_survival_rate(s_simulation_instance *sim, size_t i, pcg32x_random_t *rng)
+{
+    s_lambda_cache cache = { -1.0f, 0.0 };
+    update_survival_rate_with(sim, i, rng, sim->survival.method, &cache);
+}
+
 /**
  * @brief Calculates survival rate using static (constant) method.
  * @param base_rate The base survival rate.
@@ -354,15 +859,13 @@ float calculate_survival_rate_static(float base_rate)
  * @param rng A pointer to the PCG random number generator state.
  * @return The calculated survival rate following a normal distribution.
  */
-float calculate_survival_rate_gaussian(float base_rate, pcg32_random_t *rng)
+float calculate_survival_rate_gaussian(const s_survival_params *params, float base_rate, pcg32x_random_t *rng)
 {
-    // Box-Muller transform for Gaussian distribution
-    double u1 = genrand_real(rng);
-    double u2 = genrand_real(rng);
-    double z0 = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+    // Ziggurat normal variate, no libm call on the fast path (see variates.h)
+    double z0 = genrand_normal(rng);
     
-    // Use base_rate as mean, and 2.5 as standard deviation (reduced from 5.0 for better stability)
-    float result = (float)(base_rate + 2.5 * z0);
+    // Use base_rate as mean, and gaussian_sigma as standard deviation (2.5 by default, reduced from 5.0 for better stability)
+    float result = (float)(base_rate + params->gaussian_sigma * z0);
     
     // Clamp to reasonable bounds (0-100)
     if (result < 0.0f) result = 0.0f;
@@ -377,20 +880,42 @@ float calculate_survival_rate_gaussian(float base_rate, pcg32_random_t *rng)
  * @param rng A pointer to the PCG random number generator state.
  * @return The calculated survival rate following an exponential distribution.
  */
-float calculate_survival_rate_exponential(float base_rate, pcg32_random_t *rng)
+float calculate_survival_rate_exponential(const s_survival_params *params, float base_rate, pcg32x_random_t *rng)
+{
+    return calculate_survival_rate_exponential_with(params, base_rate, exponential_inverse_lambda(params, base_rate), rng);
+}
+
+/**
+ * @brief Computes 1 / lambda of the exponential method for a base rate, the only logarithm of the method.
+ * @param params The survival parameters of the simulation.
+ * @param base_rate The base survival rate.
+ * @return The mean of the exponential factor.
+ */
+double exponential_inverse_lambda(const s_survival_params *params, float base_rate)
 {
-    // Use exponential distribution centered around base_rate
     // Scale base_rate to (0, 1) range for lambda calculation
     double normalized_rate = base_rate / 100.0;
     
     // lambda determines the decay rate: higher base_rate = higher lambda = more survival concentration
-    double lambda = -log(1.0 - normalized_rate) / 2.0;  // Scale factor of 2 for variance control
-    
-    double u = genrand_real(rng);
-    double random_factor = -log(u) / lambda;  // Exponential random variable
+    return params->exponential_scale / -log(1.0 - normalized_rate);  // Scale factor (2 by default) for variance control
+}
+
+/**
+ * @brief Calculates survival rate using exponential distribution, with 1 / lambda already computed
+ *        (base rates repeat from one rabbit to the next, so the update loops reuse it).
+ * @param params The survival parameters of the simulation.
+ * @param base_rate The base survival rate.
+ * @param inverse_lambda exponential_inverse_lambda(params, base_rate).
+ * @param rng A pointer to the PCG random number generator state.
+ * @return The calculated survival rate following an exponential distribution.
+ */
+float calculate_survival_rate_exponential_with(const s_survival_params *params, float base_rate, double inverse_lambda,
+                                               pcg32x_random_t *rng)
+{
+    double random_factor = genrand_exponential(rng) * inverse_lambda;  // Exponential random variable, ziggurat sampled
     
     // Result is base_rate modulated by exponential factor
-    double result = base_rate * (1.0 + 0.3 * (random_factor - 1.0));  // Keep variation within ~30%
+    double result = base_rate * (1.0 + params->exponential_spread * (random_factor - 1.0));  // Keep variation within ~30% by default
     
     // Clamp to valid percentage range
     if (result < 0.0) result = 0.0;
@@ -400,29 +925,174 @@ float calculate_survival_rate_exponential(float base_rate, pcg32_random_t *rng)
 }
 
 /**
- * @brief Randomly determines the number of litters a female rabbit can have in a year based on predefined probabilities.
+ * @brief Draws a survival rate around base_rate with the survival calculation method of params.
+ * @param params The survival parameters of the simulation.
+ * @param base_rate The base survival rate.
  * @param rng A pointer to the PCG random number generator state.
- * @return An integer representing the number of litters per year.
+ * @return The survival rate.
  */
-int generate_litters_per_year(pcg32_random_t *rng)
+float draw_survival_rate(const s_survival_params *params, float base_rate, pcg32x_random_t *rng)
 {
-    double rand_val = genrand_real(rng);
-    if (rand_val < 0.05)
-        return 3;
-    if (rand_val < 0.15)
-        return 4;
-    if (rand_val < 0.40)
-        return 5;
-    if (rand_val < 0.70)
-        return 6;
-    if (rand_val < 0.90)
-        return 7;
-    if (rand_val < 0.97)
-        return 8;
-    return 9;
-}
-
-/**
+    switch (params->method)
+    {
+        case SURVIVAL_GAUSSIAN:
+            return calculate_survival_rate_gaussian(params, base_rate, rng);
+        case SURVIVAL_EXPONENTIAL:
+            return calculate_survival_rate_exponential(params, base_rate, rng);
+        case SURVIVAL_STATIC:
+        default:
+            return calculate_survival_rate_static(base_rate);
+    }
+}
+
+/**
+ * @brief Survival rate held by a rabbit under the static method after its update at a given age.
+ *        The rate set at creation is kept until penalty_age, then it is refreshed every year with the
+ *        old age penalty (every rabbit is mature by then, see SRV_PENALTY_MIN_AGE).
+ * @param params The survival parameters of the simulation.
+ * @param creation_rate The rate given to the rabbit by add_rabbit (init_rate or the founder rate).
+ * @param age The age of the rabbit in months.
+ * @return The survival rate used at the check of age + 1.
+ */
+float static_survival_rate(const s_survival_params *params, float creation_rate, int age)
+{
+    if (age < params->penalty_age)
+        return creation_rate;
+    return calculate_survival_rate_static(calculate_base_survival_rate_for(params, 1, age));
+}
+
+/**
+ * @brief Converts a survival rate into the largest raw generator output that survives.
+ *        pcg32x_random_r(rng) <= survival_threshold(rate) gives exactly the same result as
+ *        genrand_real(rng) * 100.0 <= rate, found by a binary search over the same expression.
+ * @param rate The survival rate (at least 0).
+ * @return The survival threshold.
+ */
+uint32_t survival_threshold(float rate)
+{
+    uint32_t low = 0;
+    uint32_t high = UINT32_MAX;
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2 + 1;
+        if ((double)mid * (1.0 / (double)UINT32_MAX) * 100.0 <= rate)
+            low = mid;
+        else
+            high = mid - 1;
+    }
+    return low;
+}
+
+/**
+ * @brief Precomputes the survival thresholds of the static method for one simulation.
+ *        Under the static method the rate of a rabbit only depends on its age and on whether it was
+ *        born in the simulation (init_rate) or belongs to the initial population (founder_rate), so the
+ *        update loop compares the raw generator output with a table entry instead of storing a rate per rabbit.
+ *        Entry a of a row is the threshold checked when the rabbit turns a, i.e. the rate after its update at a - 1.
+ *        The rows stop once the rate cannot change any more (0, 100 or no penalty).
+ *        A pooled instance keeps the table of its previous run when the survival model is the same.
+ * @param sim A pointer to the s_simulation_instance (its buffer is kept between runs).
+ * @param founder_rate The survival rate given to the initial population.
+ * @return 1 on success, 0 if the allocation failed.
+ */
+int build_static_survival_table(s_simulation_instance *sim, float founder_rate)
+{
+    const s_survival_params *params = &sim->survival;
+    const s_survival_params *built = &sim->static_table_params;
+    if (sim->static_table_ages > 0 && sim->static_table_founder_rate == founder_rate &&
+        built->init_rate == params->init_rate && built->adult_rate == params->adult_rate &&
+        built->penalty_age == params->penalty_age && built->penalty_per_year == params->penalty_per_year)
+        return 1;
+    int penalty_age = params->penalty_age;
+    if (penalty_age < 1)
+        penalty_age = 1;
+
+    // Last age at which the rate changes
+    int last_change = penalty_age;
+    if (params->penalty_per_year != 0.0f)
+    {
+        uint32_t threshold = survival_threshold(static_survival_rate(params, founder_rate, last_change));
+        while (threshold != 0 && threshold != UINT32_MAX && last_change + 12 < UINT16_MAX)
+        {
+            last_change += 12;
+            threshold = survival_threshold(static_survival_rate(params, founder_rate, last_change));
+        }
+    }
+
+    size_t ages = (size_t)last_change + 2;
+    if (sim->static_table_allocated < 2 * ages)
+    {
+        uint32_t *temp = realloc(sim->static_thresholds, sizeof(uint32_t) * 2 * ages);
+        if (!temp)
+            return 0;
+        sim->static_thresholds = temp;
+        sim->static_table_allocated = 2 * ages;
+    }
+
+    uint32_t *born = sim->static_thresholds;
+    uint32_t *founders = sim->static_thresholds + ages;
+    born[0] = survival_threshold(params->init_rate);
+    founders[0] = survival_threshold(founder_rate);
+    for (size_t a = 1; a < ages; ++a)
+    {
+        born[a] = survival_threshold(static_survival_rate(params, params->init_rate, (int)a - 1));
+        founders[a] = survival_threshold(static_survival_rate(params, founder_rate, (int)a - 1));
+    }
+    sim->static_table_ages = ages;
+    sim->static_table_params = *params;
+    sim->static_table_founder_rate = founder_rate;
+    sim->founder_rate = founder_rate;
+    return 1;
+}
+
+/**
+ * @brief Static method version of check_survival, comparing the raw generator output with the threshold table.
+ *        Rabbits of the initial population are the only mature ones with a maturity age of 0.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param i The index of the rabbit to check.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return void
+ */
+static RABBIT_ALWAYS_INLINE void check_survival_static(s_simulation_instance *sim, size_t i, pcg32x_random_t *rng)
+{
+    if (RABBIT_FLAG(sim, i, status) != 1 || RABBIT_FLAG(sim, i, survival_check_flag))
+        return;
+
+    size_t age = RABBIT_FIELD(sim, i, age);
+    if (age >= sim->static_table_ages)
+        age = sim->static_table_ages - 1;
+    size_t founder = RABBIT_FLAG(sim, i, mature) && RABBIT_FIELD(sim, i, maturity_age) == 0;
+
+    if (pcg32x_random_r(rng) <= sim->static_thresholds[founder * sim->static_table_ages + age])
+        RABBIT_SET_FLAG(sim, i, survival_check_flag, 1);
+    else
+        kill_rabbit(sim, i);
+}
+
+/**
+ * @brief Randomly determines the number of litters a female rabbit can have in a year based on predefined probabilities.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return An integer representing the number of litters per year.
+ */
+int generate_litters_per_year(pcg32x_random_t *rng)
+{
+    double rand_val = genrand_real(rng);
+    if (rand_val < 0.05)
+        return 3;
+    if (rand_val < 0.15)
+        return 4;
+    if (rand_val < 0.40)
+        return 5;
+    if (rand_val < 0.70)
+        return 6;
+    if (rand_val < 0.90)
+        return 7;
+    if (rand_val < 0.97)
+        return 8;
+    return 9;
+}
+
+/**
  * @brief Updates the number of litters a female rabbit can have per year.
  *        This occurs annually for mature female rabbits after their maturity age.
  * @param sim A pointer to the s_simulation_instance.
@@ -430,11 +1100,11 @@ int generate_litters_per_year(pcg32_random_t *rng)
  * @param rng A pointer to the PCG random number generator state.
  * @return void
  */
-void update_litters_per_year(s_simulation_instance *sim, size_t i, pcg32_random_t *rng)
+void update_litters_per_year(s_simulation_instance *sim, size_t i, pcg32x_random_t *rng)
 {
-    if (sim->rabbits[i].sex == 1 && sim->rabbits[i].mature && (sim->rabbits[i].age - sim->rabbits[i].maturity_age) % 12 == 0)
+    if (RABBIT_FLAG(sim, i, sex) == 1 && RABBIT_FLAG(sim, i, mature) && (RABBIT_FIELD(sim, i, age) - RABBIT_FIELD(sim, i, maturity_age)) % 12 == 0)
     {
-        sim->rabbits[i].nb_litters_y = generate_litters_per_year(rng);
+        RABBIT_FIELD(sim, i, nb_litters_y) = generate_litters_per_year(rng);
     }
 }
 
@@ -445,10 +1115,10 @@ void update_litters_per_year(s_simulation_instance *sim, size_t i, pcg32_random_
  * @param rng A pointer to the PCG random number generator state.
  * @return 1 if the rabbit can become pregnant, 0 otherwise.
  */
-int can_be_pregnant_this_month(s_simulation_instance *sim, size_t i, pcg32_random_t *rng)
+int can_be_pregnant_this_month(s_simulation_instance *sim, size_t i, pcg32x_random_t *rng)
 {
-    int remaining_months = 12 - (sim->rabbits[i].age - sim->rabbits[i].maturity_age) % 12;
-    int remaining_litters = sim->rabbits[i].nb_litters_y - sim->rabbits[i].nb_litters;
+    int remaining_months = 12 - (RABBIT_FIELD(sim, i, age) - RABBIT_FIELD(sim, i, maturity_age)) % 12;
+    int remaining_litters = RABBIT_FIELD(sim, i, nb_litters_y) - RABBIT_FIELD(sim, i, nb_litters);
     if (remaining_litters <= 0)
         return 0;
     float base_prob = (float)remaining_litters / remaining_months;
@@ -464,14 +1134,14 @@ int can_be_pregnant_this_month(s_simulation_instance *sim, size_t i, pcg32_rando
  * @param rng A pointer to the PCG random number generator state.
  * @return The number of new born rabbits, or 0 if the rabbit is not pregnant.
  */
-int give_birth(s_simulation_instance *sim, size_t i, pcg32_random_t *rng)
+int give_birth(s_simulation_instance *sim, size_t i, pcg32x_random_t *rng)
 {
-    if (sim->rabbits[i].pregnant)
+    if (RABBIT_FLAG(sim, i, pregnant))
     {
-        sim->rabbits[i].pregnant = 0;
-        sim->rabbits[i].nb_litters += 1;
+        RABBIT_SET_FLAG(sim, i, pregnant, 0);
+        RABBIT_FIELD(sim, i, nb_litters) += 1;
         // Generate a number from 0 to 3
-        uint32_t extra_kittens = pcg32_boundedrand_r(rng, 4);
+        uint32_t extra_kittens = pcg32x_boundedrand_r(rng, 4);
         return 3 + extra_kittens; // Returns 3, 4, 5, or 6
     }
     return 0;
@@ -484,64 +1154,491 @@ int give_birth(s_simulation_instance *sim, size_t i, pcg32_random_t *rng)
  * @param rng A pointer to the PCG random number generator state.
  * @return void
  */
-void check_pregnancy(s_simulation_instance *sim, size_t i, pcg32_random_t *rng)
+void check_pregnancy(s_simulation_instance *sim, size_t i, pcg32x_random_t *rng)
 {
-    if (sim->rabbits[i].sex == 1 && can_be_pregnant_this_month(sim, i, rng))
+    if (RABBIT_FLAG(sim, i, sex) == 1 && can_be_pregnant_this_month(sim, i, rng))
     {
-        sim->rabbits[i].pregnant = 1;
+        RABBIT_SET_FLAG(sim, i, pregnant, 1);
     }
 }
 
 /**
  * @brief Adds a specified number of new born rabbits to the simulation.
  *        New born rabbits are immature with an initial survival rate and age 0.
+ *        They are written in one sweep at the end of the array after a single capacity check, each raw
+ *        generator output giving the sexes of 32 of them (one bit each, same 1/2 chance as generate_sex),
+ *        and the sex counts and statistics are updated once for the whole litter.
+ *        If the storage cannot grow enough, only the rabbits that fit are added.
  * @param sim A pointer to the s_simulation_instance.
  * @param nb_new_born The number of new rabbits to create.
  * @param rng A pointer to the PCG random number generator state.
  * @return void
  */
-void create_new_generation(s_simulation_instance *sim, int nb_new_born, pcg32_random_t *rng)
+void create_new_generation(s_simulation_instance *sim, int nb_new_born, pcg32x_random_t *rng)
 {
     #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
     sim->births_this_month += nb_new_born;
     #endif
-    
-    for (int j = 0; j < nb_new_born; ++j)
+    sim->last_births = nb_new_born;
+    if (nb_new_born <= 0)
+        return;
+
+    size_t first = sim->rabbit_count;
+    size_t count = (size_t)nb_new_born;
+    if (!ensure_room(sim, first + count))
+    {
+        // The newborns that do not fit are lost, simulate stops the run after this update
+        count = (sim->rabbit_capacity > first) ? sim->rabbit_capacity - first : 0;
+        sim->lost_rabbits += nb_new_born - (long long)count;
+    }
+    if (count == 0)
+        return;
+
+    const s_survival_params *params = &sim->survival;
+    int drawn_rates = (params->method != SURVIVAL_STATIC);
+    float static_rate = calculate_survival_rate_static(params->init_rate);
+    size_t males = 0;
+    uint32_t sex_bits = 0;
+
+#if RABBIT_STORAGE_SOA
+    memset(&sim->columns.age[first], 0, sizeof(uint16_t) * count);
+    memset(&sim->columns.maturity_age[first], 0, sizeof(uint16_t) * count);
+    memset(&sim->columns.nb_litters_y[first], 0, count);
+    memset(&sim->columns.nb_litters[first], 0, count);
+    (void)static_rate;
+#endif
+    for (size_t j = 0; j < count; ++j)
+    {
+        if ((j & 31) == 0)
+            sex_bits = pcg32x_random_r(rng);
+        unsigned sex = sex_bits & 1u;
+        sex_bits >>= 1;
+        males += sex;
+
+        size_t r = first + j;
+#if RABBIT_STORAGE_SOA
+        sim->columns.flags[r] = (uint8_t)(sex << RABBIT_BIT_sex | 1u << RABBIT_BIT_status);
+        if (drawn_rates && sim->columns.survival_rate)
+            sim->columns.survival_rate[r] = draw_survival_rate(params, params->init_rate, rng);
+#else
+        sim->rabbits[r] = (s_rabbit){0};
+        sim->rabbits[r].sex = (int)sex;
+        sim->rabbits[r].status = 1;
+        sim->rabbits[r].survival_rate = drawn_rates ? draw_survival_rate(params, params->init_rate, rng) : static_rate;
+#endif
+    }
+    sim->rabbit_count = first + count;
+    sim->sex_distribution[1] += (int)males;
+    sim->sex_distribution[0] += (int)(count - males);
+
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    if (sim->ages.rows > 0)
     {
-        add_rabbit(sim, rng, 0, INIT_SRV_RATE, 0, generate_sex(rng));
+        AGE_HISTOGRAM_CELL(&sim->ages, 0, AGE_CLASS(0, 0)) += (long long)(count - males);
+        AGE_HISTOGRAM_CELL(&sim->ages, 0, AGE_CLASS(1, 0)) += (long long)males;
     }
+    #endif
 }
 
 /**
- * @brief Iterates through all rabbits in the simulation and updates their states for one month.
+ * @brief Updates every rabbit of the simulation's array for one month, without creating the new generation.
  *        This includes aging, checking survival, updating survival rates, checking maturity, handling births, and checking for new pregnancies.
- *        Finally, it creates new rabbits born this month.
- * @param sim A pointer to the s_simulation_instance.
+ *        The same pass compacts the array: every rabbit is copied down to the next live slot and the slot is only
+ *        kept if it survived, so living rabbits stay packed at the front without any free-slot bookkeeping.
+ *        With collect_stats it also keeps the age histogram up to date (deaths and maturities, the ageing
+ *        itself is done by advance_age_histogram) and counts the pregnant females, so the monthly
+ *        statistics cost no extra pass over the array.
+ *        Called with constant arguments by the specialised loops below.
+ * @param sim A pointer to the s_simulation_instance (or to a chunk view of it, see update_rabbits_chunked).
  * @param rng A pointer to the PCG random number generator state.
- * @return void
+ * @param method The survival method of the simulation.
+ * @param collect_stats 1 if the statistics of the monthly logs are needed, with sim->ages started
+ *                      (ignored without ENABLE_DATA_LOGGING).
+ * @return The number of rabbits born this month.
  */
-void update_rabbits(s_simulation_instance *sim, pcg32_random_t *rng)
+static RABBIT_ALWAYS_INLINE int update_rabbit_range_with(s_simulation_instance *sim, pcg32x_random_t *rng,
+                                                         survival_method_t method, int collect_stats)
 {
     int nb_new_born = 0;
-    
+    size_t alive = 0;
+    s_lambda_cache lambda_cache = { -1.0f, 0.0 };
+
     #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
-    sim->deaths_this_month = 0;
-    sim->births_this_month = 0;
+    s_age_histogram *ages = &sim->ages;
+    int pregnant_females = 0;
     #endif
-    
+
     for (size_t i = 0; i < sim->rabbit_count; ++i)
     {
-        if (sim->rabbits[i].status == 0)
-            continue;
-        sim->rabbits[i].age += 1;
-        check_survival(sim, i, rng);
-        update_survival_rate(sim, i, rng);
+        #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+        int class_before = collect_stats ? AGE_CLASS(RABBIT_FLAG(sim, i, sex), RABBIT_FLAG(sim, i, mature)) : 0;
+        #endif
+        RABBIT_FIELD(sim, i, age) += 1;
+        if (method == SURVIVAL_STATIC)
+        {
+            // The rate itself lives in the threshold table, only the monthly flag is reset
+            check_survival_static(sim, i, rng);
+            RABBIT_SET_FLAG(sim, i, survival_check_flag, 0);
+        }
+        else
+        {
+            check_survival(sim, i, rng);
+            update_survival_rate_with(sim, i, rng, method, &lambda_cache);
+        }
         update_maturity(sim, i, rng);
         update_litters_per_year(sim, i, rng);
         nb_new_born += give_birth(sim, i, rng);
         check_pregnancy(sim, i, rng);
+
+        // Branch-free compaction: a dead rabbit is overwritten by the next one
+        if (method == SURVIVAL_STATIC)
+            RABBIT_MOVE_NO_RATE(sim, alive, i);
+        else
+            RABBIT_MOVE(sim, alive, i);
+        int live = RABBIT_FLAG(sim, alive, status);
+
+        #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+        // Statistics of the survivors, as record_monthly_stats will see them next month:
+        // a death leaves the class of the rabbit, a maturity moves it to the mature class of its age
+        if (collect_stats)
+        {
+            int class_now = AGE_CLASS(RABBIT_FLAG(sim, alive, sex), RABBIT_FLAG(sim, alive, mature));
+            if (!live || class_now != class_before)
+            {
+                int age = RABBIT_FIELD(sim, alive, age);
+                AGE_HISTOGRAM_CELL(ages, age, class_before)--;
+                AGE_HISTOGRAM_CELL(ages, age, class_now) += live;
+            }
+            pregnant_females += live & RABBIT_FLAG(sim, alive, pregnant);
+        }
+        #endif
+
+        alive += live;
+    }
+    sim->rabbit_count = alive;
+    sim->free_count = 0;
+
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    if (collect_stats)
+        sim->stats.pregnant_females = pregnant_females;
+    #else
+    (void)collect_stats;
+    #endif
+    return nb_new_born;
+}
+
+// Update loops specialised for each survival method, with and without the statistics of the monthly logs,
+// so that none of them dispatches per rabbit. The storage layout (AoS or SoA) is chosen at build time.
+#define DEFINE_UPDATE_KERNEL(name, method, collect_stats) \
+    static int name(s_simulation_instance *sim, pcg32x_random_t *rng) \
+    { \
+        return update_rabbit_range_with(sim, rng, method, collect_stats); \
+    }
+
+DEFINE_UPDATE_KERNEL(update_rabbit_range_static, SURVIVAL_STATIC, 0)
+DEFINE_UPDATE_KERNEL(update_rabbit_range_gaussian, SURVIVAL_GAUSSIAN, 0)
+DEFINE_UPDATE_KERNEL(update_rabbit_range_exponential, SURVIVAL_EXPONENTIAL, 0)
+DEFINE_UPDATE_KERNEL(update_rabbit_range_static_logged, SURVIVAL_STATIC, 1)
+DEFINE_UPDATE_KERNEL(update_rabbit_range_gaussian_logged, SURVIVAL_GAUSSIAN, 1)
+DEFINE_UPDATE_KERNEL(update_rabbit_range_exponential_logged, SURVIVAL_EXPONENTIAL, 1)
+
+// Indexed by [collect_stats][survival method]
+static const rabbit_update_kernel_t update_kernels[2][3] = {
+    { update_rabbit_range_static, update_rabbit_range_gaussian, update_rabbit_range_exponential },
+    { update_rabbit_range_static_logged, update_rabbit_range_gaussian_logged, update_rabbit_range_exponential_logged }
+};
+
+/**
+ * @brief Chooses the update loop of a simulation from its survival method and whether it keeps an age histogram
+ *        (the logged runs, see simulate). Most simulations of a run are not logged and skip the statistics
+ *        of the survivors.
+ * @param sim A pointer to the s_simulation_instance.
+ * @return void
+ */
+void select_update_kernel(s_simulation_instance *sim)
+{
+    int method = sim->survival.method;
+    if (method < SURVIVAL_STATIC || method > SURVIVAL_EXPONENTIAL)
+        method = SURVIVAL_STATIC;
+    sim->update_kernel = update_kernels[sim->ages.rows > 0][method];
+}
+
+/**
+ * @brief Updates every rabbit of the simulation's array for one month, without creating the new generation,
+ *        using the update loop chosen for the simulation (see select_update_kernel).
+ * @param sim A pointer to the s_simulation_instance (or to a chunk view of it, see update_rabbits_chunked).
+ * @param rng A pointer to the PCG random number generator state.
+ * @return The number of rabbits born this month.
+ */
+int update_rabbit_range(s_simulation_instance *sim, pcg32x_random_t *rng)
+{
+    if (!sim->update_kernel)
+        select_update_kernel(sim);
+    return sim->update_kernel(sim, rng);
+}
+
+/**
+ * @brief Iterates through all rabbits in the simulation and updates their states for one month.
+ *        Updates the demes of a split simulation (see deme.h), or uses the chunked two-phase update
+ *        when the simulation has update_threads set.
+ *        Finally, it creates new rabbits born this month at the end of the array.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return void
+ */
+void update_rabbits(s_simulation_instance *sim, pcg32x_random_t *rng)
+{
+    if (has_demes(sim))
+    {
+        update_demes(sim);
+        return;
+    }
+    if (sim->update_threads > 0)
+    {
+        update_rabbits_chunked(sim, rng);
+        return;
+    }
+
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    sim->deaths_this_month = 0;
+    sim->births_this_month = 0;
+    if (sim->ages.rows > 0)
+        advance_age_histogram(&sim->ages);
+    #endif
+    
+    INSTRUMENT_PHASE_START(update_start);
+    #if defined(ENABLE_INSTRUMENTATION) && ENABLE_INSTRUMENTATION != 0
+    size_t dead_before = sim->dead_rabbit_count;
+    #endif
+    int nb_new_born = update_rabbit_range(sim, rng);
+    INSTRUMENT_MAX(max_free_slots, sim->dead_rabbit_count - dead_before);
+    INSTRUMENT_PHASE_END(PHASE_UPDATE, update_start);
+
+    INSTRUMENT_PHASE_START(shrink_start);
+    shrink_capacity(sim);
+    INSTRUMENT_PHASE_END(PHASE_SHRINK, shrink_start);
+
+    INSTRUMENT_PHASE_START(births_start);
+    create_new_generation(sim, nb_new_born, rng);
+    INSTRUMENT_PHASE_END(PHASE_BIRTHS, births_start);
+}
+
+/**
+ * @brief Creates a view of a range of the rabbits array, usable by the per-rabbit functions
+ *        with its own counters so that several chunks can be updated at the same time.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param start The index of the first rabbit of the chunk.
+ * @param count The number of rabbits in the chunk.
+ * @return The chunk view.
+ */
+static s_simulation_instance make_chunk_view(const s_simulation_instance *sim, size_t start, size_t count)
+{
+    s_simulation_instance view = {0};
+#if RABBIT_STORAGE_SOA
+    view.columns.age = sim->columns.age + start;
+    view.columns.maturity_age = sim->columns.maturity_age + start;
+    view.columns.flags = sim->columns.flags + start;
+    view.columns.nb_litters_y = sim->columns.nb_litters_y + start;
+    view.columns.nb_litters = sim->columns.nb_litters + start;
+    view.columns.survival_rate = sim->columns.survival_rate ? sim->columns.survival_rate + start : NULL;
+#else
+    view.rabbits = sim->rabbits + start;
+#endif
+    view.rabbit_count = count;
+    view.rabbit_capacity = count;
+    view.survival = sim->survival;
+    view.founder_rate = sim->founder_rate;
+    view.static_thresholds = sim->static_thresholds;
+    view.static_table_ages = sim->static_table_ages;
+    view.update_kernel = sim->update_kernel;
+    return view;
+}
+
+/**
+ * @brief Copies a block of rabbits to another, non overlapping, place of the array.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param dst The index of the first destination slot.
+ * @param src The index of the first rabbit to copy.
+ * @param count The number of rabbits to copy.
+ * @return void
+ */
+static void copy_rabbit_block(s_simulation_instance *sim, size_t dst, size_t src, size_t count)
+{
+#if RABBIT_STORAGE_SOA
+    memcpy(sim->columns.age + dst, sim->columns.age + src, count * sizeof(uint16_t));
+    memcpy(sim->columns.maturity_age + dst, sim->columns.maturity_age + src, count * sizeof(uint16_t));
+    memcpy(sim->columns.flags + dst, sim->columns.flags + src, count * sizeof(uint8_t));
+    memcpy(sim->columns.nb_litters_y + dst, sim->columns.nb_litters_y + src, count * sizeof(uint8_t));
+    memcpy(sim->columns.nb_litters + dst, sim->columns.nb_litters + src, count * sizeof(uint8_t));
+    if (sim->columns.survival_rate)
+        memcpy(sim->columns.survival_rate + dst, sim->columns.survival_rate + src, count * sizeof(float));
+#else
+    memcpy(sim->rabbits + dst, sim->rabbits + src, count * sizeof(s_rabbit));
+#endif
+}
+
+/**
+ * @brief Two-phase parallel version of update_rabbits for a single large simulation.
+ *        Phase 1 (parallel): the array is split in chunks of UPDATE_CHUNK_SIZE rabbits, each updated and
+ *        compacted in place with its own RNG stream (seeded from a per-month seed drawn from rng and the
+ *        chunk number) and its own death/birth counters.
+ *        Phase 2 (serial): the counters are merged, the holes left at the end of each chunk are filled
+ *        with survivors taken from the end of the array (only the dead slots are rewritten), then the new
+ *        generation is created. Chunks depend on the population only, so a given seed gives the same
+ *        results whatever the number of threads.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return void
+ */
+void update_rabbits_chunked(s_simulation_instance *sim, pcg32x_random_t *rng)
+{
+    size_t nb_chunks = (sim->rabbit_count + UPDATE_CHUNK_SIZE - 1) / UPDATE_CHUNK_SIZE;
+    uint64_t month_seed = ((uint64_t)pcg32x_random_r(rng) << 32) | pcg32x_random_r(rng);
+
+    size_t *chunk_alive = malloc(sizeof(size_t) * (nb_chunks > 0 ? nb_chunks : 1));
+    if (!chunk_alive)
+    {
+        // Not enough memory for the chunk table: fall back to the serial update
+        sim->update_threads = 0;
+        update_rabbits(sim, rng);
+        return;
+    }
+
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    // Every chunk keeps the deaths and maturities of its rabbits in its own histogram, added to the
+    // simulation's one after phase 1
+    s_age_histogram *chunk_ages = NULL;
+    if (sim->ages.rows > 0)
+    {
+        if (!advance_age_histogram(&sim->ages) ||
+            !(chunk_ages = calloc(nb_chunks > 0 ? nb_chunks : 1, sizeof(s_age_histogram))))
+        {
+            free(chunk_alive);
+            sim->update_threads = 0;
+            update_rabbits(sim, rng);
+            return;
+        }
+    }
+    #endif
+
+    int nb_new_born = 0;
+    size_t deaths = 0;
+    int dead_females = 0, dead_males = 0;
+    int pregnant_females = 0;
+    int out_of_memory = 0;
+
+    // Phase 1: update the chunks independently
+    INSTRUMENT_PHASE_START(update_start);
+    #pragma omp parallel for schedule(static) num_threads(sim->update_threads) \
+        reduction(+ : nb_new_born, deaths, dead_females, dead_males, pregnant_females) reduction(| : out_of_memory)
+    for (size_t c = 0; c < nb_chunks; ++c)
+    {
+        size_t start = c * UPDATE_CHUNK_SIZE;
+        size_t count = (start + UPDATE_CHUNK_SIZE <= sim->rabbit_count) ? UPDATE_CHUNK_SIZE : sim->rabbit_count - start;
+        s_simulation_instance view = make_chunk_view(sim, start, count);
+        pcg32x_random_t chunk_rng;
+        pcg32x_srandom_r(&chunk_rng, month_seed, (uint64_t)c);
+        #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+        if (chunk_ages)
+        {
+            if (start_age_histogram(&chunk_ages[c], sim->ages.rows, sim->ages.origin))
+            {
+                chunk_ages[c].oldest = sim->ages.oldest;
+                view.ages = chunk_ages[c];
+            }
+            else
+            {
+                view.update_kernel = NULL;
+                out_of_memory = 1;
+            }
+        }
+        #endif
+
+        nb_new_born += update_rabbit_range(&view, &chunk_rng);
+        deaths += view.dead_rabbit_count;
+        dead_females -= view.sex_distribution[0];
+        dead_males -= view.sex_distribution[1];
+        chunk_alive[c] = view.rabbit_count;
+        pregnant_females += view.stats.pregnant_females;
+    }
+
+    INSTRUMENT_PHASE_END(PHASE_UPDATE, update_start);
+    INSTRUMENT_MAX(max_free_slots, deaths);
+
+    // Phase 2: fill the holes left before the final size with the survivors found after it
+    INSTRUMENT_PHASE_START(compaction_start);
+    size_t total = sim->rabbit_count;
+    size_t alive = 0;
+    for (size_t c = 0; c < nb_chunks; ++c)
+        alive += chunk_alive[c];
+
+    size_t hole_chunk = 0, hole_pos = 0, hole_end = 0;
+    size_t src_chunk = nb_chunks, src_pos = 0, src_end = 0;
+    for (;;)
+    {
+        while (hole_pos == hole_end && hole_chunk < nb_chunks)
+        {
+            size_t start = hole_chunk * UPDATE_CHUNK_SIZE;
+            size_t end = (start + UPDATE_CHUNK_SIZE < total) ? start + UPDATE_CHUNK_SIZE : total;
+            hole_pos = start + chunk_alive[hole_chunk];
+            hole_end = (end < alive) ? end : alive;
+            if (hole_pos > hole_end)
+                hole_pos = hole_end;
+            hole_chunk++;
+        }
+        if (hole_pos == hole_end)
+            break;
+
+        // There are as many survivors after the final size as holes before it
+        while (src_pos == src_end)
+        {
+            src_chunk--;
+            size_t start = src_chunk * UPDATE_CHUNK_SIZE;
+            src_end = start + chunk_alive[src_chunk];
+            src_pos = (start > alive) ? start : alive;
+            if (src_pos > src_end)
+                src_pos = src_end;
+        }
+
+        size_t block = (hole_end - hole_pos < src_end - src_pos) ? hole_end - hole_pos : src_end - src_pos;
+        copy_rabbit_block(sim, hole_pos, src_pos, block);
+        hole_pos += block;
+        src_pos += block;
+    }
+    free(chunk_alive);
+    INSTRUMENT_PHASE_END(PHASE_COMPACTION, compaction_start);
+
+    sim->rabbit_count = alive;
+    sim->free_count = 0;
+    sim->dead_rabbit_count += deaths;
+    sim->sex_distribution[0] -= dead_females;
+    sim->sex_distribution[1] -= dead_males;
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    sim->deaths_this_month = (int)deaths;
+    sim->births_this_month = 0;
+    sim->stats.pregnant_females = pregnant_females;
+    if (chunk_ages)
+    {
+        for (size_t c = 0; c < nb_chunks; ++c)
+        {
+            add_age_histogram(&sim->ages, &chunk_ages[c]);
+            free_age_histogram(&chunk_ages[c]);
+        }
+        free(chunk_ages);
+        // A chunk without its histogram updated its rabbits without them, rebuild from the array
+        if (out_of_memory)
+            refresh_population_stats(sim);
     }
+    #else
+    (void)out_of_memory;
+    #endif
+    INSTRUMENT_PHASE_START(shrink_start);
+    shrink_capacity(sim);
+    INSTRUMENT_PHASE_END(PHASE_SHRINK, shrink_start);
+
+    INSTRUMENT_PHASE_START(births_start);
     create_new_generation(sim, nb_new_born, rng);
+    INSTRUMENT_PHASE_END(PHASE_BIRTHS, births_start);
 }
 
 // ===== LOGGING FUNCTIONS =====
@@ -549,30 +1646,66 @@ void update_rabbits(s_simulation_instance *sim, pcg32_random_t *rng)
 #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
 
 /**
- * @brief Initializes the monthly logging system by allocating memory for monthly statistics.
+ * @brief Initializes the monthly logging system, allocating memory for monthly statistics if the instance has not enough.
  * @param sim A pointer to the s_simulation_instance.
  * @param months The maximum number of months to simulate.
  * @return void
  */
 void init_monthly_logging(s_simulation_instance *sim, int months)
 {
-    sim->monthly_data = malloc(sizeof(s_monthly_stats) * months);
-    if (sim->monthly_data)
+    // A pooled instance keeps its buffer from the previous logged run
+    if (sim->monthly_data_allocated < months)
+    {
+        s_monthly_stats *temp = realloc(sim->monthly_data, sizeof(s_monthly_stats) * months);
+        if (temp)
+        {
+            sim->monthly_data = temp;
+            sim->monthly_data_allocated = months;
+        }
+    }
+    if (sim->monthly_data && sim->monthly_data_allocated >= months)
     {
         sim->monthly_data_capacity = months;
         sim->monthly_data_count = 0;
     }
+    sim->age_row_count = 0;
     sim->deaths_this_month = 0;
     sim->births_this_month = 0;
 }
 
 /**
- * @brief Records statistics for the current month by analyzing all living rabbits.
+ * @brief Appends the age structure of the current month to the age rows of the simulation.
+ *        Keeps the rows recorded so far if the buffer cannot grow.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param month The current month number.
+ * @return void
+ */
+static void record_age_structure(s_simulation_instance *sim, int month)
+{
+    size_t count = count_age_rows(&sim->ages);
+    if (sim->age_row_count + count > sim->age_rows_allocated)
+    {
+        size_t allocated = sim->age_rows_allocated > 0 ? sim->age_rows_allocated * 2 : 256;
+        while (allocated < sim->age_row_count + count)
+            allocated *= 2;
+        s_age_row *temp = realloc(sim->age_rows, sizeof(s_age_row) * allocated);
+        if (!temp)
+            return;
+        sim->age_rows = temp;
+        sim->age_rows_allocated = allocated;
+    }
+    sim->age_row_count += fill_age_rows(&sim->ages, month, sim->age_rows + sim->age_row_count);
+}
+
+/**
+ * @brief Records statistics for the current month of the living rabbits.
+ *        The individual and event engines read the age histogram kept up to date by their updates
+ *        (sim->ages), the cohort engine sums the statistics over its cohorts and rebuilds the histogram
+ *        from them. With age_structure_log the rows of the histogram are recorded too.
  * @param sim A pointer to the s_simulation_instance.
  * @param month The current month number.
  * @return void
  */
-// TO DO: I already know the number of alive rabbits et the number of males and females, maybe I should just add another for age instead of going through the whole array again
 void record_monthly_stats(s_simulation_instance *sim, int month, int alive_count, int males, int females)
 {
     if (!sim->monthly_data || sim->monthly_data_count >= sim->monthly_data_capacity)
@@ -590,32 +1723,449 @@ void record_monthly_stats(s_simulation_instance *sim, int month, int alive_count
     long long age_sum = 0;
     int min_age = INT_MAX;
     int max_age = INT_MIN;
+    s_age_histogram *ages = &sim->ages;
+    if (ages->rows > 0)
+        ages->origin = AGE_HISTOGRAM_FOUNDER_AGE + month;
     
-    for (size_t i = 0; i < sim->rabbit_count; ++i)
+    if (sim->engine == ENGINE_COHORT)
     {
-        if (sim->rabbits[i].status == 0)
-            continue;
-            
-        int age = sim->rabbits[i].age;
-        age_sum += age;
-        if (age < min_age) min_age = age;
-        if (age > max_age) max_age = age;
-            
-        if (sim->rabbits[i].mature)
-            stats->mature_rabbits++;
-            
-        if (sim->rabbits[i].pregnant)
-            stats->pregnant_females++;
+        collect_cohort_stats(sim, &age_sum, &min_age, &max_age, &stats->mature_rabbits, &stats->pregnant_females);
+        if (ages->rows > 0)
+            fill_cohort_age_histogram(sim);
+    }
+    else if (sim->engine == ENGINE_EVENT)
+    {
+        collect_event_stats(sim, &age_sum, &min_age, &max_age, &stats->mature_rabbits, &stats->pregnant_females);
+    }
+    else if (alive_count > 0 && ages->rows > 0)
+    {
+        // Maintained by add_rabbit and update_rabbit_range (summed over the demes of a split simulation),
+        // no need to go through the array again
+        long long mature_rabbits;
+        age_sum = summarize_age_histogram(ages, &min_age, &max_age, &mature_rabbits);
+        stats->mature_rabbits = (int)mature_rabbits;
+        stats->pregnant_females = sim->stats.pregnant_females;
     }
     
     stats->total_alive = alive_count;
     stats->avg_age = alive_count > 0 ? (float)age_sum / alive_count : 0.0f;
     stats->min_age = (min_age == INT_MAX) ? 0 : min_age;
     stats->max_age = (max_age == INT_MIN) ? 0 : max_age;
+
+    if (age_structure_log && ages->rows > 0)
+        record_age_structure(sim, month);
+}
+
+// Column of a binary log file
+typedef struct {
+    const char *name;
+    binary_log_type_t type;
+} s_binary_log_column;
+
+// Columns of the binary logs, same names and order as the CSV files
+static const s_binary_log_column monthly_log_columns[] = {
+    {"Month", BINARY_LOG_INT32}, {"Total_Alive", BINARY_LOG_INT32}, {"Males", BINARY_LOG_INT32},
+    {"Females", BINARY_LOG_INT32}, {"Male_Percentage", BINARY_LOG_FLOAT32}, {"Female_Percentage", BINARY_LOG_FLOAT32},
+    {"Mature_Rabbits", BINARY_LOG_INT32}, {"Pregnant_Females", BINARY_LOG_INT32}, {"Births", BINARY_LOG_INT32},
+    {"Deaths", BINARY_LOG_INT32}, {"Avg_Age", BINARY_LOG_FLOAT32}, {"Min_Age", BINARY_LOG_INT32},
+    {"Max_Age", BINARY_LOG_INT32}
+};
+
+// Stop_Reason holds the stop_reason_t value instead of its name
+static const s_binary_log_column summary_log_columns[] = {
+    {"Sim_Number", BINARY_LOG_INT32}, {"Final_Alive", BINARY_LOG_INT32}, {"Total_Dead", BINARY_LOG_INT32},
+    {"Final_Males", BINARY_LOG_INT32}, {"Final_Females", BINARY_LOG_INT32}, {"Male_Pct", BINARY_LOG_FLOAT32},
+    {"Female_Pct", BINARY_LOG_FLOAT32}, {"Peak_Pop", BINARY_LOG_INT32}, {"Peak_Month", BINARY_LOG_INT32},
+    {"Min_Pop", BINARY_LOG_INT32}, {"Min_Month", BINARY_LOG_INT32}, {"Extinction_Month", BINARY_LOG_INT32},
+    {"Months_Simulated", BINARY_LOG_INT32}, {"Stop_Reason", BINARY_LOG_INT32}, {"Cohort_Switch_Month", BINARY_LOG_INT32}
+};
+
+// Columns of the age structure logs, one row per month and age with living rabbits
+static const s_binary_log_column age_log_columns[] = {
+    {"Month", BINARY_LOG_INT32}, {"Age", BINARY_LOG_INT32}, {"Immature_Females", BINARY_LOG_INT32},
+    {"Mature_Females", BINARY_LOG_INT32}, {"Immature_Males", BINARY_LOG_INT32}, {"Mature_Males", BINARY_LOG_INT32}
+};
+
+#define NB_AGE_LOG_COLUMNS (int)(sizeof(age_log_columns) / sizeof(age_log_columns[0]))
+#define NB_MONTHLY_LOG_COLUMNS (int)(sizeof(monthly_log_columns) / sizeof(monthly_log_columns[0]))
+#define NB_SUMMARY_LOG_COLUMNS (int)(sizeof(summary_log_columns) / sizeof(summary_log_columns[0]))
+
+/**
+ * @brief Stores a 32-bit value in little-endian order.
+ * @param p The destination.
+ * @param value The value.
+ * @return void
+ */
+static void put_le32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * @brief Stores a 64-bit value in little-endian order.
+ * @param p The destination.
+ * @param value The value.
+ * @return void
+ */
+static void put_le64(uint8_t *p, uint64_t value)
+{
+    put_le32(p, (uint32_t)value);
+    put_le32(p + 4, (uint32_t)(value >> 32));
+}
+
+/**
+ * @brief Stores a float in little-endian order.
+ * @param p The destination.
+ * @param value The value.
+ * @return void
+ */
+static void put_float(uint8_t *p, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_le32(p, bits);
+}
+
+/**
+ * @brief Allocates a binary log file in memory and fills its header and column descriptors (see rabbitsim.h).
+ * @param kind The kind of log.
+ * @param columns The columns of the file.
+ * @param nb_columns The number of columns.
+ * @param nb_rows The number of rows.
+ * @param months The number of months simulated.
+ * @param initial_population The initial population size.
+ * @param base_seed The base random seed used (0 if unknown).
+ * @param number The simulation number (monthly log) or the number of simulations (summary).
+ * @param size Receives the size of the file in bytes.
+ * @return The file contents, to free, or NULL if the allocation failed. Column c starts at binary_log_cell(buffer, nb_columns, nb_rows, c, 0).
+ */
+static uint8_t *new_binary_log(binary_log_kind_t kind, const s_binary_log_column *columns, int nb_columns, int nb_rows,
+                               int months, int initial_population, uint64_t base_seed, int number, size_t *size)
+{
+    *size = BINARY_LOG_HEADER_SIZE + (size_t)nb_columns * BINARY_LOG_COLUMN_SIZE + (size_t)nb_columns * nb_rows * 4;
+    uint8_t *buffer = calloc(1, *size);
+    if (!buffer)
+        return NULL;
+
+    memcpy(buffer, BINARY_LOG_MAGIC, 8);
+    put_le32(buffer + 8, BINARY_LOG_VERSION);
+    put_le32(buffer + 12, kind);
+    put_le32(buffer + 16, (uint32_t)nb_columns);
+    put_le32(buffer + 20, (uint32_t)nb_rows);
+    put_le32(buffer + 24, (uint32_t)months);
+    put_le32(buffer + 28, (uint32_t)initial_population);
+    put_le64(buffer + 32, base_seed);
+    put_le32(buffer + 40, (uint32_t)number);
+
+    for (int c = 0; c < nb_columns; ++c)
+    {
+        uint8_t *descriptor = buffer + BINARY_LOG_HEADER_SIZE + (size_t)c * BINARY_LOG_COLUMN_SIZE;
+        strncpy((char *)descriptor, columns[c].name, BINARY_LOG_NAME_SIZE - 1);
+        put_le32(descriptor + BINARY_LOG_NAME_SIZE, columns[c].type);
+    }
+    return buffer;
+}
+
+/**
+ * @brief Locates a value in the data of a binary log file.
+ * @param buffer The file contents from new_binary_log.
+ * @param nb_columns The number of columns.
+ * @param nb_rows The number of rows.
+ * @param column The column of the value.
+ * @param row The row of the value.
+ * @return A pointer to the 4 bytes of the value.
+ */
+static uint8_t *binary_log_cell(uint8_t *buffer, int nb_columns, int nb_rows, int column, int row)
+{
+    return buffer + BINARY_LOG_HEADER_SIZE + (size_t)nb_columns * BINARY_LOG_COLUMN_SIZE +
+           ((size_t)column * nb_rows + row) * 4;
+}
+
+/**
+ * @brief Writes a binary log file with a single bulk write and frees its contents.
+ * @param filename The name of the file.
+ * @param buffer The file contents from new_binary_log.
+ * @param size The size of the file in bytes.
+ * @return void
+ */
+static void write_binary_log(const char *filename, uint8_t *buffer, size_t size)
+{
+    FILE *fp = fopen(filename, "wb");
+    if (!fp || fwrite(buffer, 1, size, fp) != size)
+        LOG_PRINT("Warning: Could not write log file %s\n", filename);
+    if (fp)
+        fclose(fp);
+    free(buffer);
+}
+
+/**
+ * @brief Builds the binary columnar file (".rlog") of the monthly statistics of one simulation.
+ * @param log The monthly statistics of the simulation.
+ * @param size Receives the size of the file in bytes.
+ * @return The file contents, to free, or NULL if the allocation failed.
+ */
+static uint8_t *build_monthly_binary_log(const s_monthly_log *log, size_t *size)
+{
+    int rows = log->count;
+    uint8_t *buffer = new_binary_log(BINARY_LOG_MONTHLY, monthly_log_columns, NB_MONTHLY_LOG_COLUMNS, rows,
+                                     log->months, log->initial_population, 0, log->sim_number, size);
+    if (!buffer)
+        return NULL;
+
+    for (int i = 0; i < rows; ++i)
+    {
+        const s_monthly_stats *s = &log->data[i];
+        float male_pct = s->total_alive > 0 ? (float)s->males * 100.0f / s->total_alive : 0.0f;
+        float female_pct = s->total_alive > 0 ? (float)s->females * 100.0f / s->total_alive : 0.0f;
+
+        put_le32(binary_log_cell(buffer, NB_MONTHLY_LOG_COLUMNS, rows, 0, i), (uint32_t)s->month);
+        put_le32(binary_log_cell(buffer, NB_MONTHLY_LOG_COLUMNS, rows, 1, i), (uint32_t)s->total_alive);
+        put_le32(binary_log_cell(buffer, NB_MONTHLY_LOG_COLUMNS, rows, 2, i), (uint32_t)s->males);
+        put_le32(binary_log_cell(buffer, NB_MONTHLY_LOG_COLUMNS, rows, 3, i), (uint32_t)s->females);
+        put_float(binary_log_cell(buffer, NB_MONTHLY_LOG_COLUMNS, rows, 4, i), male_pct);
+        put_float(binary_log_cell(buffer, NB_MONTHLY_LOG_COLUMNS, rows, 5, i), female_pct);
+        put_le32(binary_log_cell(buffer, NB_MONTHLY_LOG_COLUMNS, rows, 6, i), (uint32_t)s->mature_rabbits);
+        put_le32(binary_log_cell(buffer, NB_MONTHLY_LOG_COLUMNS, rows, 7, i), (uint32_t)s->pregnant_females);
+        put_le32(binary_log_cell(buffer, NB_MONTHLY_LOG_COLUMNS, rows, 8, i), (uint32_t)s->births_this_month);
+        put_le32(binary_log_cell(buffer, NB_MONTHLY_LOG_COLUMNS, rows, 9, i), (uint32_t)s->deaths_this_month);
+        put_float(binary_log_cell(buffer, NB_MONTHLY_LOG_COLUMNS, rows, 10, i), s->avg_age);
+        put_le32(binary_log_cell(buffer, NB_MONTHLY_LOG_COLUMNS, rows, 11, i), (uint32_t)s->min_age);
+        put_le32(binary_log_cell(buffer, NB_MONTHLY_LOG_COLUMNS, rows, 12, i), (uint32_t)s->max_age);
+    }
+    return buffer;
+}
+
+/**
+ * @brief Prints the monthly statistics of one simulation as CSV rows.
+ * @param fp The destination file.
+ * @param log The monthly statistics of the simulation.
+ * @param with_sim_number 1 to start every row with the simulation number (single stream file), 0 otherwise.
+ * @return void
+ */
+static void print_monthly_csv_rows(FILE *fp, const s_monthly_log *log, int with_sim_number)
+{
+    for (int i = 0; i < log->count; ++i)
+    {
+        const s_monthly_stats *s = &log->data[i];
+        float male_pct = s->total_alive > 0 ? (float)s->males * 100.0f / s->total_alive : 0.0f;
+        float female_pct = s->total_alive > 0 ? (float)s->females * 100.0f / s->total_alive : 0.0f;
+        
+        if (with_sim_number)
+            fprintf(fp, "%d,", log->sim_number);
+        fprintf(fp, "%d,%d,%d,%d,%.2f,%.2f,%d,%d,%d,%d,%.2f,%d,%d\n",
+                s->month, s->total_alive, s->males, s->females,
+                male_pct, female_pct, s->mature_rabbits, s->pregnant_females,
+                s->births_this_month, s->deaths_this_month, s->avg_age, s->min_age, s->max_age);
+    }
+}
+
+/**
+ * @brief Writes the age structure of one simulation to its own file ("age_structure_<n>_pop<p>"),
+ *        CSV or binary depending on log_format. Does nothing if the simulation recorded none.
+ * @param log The monthly statistics of the simulation, with its age rows.
+ * @return void
+ */
+static void write_age_structure_log(const s_monthly_log *log)
+{
+    if (!log->age_rows || log->age_row_count == 0)
+        return;
+
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%sage_structure_%d_pop%d.%s", log_file_prefix, log->sim_number,
+             log->initial_population, log_format == LOG_FORMAT_BINARY ? "rlog" : "csv");
+
+    if (log_format == LOG_FORMAT_BINARY)
+    {
+        int rows = (int)log->age_row_count;
+        size_t size;
+        uint8_t *buffer = new_binary_log(BINARY_LOG_AGES, age_log_columns, NB_AGE_LOG_COLUMNS, rows,
+                                         log->months, log->initial_population, 0, log->sim_number, &size);
+        if (!buffer)
+        {
+            LOG_PRINT("Warning: Could not allocate log file %s\n", filename);
+            return;
+        }
+        for (int i = 0; i < rows; ++i)
+        {
+            const s_age_row *row = &log->age_rows[i];
+            put_le32(binary_log_cell(buffer, NB_AGE_LOG_COLUMNS, rows, 0, i), (uint32_t)row->month);
+            put_le32(binary_log_cell(buffer, NB_AGE_LOG_COLUMNS, rows, 1, i), (uint32_t)row->age);
+            for (int c = 0; c < NB_AGE_CLASSES; ++c)
+                put_le32(binary_log_cell(buffer, NB_AGE_LOG_COLUMNS, rows, 2 + c, i), (uint32_t)row->counts[c]);
+        }
+        write_binary_log(filename, buffer, size);
+        return;
+    }
+
+    FILE *fp = fopen(filename, "w");
+    if (!fp)
+    {
+        LOG_PRINT("Warning: Could not create log file %s\n", filename);
+        return;
+    }
+    fprintf(fp, "Month,Age,Immature_Females,Mature_Females,Immature_Males,Mature_Males\n");
+    for (size_t i = 0; i < log->age_row_count; ++i)
+    {
+        const s_age_row *row = &log->age_rows[i];
+        fprintf(fp, "%d,%d,%lld,%lld,%lld,%lld\n", row->month, row->age, row->counts[AGE_CLASS(0, 0)],
+                row->counts[AGE_CLASS(0, 1)], row->counts[AGE_CLASS(1, 0)], row->counts[AGE_CLASS(1, 1)]);
+    }
+    fclose(fp);
+}
+
+// Header of the monthly CSV files
+#define MONTHLY_CSV_HEADER "Month,Total_Alive,Males,Females,Male_Percentage,Female_Percentage,Mature_Rabbits,Pregnant_Females,Births,Deaths,Avg_Age,Min_Age,Max_Age\n"
+
+/**
+ * @brief Writes the monthly statistics of one simulation to its own file, CSV or binary depending on log_format,
+ *        and its age structure to another one (see write_age_structure_log).
+ * @param log The monthly statistics of the simulation.
+ * @return void
+ */
+void write_monthly_log(const s_monthly_log *log)
+{
+    if (!log->data || log->count == 0)
+        return;
+
+    write_age_structure_log(log);
+
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%ssimulation_%d_pop%d.%s", log_file_prefix, log->sim_number,
+             log->initial_population, log_format == LOG_FORMAT_BINARY ? "rlog" : "csv");
+
+    if (log_format == LOG_FORMAT_BINARY)
+    {
+        size_t size;
+        uint8_t *buffer = build_monthly_binary_log(log, &size);
+        if (!buffer)
+        {
+            LOG_PRINT("Warning: Could not allocate log file %s\n", filename);
+            return;
+        }
+        write_binary_log(filename, buffer, size);
+        return;
+    }
+    
+    FILE *fp = fopen(filename, "w");
+    if (!fp)
+    {
+        LOG_PRINT("Warning: Could not create log file %s\n", filename);
+        return;
+    }
+    
+    // Write CSV header
+    fprintf(fp, MONTHLY_CSV_HEADER);
+    
+    // Write data for each month
+    print_monthly_csv_rows(fp, log, 0);
+    
+    fclose(fp);
+    //LOG_PRINT("    Logged simulation %d data to %s\n", sim_number, filename);
+}
+
+/**
+ * @brief Opens the single file that receives the monthly statistics of every logged simulation
+ *        ("simulation_monthly_pop<N>.csv" with a leading Sim_Number column, or ".rlog" with one block per simulation).
+ * @param initial_population The initial population size (for filename).
+ * @return The open file, or NULL if it could not be created.
+ */
+FILE *open_monthly_log_stream(int initial_population)
+{
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%ssimulation_monthly_pop%d.%s", log_file_prefix, initial_population,
+             log_format == LOG_FORMAT_BINARY ? "rlog" : "csv");
+
+    FILE *fp = fopen(filename, log_format == LOG_FORMAT_BINARY ? "wb" : "w");
+    if (!fp)
+    {
+        LOG_PRINT("Warning: Could not create log file %s\n", filename);
+        return NULL;
+    }
+    if (log_format == LOG_FORMAT_CSV)
+        fprintf(fp, "Sim_Number," MONTHLY_CSV_HEADER);
+    return fp;
+}
+
+/**
+ * @brief Appends the monthly statistics of one simulation to the file of open_monthly_log_stream.
+ *        Its age structure still goes to its own file (see write_age_structure_log).
+ * @param fp The stream file.
+ * @param log The monthly statistics of the simulation.
+ * @return void
+ */
+void append_monthly_log(FILE *fp, const s_monthly_log *log)
+{
+    if (!log->data || log->count == 0)
+        return;
+
+    write_age_structure_log(log);
+    if (log_format == LOG_FORMAT_CSV)
+    {
+        print_monthly_csv_rows(fp, log, 1);
+        return;
+    }
+
+    size_t size;
+    uint8_t *buffer = build_monthly_binary_log(log, &size);
+    if (!buffer || fwrite(buffer, 1, size, fp) != size)
+        LOG_PRINT("Warning: Could not append simulation %d to the log stream\n", log->sim_number);
+    free(buffer);
+}
+
+/**
+ * @brief Writes the results of all simulations to a binary columnar file (".rlog").
+ * @param months The number of months simulated.
+ * @param initial_population The initial population size.
+ * @param nb_simulations The total number of simulations run.
+ * @param all_results Array of results from all simulations.
+ * @param base_seed The base random seed used.
+ * @return void
+ */
+static void write_summary_log_binary(int months, int initial_population, int nb_simulations,
+                                     s_simulation_results *all_results, uint64_t base_seed)
+{
+    char filename[256];
+    snprintf(filename, sizeof(filename), "%ssimulation_summary_pop%d_%dsims.rlog", log_file_prefix,
+             initial_population, nb_simulations);
+
+    size_t size;
+    uint8_t *buffer = new_binary_log(BINARY_LOG_SUMMARY, summary_log_columns, NB_SUMMARY_LOG_COLUMNS, nb_simulations,
+                                     months, initial_population, base_seed, nb_simulations, &size);
+    if (!buffer)
+    {
+        LOG_PRINT("Warning: Could not allocate summary file %s\n", filename);
+        return;
+    }
+
+    for (int i = 0; i < nb_simulations; ++i)
+    {
+        s_simulation_results *r = &all_results[i];
+        int n = NB_SUMMARY_LOG_COLUMNS;
+        put_le32(binary_log_cell(buffer, n, nb_simulations, 0, i), (uint32_t)(i + 1));
+        put_le32(binary_log_cell(buffer, n, nb_simulations, 1, i), (uint32_t)r->final_alive);
+        put_le32(binary_log_cell(buffer, n, nb_simulations, 2, i), (uint32_t)r->total_dead);
+        put_le32(binary_log_cell(buffer, n, nb_simulations, 3, i), (uint32_t)r->final_males);
+        put_le32(binary_log_cell(buffer, n, nb_simulations, 4, i), (uint32_t)r->final_females);
+        put_float(binary_log_cell(buffer, n, nb_simulations, 5, i), r->male_percentage);
+        put_float(binary_log_cell(buffer, n, nb_simulations, 6, i), r->female_percentage);
+        put_le32(binary_log_cell(buffer, n, nb_simulations, 7, i), (uint32_t)r->peak_population);
+        put_le32(binary_log_cell(buffer, n, nb_simulations, 8, i), (uint32_t)r->peak_population_month);
+        put_le32(binary_log_cell(buffer, n, nb_simulations, 9, i), (uint32_t)r->min_population);
+        put_le32(binary_log_cell(buffer, n, nb_simulations, 10, i), (uint32_t)r->min_population_month);
+        put_le32(binary_log_cell(buffer, n, nb_simulations, 11, i), (uint32_t)r->extinction_month);
+        put_le32(binary_log_cell(buffer, n, nb_simulations, 12, i), (uint32_t)r->months_simulated);
+        put_le32(binary_log_cell(buffer, n, nb_simulations, 13, i), (uint32_t)r->stop_reason);
+        put_le32(binary_log_cell(buffer, n, nb_simulations, 14, i), (uint32_t)r->cohort_switch_month);
+    }
+
+    write_binary_log(filename, buffer, size);
 }
 
 /**
- * @brief Writes the monthly statistics for a single simulation to a CSV file.
+ * @brief Writes the monthly statistics for a single simulation to its own log file.
  * @param sim A pointer to the s_simulation_instance.
  * @param sim_number The simulation number (for filename).
  * @param initial_population The initial population size (for filename).
@@ -623,37 +2173,9 @@ void record_monthly_stats(s_simulation_instance *sim, int month, int alive_count
  */
 void write_simulation_log(s_simulation_instance *sim, int sim_number, int initial_population)
 {
-    if (!sim->monthly_data || sim->monthly_data_count == 0)
-        return;
-    
-    char filename[256];
-    snprintf(filename, sizeof(filename), "simulation_%d_pop%d.csv", sim_number, initial_population);
-    
-    FILE *fp = fopen(filename, "w");
-    if (!fp)
-    {
-        LOG_PRINT("Warning: Could not create log file %s\n", filename);
-        return;
-    }
-    
-    // Write CSV header
-    fprintf(fp, "Month,Total_Alive,Males,Females,Male_Percentage,Female_Percentage,Mature_Rabbits,Pregnant_Females,Births,Deaths,Avg_Age,Min_Age,Max_Age\n");
-    
-    // Write data for each month
-    for (int i = 0; i < sim->monthly_data_count; ++i)
-    {
-        s_monthly_stats *s = &sim->monthly_data[i];
-        float male_pct = s->total_alive > 0 ? (float)s->males * 100.0f / s->total_alive : 0.0f;
-        float female_pct = s->total_alive > 0 ? (float)s->females * 100.0f / s->total_alive : 0.0f;
-        
-        fprintf(fp, "%d,%d,%d,%d,%.2f,%.2f,%d,%d,%d,%d,%.2f,%d,%d\n",
-                s->month, s->total_alive, s->males, s->females,
-                male_pct, female_pct, s->mature_rabbits, s->pregnant_females,
-                s->births_this_month, s->deaths_this_month, s->avg_age, s->min_age, s->max_age);
-    }
-    
-    fclose(fp);
-    //LOG_PRINT("    Logged simulation %d data to %s\n", sim_number, filename);
+    s_monthly_log log = { sim->monthly_data, sim->monthly_data_count, sim->monthly_data_capacity,
+                          sim_number, initial_population, sim->age_rows, sim->age_row_count };
+    write_monthly_log(&log);
 }
 
 /**
@@ -670,9 +2192,14 @@ void write_summary_log(int months, int initial_population, int nb_simulations,
 {
     if (!all_results)
         return;
+    if (log_format == LOG_FORMAT_BINARY)
+    {
+        write_summary_log_binary(months, initial_population, nb_simulations, all_results, base_seed);
+        return;
+    }
     
     char filename[256];
-    snprintf(filename, sizeof(filename), "simulation_summary_pop%d_%dsims.csv", 
+    snprintf(filename, sizeof(filename), "%ssimulation_summary_pop%d_%dsims.csv", log_file_prefix,
              initial_population, nb_simulations);
     
     FILE *fp = fopen(filename, "w");
@@ -691,19 +2218,33 @@ void write_summary_log(int months, int initial_population, int nb_simulations,
     fprintf(fp, "#\n");
     
     // Write CSV header
-    fprintf(fp, "Sim_Number,Final_Alive,Total_Dead,Final_Males,Final_Females,Male_Pct,Female_Pct,Peak_Pop,Peak_Month,Min_Pop,Min_Month,Extinction_Month,Months_Simulated\n");
+    fprintf(fp, "Sim_Number,Final_Alive,Total_Dead,Final_Males,Final_Females,Male_Pct,Female_Pct,Peak_Pop,Peak_Month,Min_Pop,Min_Month,Extinction_Month,Months_Simulated,Stop_Reason,Cohort_Switch_Month");
+    #if defined(ENABLE_INSTRUMENTATION) && ENABLE_INSTRUMENTATION != 0
+    fprintf(fp, ",Capacity_Grows,Capacity_Shrinks,RNG_Outputs,Max_Free_Slots");
+    for (int p = 0; p < NB_INSTRUMENT_PHASES; ++p)
+        fprintf(fp, ",%s_Cycles", get_instrument_phase_name(p));
+    #endif
+    fprintf(fp, "\n");
     
     // Write data for each simulation
     for (int i = 0; i < nb_simulations; ++i)
     {
         s_simulation_results *r = &all_results[i];
-        fprintf(fp, "%d,%d,%d,%d,%d,%.2f,%.2f,%d,%d,%d,%d,%d,%d\n",
+        fprintf(fp, "%d,%d,%d,%d,%d,%.2f,%.2f,%d,%d,%d,%d,%d,%d,%s,%d",
                 i + 1, r->final_alive, r->total_dead, 
                 r->final_males, r->final_females,
                 r->male_percentage, r->female_percentage,
                 r->peak_population, r->peak_population_month,
                 r->min_population, r->min_population_month,
-                r->extinction_month, r->months_simulated);
+                r->extinction_month, r->months_simulated,
+                get_stop_reason_name(r->stop_reason), r->cohort_switch_month);
+        #if defined(ENABLE_INSTRUMENTATION) && ENABLE_INSTRUMENTATION != 0
+        fprintf(fp, ",%lld,%lld,%lld,%lld", r->counters.capacity_grows, r->counters.capacity_shrinks,
+                r->counters.rng_outputs, r->counters.max_free_slots);
+        for (int p = 0; p < NB_INSTRUMENT_PHASES; ++p)
+            fprintf(fp, ",%llu", (unsigned long long)r->counters.phase_cycles[p]);
+        #endif
+        fprintf(fp, "\n");
     }
     
     fclose(fp);
@@ -718,6 +2259,9 @@ void write_simulation_log(s_simulation_instance *sim, int sim_number, int initia
 { 
     (void)sim; (void)sim_number; (void)initial_population; 
 }
+void write_monthly_log(const s_monthly_log *log) { (void)log; }
+FILE *open_monthly_log_stream(int initial_population) { (void)initial_population; return NULL; }
+void append_monthly_log(FILE *fp, const s_monthly_log *log) { (void)fp; (void)log; }
 void write_summary_log(int months, int initial_population, int nb_simulations,
                        s_simulation_results *all_results, uint64_t base_seed)
 {
@@ -728,6 +2272,70 @@ void write_summary_log(int months, int initial_population, int nb_simulations,
 
 // ===== END LOGGING FUNCTIONS =====
 
+/**
+ * @brief Computes, for every horizon h, the log of a lower bound of the probability that a newborn
+ *        rabbit is still alive h months later, whatever its maturity (the lowest mean monthly survival
+ *        rate of immature and mature rabbits of each age is used).
+ *        A rabbit's survival checks are independent of the other rabbits, so the probability that B
+ *        newborns are all dead after h months is at most (1 - exp(log_survival[h]))^B.
+ * @param params The survival parameters of the simulation.
+ * @param log_survival Receives months + 1 values, log_survival[0] being 0.
+ * @param months The longest horizon.
+ * @return void
+ */
+static void compute_newborn_log_survival(const s_survival_params *params, double *log_survival, int months)
+{
+    log_survival[0] = 0.0;
+    for (int h = 1; h <= months; ++h)
+    {
+        float immature = cohort_survival_rate(params, calculate_base_survival_rate_for(params, 0, h));
+        float mature = cohort_survival_rate(params, calculate_base_survival_rate_for(params, 1, h));
+        float rate = (immature < mature) ? immature : mature;
+        double monthly = (rate > 0.0f) ? (rate >= 100.0f ? 1.0 : rate / 100.0) : 0.0;
+        log_survival[h] = (monthly > 0.0) ? log_survival[h - 1] + log(monthly) : -INFINITY;
+    }
+}
+
+/**
+ * @brief Tells whether extinction before the last month has become less likely than extinction_confidence.
+ *        The population can only die out if every rabbit born last month is dead by the end, so
+ *        (1 - P(a newborn survives the remaining months))^births bounds the extinction probability.
+ *        The bound is only useful while the remaining months are shorter than a rabbit's lifespan.
+ * @param births The number of rabbits born during the last update.
+ * @param remaining_months The number of months left to simulate.
+ * @param log_survival The bounds computed by compute_newborn_log_survival.
+ * @return 1 if the simulation can stop, 0 otherwise.
+ */
+static int extinction_is_unlikely(long long births, int remaining_months, const double *log_survival)
+{
+    if (births <= 0 || remaining_months <= 0)
+        return 0;
+    double survive = exp(log_survival[remaining_months]);
+    if (!(survive > 0.0))
+        return 0;
+    double log_extinction = (double)births * log1p(-survive);
+    return log_extinction < log(extinction_confidence);
+}
+
+/**
+ * @brief Tells whether the next update could take a count of the simulation past INT_MAX.
+ *        The populations, deaths and births of the results and logs are 32-bit, so an exploding
+ *        population (as the cohort engine lets it grow) stops while they are still exact.
+ *        An update adds at most MAX_LITTER_SIZE kittens per pregnant rabbit and kills at most every rabbit.
+ * @param sim A pointer to the s_simulation_instance.
+ * @param alive The living rabbits before the update.
+ * @return 1 if the simulation has to stop, 0 otherwise.
+ */
+static int next_update_may_overflow(const s_simulation_instance *sim, long long alive)
+{
+    long long dead = (long long)sim->dead_rabbit_count;
+    if (alive * (1 + MAX_LITTER_SIZE) + dead <= INT_MAX)
+        return 0;
+    // Only the cohort engine gets this far in practice, its pregnant rabbits are counted per cohort
+    long long mothers = (sim->engine == ENGINE_COHORT) ? count_pregnant_cohorts(sim) : alive;
+    return alive + MAX_LITTER_SIZE * mothers > INT_MAX || dead + alive > INT_MAX;
+}
+
 /**
  * @brief Runs a full simulation of the rabbit population over a specified number of months.
  *        Initializes the population, then iteratively updates rabbit states each month.
@@ -741,7 +2349,7 @@ void write_summary_log(int months, int initial_population, int nb_simulations,
  * @param rng A pointer to the PCG random number generator state.
  * @return A s_simulation_results struct containing all collected statistics.
  */
-s_simulation_results simulate(s_simulation_instance *sim, int months, int initial_population_nb, pcg32_random_t *rng)
+s_simulation_results simulate(s_simulation_instance *sim, int months, int initial_population_nb, pcg32x_random_t *rng)
 {
     // Initialize results structure with default values
     s_simulation_results results = {0};
@@ -753,27 +2361,125 @@ s_simulation_results simulate(s_simulation_instance *sim, int months, int initia
     int min_month = 0;
     long long population_sum = 0;
     int actual_months = 0;
+    int stored = 1;
     
-    // Initialize starting population based on parameter
-    if (initial_population_nb == 2)
+    // Survival bounds of the confidence-based stop
+    double *log_survival = NULL;
+    if (sim->stop_mode == STOP_CONFIDENCE)
+    {
+        log_survival = malloc(sizeof(double) * (months + 1));
+        if (log_survival)
+            compute_newborn_log_survival(&sim->survival, log_survival, months);
+    }
+    results.stop_reason = STOP_REASON_COMPLETED;
+    ziggurat_init();
+    INSTRUMENT_PHASE_START(setup_start);
+
+    // The event engine draws death months from the static thresholds, the random methods use the individual engine
+    if (sim->engine == ENGINE_EVENT && sim->survival.method != SURVIVAL_STATIC)
+        sim->engine = ENGINE_INDIVIDUAL;
+
+    // Survival storage and thresholds of the static method, before the first rabbit is added
+    prepare_survival_storage(sim);
+    sim->founder_rate = (initial_population_nb == 2) ? SUPER_SRV_RATE : sim->survival.adult_rate;
+    if (sim->engine != ENGINE_COHORT && sim->survival.method == SURVIVAL_STATIC &&
+        !build_static_survival_table(sim, sim->founder_rate))
+    {
+        LOG_PRINT("Error: Could not allocate the static survival table\n");
+        return results;
+    }
+
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    // Age structure of a logged run, kept up to date from the first rabbit added
+    if (sim->monthly_data_capacity > 0 &&
+        !start_age_histogram(&sim->ages, AGE_HISTOGRAM_ROWS(months), AGE_HISTOGRAM_FOUNDER_AGE))
+        LOG_PRINT("Warning: Could not allocate the age histogram, the ages of this simulation are not logged\n");
+    #endif
+
+    // Continue from the checkpoint of this simulation, or initialize starting population based on parameter
+    s_simulation_progress progress;
+    int start_month = 0;
+    if (checkpoint_resume && sim->checkpoint && read_checkpoint(sim->checkpoint, sim, rng, &progress))
+    {
+        start_month = progress.month;
+        peak_population = progress.peak_population;
+        peak_month = progress.peak_month;
+        min_population = progress.min_population;
+        min_month = progress.min_month;
+        actual_months = progress.actual_months;
+        population_sum = progress.population_sum;
+        results.cohort_switch_month = progress.cohort_switch_month;
+        results.rabbit_updates = progress.rabbit_updates;
+        #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+        if (sim->ages.rows > 0)
+        {
+            sim->ages.origin = AGE_HISTOGRAM_FOUNDER_AGE + start_month;
+            if (sim->engine == ENGINE_INDIVIDUAL)
+                refresh_population_stats(sim);
+        }
+        #endif
+    }
+    else if (sim->engine == ENGINE_COHORT)
     {
-        init_2_super_rabbits(sim, rng);
+        stored = init_cohort_population(sim, initial_population_nb, rng);
     }
     else
     {
-        init_starting_population(sim, initial_population_nb, rng);
+        // Without its calendar the event engine falls back to the individual engine
+        if (sim->engine == ENGINE_EVENT && !init_event_population(sim, initial_population_nb, months, rng))
+        {
+            LOG_PRINT("Warning: Could not allocate the event calendar, the simulation uses the individual engine\n");
+            sim->engine = ENGINE_INDIVIDUAL;
+        }
+        if (sim->engine == ENGINE_INDIVIDUAL && initial_population_nb == 2)
+            init_2_super_rabbits(sim, rng);
+        else if (sim->engine == ENGINE_INDIVIDUAL)
+            init_starting_population(sim, initial_population_nb, rng);
     }
 
+    // Update loop of the individual engine, for the whole run (the demes take the same one)
+    select_update_kernel(sim);
+
+    // Independent sub-populations, each updated by its own thread (see deme.h)
+    if (sim->engine == ENGINE_INDIVIDUAL && sim->deme_count > 0 && !split_into_demes(sim, sim->deme_count, rng))
+        LOG_PRINT("Warning: Could not allocate the demes, the simulation runs as a single population\n");
+    INSTRUMENT_PHASE_END(PHASE_SETUP, setup_start);
+
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    // Population of the previous month, for the growth rate of the ensemble (unknown after a checkpoint)
+    int previous_alive = 0;
+    #endif
+
     // Main simulation loop - iterate through each month
-    for (int m = 0; m < months; ++m)
+    for (int m = start_month; m < months; ++m)
     {
+        // Save the simulation as it is at the start of this month (the event calendar and the demes are not saved)
+        if (checkpoint_interval > 0 && sim->checkpoint && sim->engine != ENGINE_EVENT && !has_demes(sim) &&
+            m > start_month && m % checkpoint_interval == 0)
+        {
+            progress = (s_simulation_progress){ m, peak_population, peak_month, min_population, min_month,
+                                                actual_months, population_sum, results.cohort_switch_month,
+                                                results.rabbit_updates };
+            write_checkpoint(sim->checkpoint, sim, rng, &progress);
+        }
+
         // Calculate current living population
-        int current_alive = sim->rabbit_count - sim->free_count;
+        int current_alive = (int)count_alive_rabbits(sim);
         
         // Check for extinction (all rabbits dead)
-        if (sim->free_count == sim->rabbit_count)
+        if (current_alive == 0)
         {
+            #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+            // The month of the last deaths, then the simulation stays empty to the end
+            if (sim->ensemble)
+            {
+                ensemble_add_month(sim->ensemble, m, 0, previous_alive, sim->births_this_month,
+                                   sim->deaths_this_month);
+                ensemble_add_extinction(sim->ensemble, m + 1);
+            }
+            #endif
             results.extinction_month = m;
+            results.stop_reason = STOP_REASON_EXTINCTION;
             actual_months = m;
             break;
         }
@@ -798,15 +2504,77 @@ s_simulation_results simulate(s_simulation_instance *sim, int months, int initia
         
         // Record monthly statistics before updating
         #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+        INSTRUMENT_PHASE_START(record_start);
+        double phase_start = measure_phases ? omp_get_wtime() : 0.0;
         record_monthly_stats(sim, m, current_alive, sim->sex_distribution[1], sim->sex_distribution[0]);
+        if (measure_phases)
+            results.record_time += omp_get_wtime() - phase_start;
+        if (sim->ensemble)
+            ensemble_add_month(sim->ensemble, m, current_alive, previous_alive, sim->births_this_month,
+                               sim->deaths_this_month);
+        previous_alive = current_alive;
+        INSTRUMENT_PHASE_END(PHASE_RECORD, record_start);
         #endif
+
+        // Early stop conditions, this month is the last one counted
+        if (sim->stop_mode == STOP_CEILING && current_alive >= population_ceiling)
+        {
+            results.stop_reason = STOP_REASON_CEILING;
+            break;
+        }
+        if (sim->stop_mode == STOP_SWITCH_TO_COHORT && sim->engine == ENGINE_INDIVIDUAL &&
+            current_alive >= population_ceiling && merge_demes(sim))
+        {
+            stored &= convert_rabbits_to_cohorts(sim);
+            results.cohort_switch_month = m;
+        }
+        if (sim->stop_mode == STOP_CONFIDENCE && log_survival &&
+            extinction_is_unlikely(sim->last_births, months - m, log_survival))
+        {
+            results.stop_reason = STOP_REASON_CONFIDENCE;
+            break;
+        }
+        if (next_update_may_overflow(sim, current_alive))
+        {
+            results.stop_reason = STOP_REASON_LIMIT;
+            break;
+        }
         
         // Update all rabbits for this month (births, deaths, aging, etc.)
-        update_rabbits(sim, rng);
+        double update_start = measure_phases ? omp_get_wtime() : 0.0;
+        results.rabbit_updates += current_alive;
+        if (sim->engine == ENGINE_COHORT)
+        {
+            INSTRUMENT_PHASE_START(cohorts_start);
+            stored &= update_cohorts(sim, rng);
+            INSTRUMENT_PHASE_END(PHASE_COHORTS, cohorts_start);
+        }
+        else if (sim->engine == ENGINE_EVENT)
+        {
+            INSTRUMENT_PHASE_START(events_start);
+            stored &= update_events(sim, rng);
+            INSTRUMENT_PHASE_END(PHASE_UPDATE, events_start);
+        }
+        else
+            update_rabbits(sim, rng);
+        if (measure_phases)
+            results.update_time += omp_get_wtime() - update_start;
+
+        // Results without the rabbits or the events that did not fit would be silently wrong
+        stored &= (sim->lost_rabbits == 0);
+        if (!stored)
+        {
+            LOG_PRINT("Warning: The rabbit storage is full in month %d (%lld rabbits lost), the simulation stops\n",
+                      m, sim->lost_rabbits);
+            results.stop_reason = STOP_REASON_STORAGE;
+            break;
+        }
     }
 
+    free(log_survival);
+
     // Calculate final population counts
-    int final_alive = sim->rabbit_count - sim->free_count;
+    int final_alive = (int)count_alive_rabbits(sim);
     
     // Populate results structure with collected data
     results.total_dead = sim->dead_rabbit_count;
@@ -848,23 +2616,178 @@ s_simulation_results simulate(s_simulation_instance *sim, int months, int initia
     return results;
 }
 
+/**
+ * @brief Gets the name of a stop reason, as written in the summary file.
+ * @param reason The stop reason (stop_reason_t).
+ * @return A constant string naming the reason.
+ */
+const char *get_stop_reason_name(int reason)
+{
+    switch (reason)
+    {
+        case STOP_REASON_COMPLETED: return "completed";
+        case STOP_REASON_EXTINCTION: return "extinction";
+        case STOP_REASON_CEILING: return "ceiling";
+        case STOP_REASON_CONFIDENCE: return "confidence";
+        case STOP_REASON_LIMIT: return "limit";
+        case STOP_REASON_STORAGE: return "storage";
+        default: return "unknown";
+    }
+}
+
+/**
+ * @brief Applies simulation_schedule to the OpenMP runtime schedule used by multi_simulate.
+ * @return void
+ */
+static void apply_simulation_schedule(void)
+{
+    switch (simulation_schedule)
+    {
+        case SCHEDULE_STATIC:
+            omp_set_schedule(omp_sched_static, 0);
+            break;
+        case SCHEDULE_GUIDED:
+            omp_set_schedule(omp_sched_guided, 1);
+            break;
+        case SCHEDULE_DYNAMIC:
+        default:
+            omp_set_schedule(omp_sched_dynamic, 1);
+            break;
+    }
+}
+
+/**
+ * @brief Gets the display name of a storage growth policy.
+ * @param growth The growth policy.
+ * @return A constant string naming the policy.
+ */
+const char *get_storage_growth_name(storage_growth_t growth)
+{
+    switch (growth)
+    {
+        case GROWTH_REALLOC: return "Realloc";
+        case GROWTH_RESERVE: return "Reserved";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * @brief Gets the display name of a scheduling mode.
+ * @param schedule The scheduling mode.
+ * @return A constant string naming the mode.
+ */
+const char *get_simulation_schedule_name(simulation_schedule_t schedule)
+{
+    switch (schedule)
+    {
+        case SCHEDULE_STATIC: return "Static";
+        case SCHEDULE_DYNAMIC: return "Dynamic";
+        case SCHEDULE_GUIDED: return "Guided";
+        default: return "Unknown";
+    }
+}
+
+#if defined(ENABLE_INSTRUMENTATION) && ENABLE_INSTRUMENTATION != 0
+/**
+ * @brief Prints the hot path counters of a multi_simulate run in the results box, in total and per thread.
+ * @param thread_counters The counters of each thread.
+ * @param nb_threads The number of threads.
+ * @param rabbit_updates The rabbits updated by the run.
+ * @return void
+ */
+static void print_instrument_counters(const s_instrument_counters *thread_counters, int nb_threads,
+                                      long long rabbit_updates)
+{
+    s_instrument_counters total = {0};
+    for (int t = 0; t < nb_threads; ++t)
+        add_instrument_counters(&total, &thread_counters[t]);
+    uint64_t total_cycles = 0;
+    for (int p = 0; p < NB_INSTRUMENT_PHASES; ++p)
+        total_cycles += total.phase_cycles[p];
+
+    char line[128];
+    printf("╠════════════════════════════════════════════════════════════════════════╣\n");
+    printf("║ INSTRUMENTATION:                                                       ║\n");
+    snprintf(line, sizeof(line), "Storage Reallocations: %lld grows, %lld shrinks",
+             total.capacity_grows, total.capacity_shrinks);
+    printf("║   • %-66s ║\n", line);
+    snprintf(line, sizeof(line), "RNG Outputs: %lld (%.2f per rabbit update)", total.rng_outputs,
+             rabbit_updates > 0 ? (double)total.rng_outputs / rabbit_updates : 0.0);
+    printf("║   • %-66s ║\n", line);
+    snprintf(line, sizeof(line), "Most Slots Freed in One Month: %lld", total.max_free_slots);
+    printf("║   • %-66s ║\n", line);
+    snprintf(line, sizeof(line), "Cycles: %.4g", (double)total_cycles);
+    printf("║   • %-66s ║\n", line);
+    for (int p = 0; p < NB_INSTRUMENT_PHASES; ++p)
+    {
+        if (total.phase_cycles[p] == 0)
+            continue;
+        snprintf(line, sizeof(line), "%-10s %12.4g cycles (%5.1f%%)", get_instrument_phase_name(p),
+                 (double)total.phase_cycles[p], total.phase_cycles[p] * 100.0 / total_cycles);
+        printf("║     %-66s ║\n", line);
+    }
+    for (int t = 0; t < nb_threads; ++t)
+    {
+        const s_instrument_counters *c = &thread_counters[t];
+        uint64_t cycles = 0;
+        for (int p = 0; p < NB_INSTRUMENT_PHASES; ++p)
+            cycles += c->phase_cycles[p];
+        snprintf(line, sizeof(line), "Thread %d: %.4g cycles, %lld grows, %lld RNG outputs", t, (double)cycles,
+                 c->capacity_grows, c->rng_outputs);
+        printf("║     %-66s ║\n", line);
+    }
+}
+#endif
+
+/**
+ * @brief Lets the chunked update and the demes of a simulation (see deme.h) start their own threads inside
+ *        a simulation thread (the OpenMP default of one active level would run them with a single thread).
+ * @return void
+ */
+void allow_nested_simulation_threads(void)
+{
+    if ((update_threads > 0 || deme_count > 0) && omp_get_max_active_levels() < 2)
+        omp_set_max_active_levels(2);
+}
+
 /**
  * @brief Runs multiple simulations in parallel using OpenMP to calculate average population statistics.
- *        Each simulation runs independently with its own random number generator.
+ *        Each simulation runs independently with its own random number generator,
+ *        using the engine selected by simulation_engine.
+ *        The simulations are spread over simulation_threads threads following simulation_schedule,
+ *        and the time each thread spent simulating is reported to show the load balance.
  *        Aggregates results across all simulations and prints comprehensive statistics.
- *        Logs detailed monthly data for the first MAX_SIMULATIONS_TO_LOG simulations
- *        and creates a summary file with results from all simulations.
+ *        Logs detailed monthly data for the first simulations_to_log simulations,
+ *        creates a summary file with results from all simulations and, with ensemble_statistics,
+ *        a file of month by month statistics across all simulations (see ensemble.h).
+ *        With MPI, each process runs its own block of the simulations and logs the ones it runs, and rank 0
+ *        collects the totals, the results and the ensemble statistics, writes the other files and prints
+ *        (see cluster.h).
  * 
  * @param months The number of months for each simulation.
  * @param initial_population_nb The initial number of rabbits for each simulation.
  * @param nb_simulation The total number of simulations to run.
  * @param base_seed A base seed for the random number generators, combined with thread ID for uniqueness.
+ * @param survival The survival model of every simulation (copied into each simulation instance).
  * @return void
  */
-void multi_simulate(int months, int initial_population_nb, int nb_simulation, uint64_t base_seed)
+void multi_simulate(int months, int initial_population_nb, int nb_simulation, uint64_t base_seed,
+                    const s_survival_params *survival)
 {
-    // Set the number of threads to use for OpenMP
-    omp_set_num_threads(NUM_THREADS);
+    // Block of simulations of this process, all of them without MPI (see cluster.h)
+    int is_root = (cluster_rank() == 0);
+    int first_sim, end_sim;
+    cluster_share(nb_simulation, &first_sim, &end_sim);
+    int local_count = end_sim - first_sim;
+
+    // Set the number of threads to use for OpenMP, no more than the simulations so that the threads
+    // of the update and of the demes keep the cores the idle simulation threads would hold
+    int nb_threads = (simulation_threads > 0) ? simulation_threads : omp_get_num_procs();
+    if (nb_threads > local_count)
+        nb_threads = (local_count > 0) ? local_count : 1;
+    omp_set_num_threads(nb_threads);
+    apply_simulation_schedule();
+    allow_nested_simulation_threads();
     
     // Accumulators for averaging results across all simulations
     long long total_population = 0;
@@ -879,52 +2802,176 @@ void multi_simulate(int months, int initial_population_nb, int nb_simulation, ui
     long long total_avg_population_sum = 0;
     
     int nb_extinctions = 0;
-    int sims_done = 0;
+    int nb_ceiling_stops = 0;
+    int nb_confidence_stops = 0;
+    int nb_limit_stops = 0;
+    int nb_storage_stops = 0;
+    int nb_cohort_switches = 0;
+    long long total_months_simulated = 0;
+    long long total_rabbit_updates = 0;
+    double total_update_time = 0.0;
+    double total_record_time = 0.0;
     
+    // One reusable instance per thread, kept alive between simulations (see rewind_population)
+    s_simulation_instance *pool = reserve_simulation_pool(nb_threads);
+
+    // Time spent simulating and number of simulations run by each thread
+    double *thread_busy = calloc(nb_threads, sizeof(double));
+    int *thread_sims = calloc(nb_threads, sizeof(int));
+    #if defined(ENABLE_INSTRUMENTATION) && ENABLE_INSTRUMENTATION != 0
+    // Hot path counters of each thread, added up from the counters of its simulations
+    s_instrument_counters *thread_counters = calloc(nb_threads, sizeof(s_instrument_counters));
+    int counters_allocated = (thread_counters != NULL);
+    #else
+    int counters_allocated = 1;
+    #endif
+    if (!pool || !thread_busy || !thread_sims || !counters_allocated)
+    {
+        LOG_PRINT("Error: Could not allocate the simulation instances\n");
+        free(thread_busy);
+        free(thread_sims);
+        #if defined(ENABLE_INSTRUMENTATION) && ENABLE_INSTRUMENTATION != 0
+        free(thread_counters);
+        #endif
+        return;
+    }
+    double start_time = omp_get_wtime();
+    size_t initial_capacity = initial_rabbit_capacity(initial_population_nb);
+
     #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
-    // Allocate array to store results from all simulations for summary file
-    s_simulation_results *all_results = malloc(sizeof(s_simulation_results) * nb_simulation);
+    // Allocate array to store results from all simulations for summary file (rank 0), or from the block of this process.
+    // With a result store, rank 0 writes them straight into the mapped file instead (see result_store.h)
+    size_t results_count = is_root ? (size_t)nb_simulation : (size_t)(local_count > 0 ? local_count : 1);
+    s_result_store store = {0};
+    s_simulation_results *all_results = NULL;
+    if (is_root && result_store_path)
+    {
+        if (open_result_store(&store, result_store_path, nb_simulation, months, initial_population_nb, base_seed))
+            all_results = store.records;
+        else
+            LOG_PRINT("Warning: Could not create the result store %s, results are kept in memory\n", result_store_path);
+    }
     if (!all_results)
+        all_results = malloc(sizeof(s_simulation_results) * results_count);
+    if (!cluster_all(all_results != NULL))
     {
         LOG_PRINT("Warning: Could not allocate memory for results logging\n");
+        if (store.map)
+            close_result_store(&store);
+        else
+            free(all_results);
+        all_results = NULL;
+    }
+
+    // Monthly logs are handed to the log writer, see log_writer.h. Every process logs the simulations of
+    // its block below simulations_to_log, except into the single stream file, which only rank 0 can own
+    int sims_to_log = simulations_to_log;
+    if (log_single_stream && cluster_size() > 1)
+    {
+        if (!is_root)
+            sims_to_log = 0;
+        else if (end_sim < simulations_to_log)
+            LOG_PRINT("Warning: The monthly stream only holds the simulations of rank 0 (%d of %d logged)\n",
+                      local_count, simulations_to_log);
+    }
+    if (is_root || first_sim < sims_to_log)
+        start_log_writer(initial_population_nb);
+
+    // Month by month statistics of every simulation, one accumulator per thread merged at the end
+    s_ensemble *ensembles = ensemble_statistics ? calloc(nb_threads, sizeof(s_ensemble)) : NULL;
+    for (int t = 0; ensembles && t < nb_threads; ++t)
+    {
+        if (!init_ensemble(&ensembles[t], months))
+        {
+            LOG_PRINT("Warning: Could not allocate memory for the ensemble statistics\n");
+            for (int u = 0; u < t; ++u)
+                free_ensemble(&ensembles[u]);
+            free(ensembles);
+            ensembles = NULL;
+        }
+    }
+    if (ensemble_statistics && !cluster_all(ensembles != NULL) && ensembles)
+    {
+        for (int t = 0; t < nb_threads; ++t)
+            free_ensemble(&ensembles[t]);
+        free(ensembles);
+        ensembles = NULL;
     }
     #endif
 
-    LOG_PRINT("\n\r    Completed Simulations: %3d / %3d (%3.0f%%)", 0, nb_simulation, 0.0f);
+    // Rank 0 shows the progress of its own block, from the reporter thread (see progress.h)
+    if (is_root)
+    {
+        LOG_PRINT("\n\r    Completed Simulations: %3d / %3d (%3.0f%%)", 0, local_count, 0.0f);
+        fflush(stdout);
+        start_progress_reporter(local_count);
+    }
     
     // Parallel loop - each iteration runs one simulation on a separate thread
-    #pragma omp parallel for reduction(+ : total_population, total_dead_rabbits, total_extinction_month, nb_extinctions, total_males, total_females, total_peak_population, total_peak_month, total_min_population, total_min_month, total_avg_population_sum)
-    for (int i = 0; i < nb_simulation; i++)
+    #pragma omp parallel for schedule(runtime) reduction(+ : total_population, total_dead_rabbits, total_extinction_month, nb_extinctions, total_males, total_females, total_peak_population, total_peak_month, total_min_population, total_min_month, total_avg_population_sum, nb_ceiling_stops, nb_confidence_stops, nb_limit_stops, nb_storage_stops, nb_cohort_switches, total_months_simulated, total_rabbit_updates, total_update_time, total_record_time)
+    for (int i = first_sim; i < end_sim; i++)
     {
-        // Create independent simulation instance and RNG for this thread
-        s_simulation_instance sim_instance = {0};
-        pcg32_random_t rng;
+        // Reuse this thread's simulation instance and create an independent RNG
+        int thread_id = omp_get_thread_num();
+        double sim_start = omp_get_wtime();
+        s_simulation_instance *sim = &pool[thread_id];
+        prepare_simulation_instance(sim, initial_capacity, survival);
+        #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+        sim->ensemble = ensembles ? &ensembles[thread_id] : NULL;
+        #endif
+        pcg32x_random_t rng;
+
+        // Checkpoint file of this simulation, see checkpoint.h
+        s_checkpoint_target checkpoint;
+        if (checkpoint_interval > 0 || checkpoint_resume)
+        {
+            checkpoint_target_for(&checkpoint, base_seed, i + 1, months, initial_population_nb);
+            sim->checkpoint = &checkpoint;
+        }
         
-        // Seed RNG with base_seed combined with thread number for uniqueness
-        pcg32_srandom_r(&rng, base_seed, (uint64_t)i);
+        // Seed the lanes of the RNG with base_seed combined with the simulation number for uniqueness
+        pcg32x_srandom_r(&rng, base_seed, (uint64_t)i);
+        #if defined(ENABLE_INSTRUMENTATION) && ENABLE_INSTRUMENTATION != 0
+        instrument_counters = (s_instrument_counters){0};
+        #endif
         
         #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
         // Only log detailed monthly data for the first few simulations to avoid huge files
-        if (i < MAX_SIMULATIONS_TO_LOG)
+        if (i < sims_to_log)
         {
-            init_monthly_logging(&sim_instance, months);
+            init_monthly_logging(sim, months);
         }
         #endif
 
         // Run single simulation and get results
-        s_simulation_results results = simulate(&sim_instance, months, initial_population_nb, &rng);
+        s_simulation_results results = simulate(sim, months, initial_population_nb, &rng);
+        if (sim->checkpoint)
+        {
+            remove_checkpoint(sim->checkpoint);
+            sim->checkpoint = NULL;
+        }
         
         #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
-        // Store results for summary file
-        if (all_results)
+        // Hand the detailed log of this simulation to the log writer if it was being tracked
+        if (i < sims_to_log && sim->monthly_data)
         {
-            all_results[i] = results;
+            INSTRUMENT_PHASE_START(log_start);
+            submit_simulation_log(sim, i + 1, initial_population_nb);
+            INSTRUMENT_PHASE_END(PHASE_LOG, log_start);
         }
-        
-        // Write detailed log for this simulation if it was being tracked
-        if (i < MAX_SIMULATIONS_TO_LOG && sim_instance.monthly_data)
+        #endif
+
+        #if defined(ENABLE_INSTRUMENTATION) && ENABLE_INSTRUMENTATION != 0
+        results.counters = instrument_counters;
+        add_instrument_counters(&thread_counters[thread_id], &instrument_counters);
+        #endif
+
+        #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+        // Store results for summary file
+        if (all_results)
         {
-            write_simulation_log(&sim_instance, i + 1, initial_population_nb);
+            all_results[i - first_sim] = results;
+            mark_result_stored(&store, i, 1);
         }
         #endif
 
@@ -951,32 +2998,95 @@ void multi_simulate(int months, int initial_population_nb, int nb_simulation, ui
             nb_extinctions++;
         }
 
-        // Clean up memory for this simulation
-        reset_population(&sim_instance);
+        // Track early stops
+        nb_ceiling_stops += (results.stop_reason == STOP_REASON_CEILING);
+        nb_confidence_stops += (results.stop_reason == STOP_REASON_CONFIDENCE);
+        nb_limit_stops += (results.stop_reason == STOP_REASON_LIMIT);
+        nb_storage_stops += (results.stop_reason == STOP_REASON_STORAGE);
+        nb_cohort_switches += (results.cohort_switch_month > 0);
 
-        // Progress tracking (thread-safe increment)
-        #pragma omp atomic update
-        sims_done++;
+        // Throughput of the run
+        total_months_simulated += results.months_simulated;
+        total_rabbit_updates += results.rabbit_updates;
+        total_update_time += results.update_time;
+        total_record_time += results.record_time;
 
-        // Only master thread prints progress to avoid garbled output
-        int thread_id = omp_get_thread_num();
-        if (PRINT_OUTPUT && thread_id == 0)
-        {
-            float progress = (float)sims_done * 100.0f / nb_simulation;
-            LOG_PRINT("\r    Completed Simulations: %3d / %3d (%3.0f%%)", sims_done, nb_simulation, progress);
-            fflush(stdout);
-        }
+        // Each thread only writes its own slot
+        thread_busy[thread_id] += omp_get_wtime() - sim_start;
+        thread_sims[thread_id]++;
+
+        // Progress tracking, printed by the reporter thread
+        if (is_root)
+            report_simulation_done(&results);
     }
 
+    if (is_root)
+        stop_progress_reporter();
+
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    // Wait for the monthly logs still queued
+    s_log_writer_stats log_stats = {0};
+    if (is_root || first_sim < sims_to_log)
+        log_stats = stop_log_writer();
+    long long *const log_sums[] = { &log_stats.logs_written, &log_stats.queue_full_waits };
+    double *const log_times[] = { &log_stats.write_time };
+    cluster_sum_ll(log_sums, (int)(sizeof(log_sums) / sizeof(log_sums[0])));
+    cluster_sum_double(log_times, (int)(sizeof(log_times) / sizeof(log_times[0])));
+    #endif
+
+    // Add up the totals of every process on rank 0
+    long long *const total_sums[] = { &total_population, &total_dead_rabbits, &total_extinction_month, &total_males,
+                                      &total_females, &total_peak_population, &total_peak_month, &total_min_population,
+                                      &total_min_month, &total_avg_population_sum, &total_months_simulated,
+                                      &total_rabbit_updates };
+    int *const count_sums[] = { &nb_extinctions, &nb_ceiling_stops, &nb_confidence_stops, &nb_limit_stops,
+                                &nb_storage_stops, &nb_cohort_switches };
+    double *const time_sums[] = { &total_update_time, &total_record_time };
+    cluster_sum_ll(total_sums, (int)(sizeof(total_sums) / sizeof(total_sums[0])));
+    cluster_sum_int(count_sums, (int)(sizeof(count_sums) / sizeof(count_sums[0])));
+    cluster_sum_double(time_sums, (int)(sizeof(time_sums) / sizeof(time_sums[0])));
+
+    double elapsed_time = omp_get_wtime() - start_time;
+
     // Final progress update showing 100% completion
-    LOG_PRINT("\r    Completed Simulations: %3d / %3d (%3.0f%%)\n", nb_simulation, nb_simulation, 100.0f);
+    if (is_root)
+        LOG_PRINT("\r    Completed Simulations: %3d / %3d (%3.0f%%)\n", nb_simulation, nb_simulation, 100.0f);
     
     #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
     // Write summary file with all simulation results
     if (all_results)
     {
-        write_summary_log(months, initial_population_nb, nb_simulation, all_results, base_seed);
-        free(all_results);
+        cluster_gather_results(all_results, nb_simulation);
+        if (is_root)
+            write_summary_log(months, initial_population_nb, nb_simulation, all_results, base_seed);
+        if (store.map)
+        {
+            // The blocks of the other processes arrived with the gather
+            mark_result_stored(&store, 0, nb_simulation);
+            close_result_store(&store);
+        }
+        else
+            free(all_results);
+    }
+
+    // Merge the accumulators of the threads in thread order, then the ones of the processes in rank order,
+    // so a run always gives the same file
+    if (ensembles)
+    {
+        for (int t = 1; t < nb_threads; ++t)
+            merge_ensemble(&ensembles[0], &ensembles[t]);
+        cluster_merge_ensemble(&ensembles[0]);
+        if (is_root)
+        {
+            finish_ensemble(&ensembles[0]);
+            write_ensemble_log(&ensembles[0], initial_population_nb, nb_simulation);
+        }
+        for (int t = 0; t < nb_threads; ++t)
+        {
+            pool[t].ensemble = NULL;
+            free_ensemble(&ensembles[t]);
+        }
+        free(ensembles);
     }
     #endif
 
@@ -1009,6 +3119,40 @@ void multi_simulate(int months, int initial_population_nb, int nb_simulation, ui
         snprintf(extinction_str, sizeof(extinction_str), "%.2f (%.1f%% of simulations)", 
                  avg_extinction_month, extinction_rate);
 
+    // Load balance: the slowest thread against the average busy time
+    double total_busy = 0.0, max_busy = 0.0;
+    for (int t = 0; t < nb_threads; ++t)
+    {
+        total_busy += thread_busy[t];
+        if (thread_busy[t] > max_busy) max_busy = thread_busy[t];
+    }
+    int all_threads = nb_threads;
+    double *const busy_sums[] = { &total_busy };
+    int *const thread_sums[] = { &all_threads };
+    cluster_sum_double(busy_sums, 1);
+    cluster_sum_int(thread_sums, 1);
+    cluster_max_double(&max_busy);
+    double load_imbalance = total_busy > 0.0 ? max_busy * all_threads / total_busy : 1.0;
+
+    last_run_metrics = (s_run_metrics){ nb_threads, elapsed_time, total_busy, total_months_simulated,
+                                        total_rabbit_updates, total_update_time, total_record_time, 0.0, 0 };
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    last_run_metrics.log_write_time = log_stats.write_time;
+    last_run_metrics.logs_written = log_stats.logs_written;
+    #endif
+
+    // Rank 0 alone prints the results
+    if (!is_root)
+    {
+        #if defined(ENABLE_INSTRUMENTATION) && ENABLE_INSTRUMENTATION != 0
+        free(thread_counters);
+        #endif
+        free(thread_busy);
+        free(thread_sims);
+        return;
+    }
+    char line[128];
+
     // Print comprehensive results
     printf("\n\n"
            "╔════════════════════════════════════════════════════════════════════════╗\n");
@@ -1032,5 +3176,74 @@ void multi_simulate(int months, int initial_population_nb, int nb_simulation, ui
     printf("╠════════════════════════════════════════════════════════════════════════╣\n");
     printf("║ EXTINCTION ANALYSIS:                                                   ║\n");
     printf("║   • Average Extinction Month: %-35s      ║\n", extinction_str);
+    if (stop_mode == STOP_CEILING || stop_mode == STOP_SWITCH_TO_COHORT)
+    {
+        snprintf(line, sizeof(line), "Population Ceiling: %lld", population_ceiling);
+        printf("║   • %-66s ║\n", line);
+    }
+    if (stop_mode == STOP_CEILING)
+    {
+        snprintf(line, sizeof(line), "Stopped at the Ceiling: %d (%.1f%% of simulations)",
+                 nb_ceiling_stops, (float)nb_ceiling_stops * 100.0f / nb_simulation);
+        printf("║   • %-66s ║\n", line);
+    }
+    if (stop_mode == STOP_SWITCH_TO_COHORT)
+    {
+        snprintf(line, sizeof(line), "Switched to the Cohort Engine: %d (%.1f%% of simulations)",
+                 nb_cohort_switches, (float)nb_cohort_switches * 100.0f / nb_simulation);
+        printf("║   • %-66s ║\n", line);
+    }
+    if (stop_mode == STOP_CONFIDENCE)
+    {
+        snprintf(line, sizeof(line), "Stopped, Extinction Below %g: %d (%.1f%% of simulations)",
+                 extinction_confidence, nb_confidence_stops, (float)nb_confidence_stops * 100.0f / nb_simulation);
+        printf("║   • %-66s ║\n", line);
+    }
+    if (nb_limit_stops > 0)
+    {
+        snprintf(line, sizeof(line), "Stopped Before %d Rabbits: %d (%.1f%% of simulations)",
+                 INT_MAX, nb_limit_stops, (float)nb_limit_stops * 100.0f / nb_simulation);
+        printf("║   • %-66s ║\n", line);
+    }
+    if (nb_storage_stops > 0)
+    {
+        snprintf(line, sizeof(line), "Stopped, Rabbit Storage Full: %d (%.1f%% of simulations)",
+                 nb_storage_stops, (float)nb_storage_stops * 100.0f / nb_simulation);
+        printf("║   • %-66s ║\n", line);
+    }
+    printf("╠════════════════════════════════════════════════════════════════════════╣\n");
+    printf("║ PARALLEL EXECUTION:                                                    ║\n");
+    snprintf(line, sizeof(line), "Threads: %d (%s scheduling), Wall Time: %.3f s",
+             nb_threads, get_simulation_schedule_name(simulation_schedule), elapsed_time);
+    printf("║   • %-66s ║\n", line);
+    snprintf(line, sizeof(line), "Load Imbalance (slowest / average thread): %.2f", load_imbalance);
+    printf("║   • %-66s ║\n", line);
+    if (cluster_size() > 1)
+    {
+        snprintf(line, sizeof(line), "MPI Processes: %d, %d threads in all (rank 0 threads below)",
+                 cluster_size(), all_threads);
+        printf("║   • %-66s ║\n", line);
+    }
+    #if defined(ENABLE_DATA_LOGGING) && ENABLE_DATA_LOGGING != 0
+    if (log_stats.logs_written > 0)
+    {
+        snprintf(line, sizeof(line), "Log Writer: %lld logs written %s, %lld full queue waits",
+                 log_stats.logs_written, log_stats.background ? "in background" : "synchronously",
+                 log_stats.queue_full_waits);
+        printf("║   • %-66s ║\n", line);
+    }
+    #endif
+    for (int t = 0; t < nb_threads; ++t)
+    {
+        snprintf(line, sizeof(line), "Thread %d: %d simulations, %.3f s busy", t, thread_sims[t], thread_busy[t]);
+        printf("║     %-66s ║\n", line);
+    }
+    #if defined(ENABLE_INSTRUMENTATION) && ENABLE_INSTRUMENTATION != 0
+    print_instrument_counters(thread_counters, nb_threads, total_rabbit_updates);
+    free(thread_counters);
+    #endif
     printf("╚════════════════════════════════════════════════════════════════════════╝\n");
+
+    free(thread_busy);
+    free(thread_sims);
 }
\ No newline at end of file
@@ -12,25 +12,60 @@
 #include <math.h>       // For mathematical functions like exp, sqrt
 #include <omp.h>        // For OpenMP parallel programming directives
 #include "pcg_basic.h"  // Include the PCG (Permuted Congruential Generator) library header for random numbers
+#include "pcg_batch.h"  // Multi-stream buffered PCG used by the simulation hot loop
+#include "instrument.h" // Hot path counters and cycle timers (ENABLE_INSTRUMENTATION)
+#include "age_histogram.h" // Age structure of the logged simulations
 #include <math.h>       // For math functions
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-// Define initial capacity for rabbit array to avoid frequent reallocations
+// Define initial capacity for rabbit array to avoid frequent reallocations.
+// The array starts at INIT_CAPACITY_FACTOR times the initial population, kept between
+// MIN_RABBIT_CAPACITY and INIT_RABIT_CAPACITY (see initial_rabbit_capacity).
 #define INIT_RABIT_CAPACITY 1000000 
+#define MIN_RABBIT_CAPACITY 4096
+#define INIT_CAPACITY_FACTOR 16
 
-// Number of CPU cores to use for parallel simulations
+// The rabbit array is shrunk once the living population falls below 1/RABBIT_SHRINK_FACTOR of its capacity
+#define RABBIT_SHRINK_FACTOR 4
+
+// Rabbits per simulation instance the reserved storage can hold (see storage_growth)
+#define DEFAULT_RESERVED_RABBITS (1u << 28)
+
+// Default number of CPU cores to use for parallel simulations (see simulation_threads)
 // NOTE : reducing nummber of simulations running on the same time reduces memory bottleneck
 #define NUM_THREADS 1
 
+// Number of rabbits per chunk in the two-phase parallel update of a single simulation.
+// Chunks (and their RNG streams) do not depend on the thread count, which keeps results reproducible.
+#ifndef UPDATE_CHUNK_SIZE
+#define UPDATE_CHUNK_SIZE 65536
+#endif
+
+// Forces the inlining of the generic update loops into their specialised versions
+#if defined(__GNUC__)
+#define RABBIT_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define RABBIT_ALWAYS_INLINE inline
+#endif
+
 // Survival rates for rabbits at different life stages. These values are crucial
 // for the long-term stability or extinction of the simulated population.
 // For example, (75.6, 94.6) might lead to a stable population for a period
 // but eventually extinction over a very long time.
 #define INIT_SRV_RATE 91.63f  // Initial survival rate for newborn rabbits
 #define ADULT_SRV_RATE 95.83f // Survival rate for adult rabbits
+#define SUPER_SRV_RATE 100.0f // Survival rate of the two "super" rabbits
+
+// Default values of the other survival parameters (see s_survival_params)
+#define GAUSSIAN_SRV_SIGMA 2.5      // Standard deviation of the Gaussian method
+#define EXPONENTIAL_SRV_SCALE 2.0   // Divisor of the exponential method's lambda (variance control)
+#define EXPONENTIAL_SRV_SPREAD 0.3  // Weight of the exponential factor (keeps the variation within ~30%)
+#define SRV_PENALTY_AGE 120         // Age in months from which old rabbits lose survival rate
+#define SRV_PENALTY_PER_YEAR 10.0f  // Survival rate lost per full year past SRV_PENALTY_AGE
+#define SRV_PENALTY_MIN_AGE 20      // Smallest penalty age: every rabbit is mature and past its starting age by then
 
 // Survival calculation methods
 typedef enum {
@@ -39,8 +74,91 @@ typedef enum {
     SURVIVAL_EXPONENTIAL // Exponential distribution
 } survival_method_t;
 
-// Global variable to define survival calculation method
-extern survival_method_t survival_method;
+// Survival model of one simulation. Each simulation instance holds its own copy,
+// so simulations with different methods or rates can run at the same time.
+typedef struct {
+    survival_method_t method;    // Survival calculation method
+    float init_rate;             // Survival rate of immature rabbits
+    float adult_rate;            // Survival rate of mature rabbits
+    double gaussian_sigma;       // Standard deviation of the Gaussian method
+    double exponential_scale;    // Divisor of lambda in the exponential method
+    double exponential_spread;   // Weight of the exponential factor in the exponential method
+    int penalty_age;             // Age in months from which the old age penalty applies (at least SRV_PENALTY_MIN_AGE)
+    float penalty_per_year;      // Survival rate lost per full year past penalty_age
+} s_survival_params;
+
+// Simulation engines
+typedef enum {
+    ENGINE_INDIVIDUAL,  // One record per rabbit, every rabbit updated each month (default)
+    ENGINE_COHORT,      // Identical rabbits grouped in cohorts, updated with binomial draws
+    ENGINE_EVENT        // Only the scheduled events of each month are processed (static method), see event.h
+} simulation_engine_t;
+
+// Global variable to define the engine used by multi_simulate
+extern simulation_engine_t simulation_engine;
+
+// Early stop conditions of simulate, on top of extinction.
+// Extinction studies do not need to follow a population that can no longer die out,
+// and that is where exploding runs spend all their CPU time and memory.
+typedef enum {
+    STOP_NONE,              // Run every month unless the population dies out (default)
+    STOP_CEILING,           // Stop once the population reaches population_ceiling
+    STOP_SWITCH_TO_COHORT,  // Move the rabbits to the cohort engine once they reach population_ceiling
+    STOP_CONFIDENCE         // Stop once extinction before the last month is less likely than extinction_confidence
+} stop_mode_t;
+
+// Reason why a simulation stopped, stored in s_simulation_results
+typedef enum {
+    STOP_REASON_COMPLETED,  // Every requested month was simulated
+    STOP_REASON_EXTINCTION, // The population died out
+    STOP_REASON_CEILING,    // The population reached population_ceiling (STOP_CEILING)
+    STOP_REASON_CONFIDENCE, // Extinction became too unlikely (STOP_CONFIDENCE)
+    STOP_REASON_LIMIT,      // The next update could take a count past INT_MAX (the counts of the results are 32-bit)
+    STOP_REASON_STORAGE     // Rabbits of the last update could not be stored (see lost_rabbits)
+} stop_reason_t;
+
+// Most kittens of one litter (3 to 6), bounds the births of an update for STOP_REASON_LIMIT
+#define MAX_LITTER_SIZE 6
+
+#define DEFAULT_POPULATION_CEILING 10000000LL
+#define DEFAULT_EXTINCTION_CONFIDENCE 1e-9
+
+// Global variables for the stop conditions used by multi_simulate
+extern stop_mode_t stop_mode;
+extern long long population_ceiling;
+extern double extinction_confidence;
+
+// Scheduling of the simulations of multi_simulate over its threads.
+// Simulation costs differ by orders of magnitude (early extinctions vs explosions), so the
+// simulations are handed out one at a time by default. Results never depend on the schedule.
+typedef enum {
+    SCHEDULE_STATIC,    // Contiguous blocks of simulations per thread
+    SCHEDULE_DYNAMIC,   // Each thread takes the next simulation when it is done (default)
+    SCHEDULE_GUIDED     // Blocks that get smaller towards the end of the run
+} simulation_schedule_t;
+
+extern simulation_schedule_t simulation_schedule;
+
+// Number of threads running simulations in parallel in multi_simulate (0 for all available cores)
+extern int simulation_threads;
+
+// How the rabbit storage grows.
+// With realloc a growth step briefly needs the old and the new array and may copy the whole population.
+// The reserve policy maps reserved_rabbits slots of address space per array once, without any memory
+// behind them; growing only makes more pages usable and shrinking gives pages back to the system,
+// so the rabbits are never moved and memory follows the population. Results never depend on the policy.
+typedef enum {
+    GROWTH_REALLOC,     // Heap arrays resized with realloc (default)
+    GROWTH_RESERVE      // Reserved address space committed in place
+} storage_growth_t;
+
+extern storage_growth_t storage_growth;
+extern size_t reserved_rabbits;
+
+// Global variable to define the number of threads updating a single simulation.
+// 0 keeps the serial update, N >= 1 uses the chunked two-phase update on N threads
+// (results for a given seed are the same for every N >= 1).
+extern int update_threads;
 
 // Macro to control output printing. If PRINT_OUTPUT is non-zero, logs will be printed.
 #define PRINT_OUTPUT 1
@@ -48,14 +166,58 @@ extern survival_method_t survival_method;
 // Macro to control data logging to files
 #define ENABLE_DATA_LOGGING 1
 
-// Maximum number of simulations to log detailed monthly data (to avoid huge files)
+// Default number of simulations to log detailed monthly data (to avoid huge files)
 #define MAX_SIMULATIONS_TO_LOG 3
 
+// Global variable for the number of simulations whose monthly data is logged (MAX_SIMULATIONS_TO_LOG by default)
+extern int simulations_to_log;
+
+// Global variable to write the age structure of every month of the logged simulations (1 by default),
+// one "age_structure_<n>_pop<p>" file per simulation next to its monthly log
+extern int age_structure_log;
+
+// Global variable prepended to the names of the log files ("" by default)
+extern const char *log_file_prefix;
+
+// Format of the monthly and summary log files
+typedef enum {
+    LOG_FORMAT_CSV,     // One text line per row (default)
+    LOG_FORMAT_BINARY   // Binary columnar file written in one go, see write_binary_log
+} log_format_t;
+
+extern log_format_t log_format;
+
+// Global variable to time the phases of every simulation (set by the benchmark, see "make bench")
+extern int measure_phases;
+
+// Binary columnar log files (".rlog"), all values little-endian:
+//   header   BINARY_LOG_HEADER_SIZE bytes: magic "RABBITLG", version, kind, number of columns and rows,
+//            months, initial population, base seed, simulation number (monthly) or number of simulations (summary)
+//   columns  one BINARY_LOG_COLUMN_SIZE descriptor per column: NUL padded name and type
+//   data     each column in turn, nb_rows 4-byte values, so a column can be memory-mapped as one array
+#define BINARY_LOG_MAGIC "RABBITLG"
+#define BINARY_LOG_VERSION 1
+#define BINARY_LOG_HEADER_SIZE 48
+#define BINARY_LOG_COLUMN_SIZE 32
+#define BINARY_LOG_NAME_SIZE 28
+
+typedef enum {
+    BINARY_LOG_MONTHLY,         // Monthly statistics of one simulation
+    BINARY_LOG_SUMMARY,         // Results of every simulation
+    BINARY_LOG_AGES             // Age structure of every month of one simulation
+} binary_log_kind_t;
+
+typedef enum {
+    BINARY_LOG_INT32,
+    BINARY_LOG_FLOAT32
+} binary_log_type_t;
+
 // Conditional compilation for logging messages.
-// If PRINT_OUTPUT is enabled, LOG_PRINT will call printf and fflush.
+// If PRINT_OUTPUT is enabled, LOG_PRINT will call printf (stdout is flushed by whoever needs it shown right away,
+// like the progress reporter, so that messages from the hot paths do not cost a system call each).
 // Otherwise, it will expand to an empty operation, effectively removing log calls from the compiled code.
 #if defined(PRINT_OUTPUT) && PRINT_OUTPUT != 0
-    #define LOG_PRINT(format, ...) do { printf(format, ##__VA_ARGS__); fflush(stdout); } while (0)
+    #define LOG_PRINT(format, ...) do { printf(format, ##__VA_ARGS__); } while (0)
 #else
     #define LOG_PRINT(format, ...) do { } while (0)
 #endif
@@ -74,6 +236,64 @@ typedef struct rabbit {
     int survival_check_flag;     // Flag to indicate if survival has already been checked this month (1 for checked, 0 for not) // Not used currently since i check each month instead of each year so maybe i should remove it later and update the comment related to it
 } s_rabbit; // Alias for the rabbit structure
 
+// Storage backend for the rabbit population.
+// 0 keeps the array of s_rabbit structures above (40 bytes per rabbit).
+// 1 stores every field in its own packed column (12 bytes per rabbit, 8 with the static method), so the monthly
+// update only streams through the bytes it actually needs. Select it with "make STORAGE=soa".
+#ifndef RABBIT_STORAGE_SOA
+#define RABBIT_STORAGE_SOA 0
+#endif
+
+// Bit positions of the boolean fields packed together in the "flags" column
+#define RABBIT_BIT_sex                  0
+#define RABBIT_BIT_status               1
+#define RABBIT_BIT_mature               2
+#define RABBIT_BIT_pregnant             3
+#define RABBIT_BIT_survival_check_flag  4
+
+// Column storage used when RABBIT_STORAGE_SOA is enabled, one array entry per rabbit.
+// Ages are kept on 16 bits so long simulations cannot overflow them.
+typedef struct {
+    uint16_t *age;               // Age in months
+    uint16_t *maturity_age;      // The age at which the rabbit became mature
+    uint8_t *flags;              // sex, status, mature, pregnant and survival_check_flag bits
+    uint8_t *nb_litters_y;       // Number of litters a female can have per year
+    uint8_t *nb_litters;         // Number of litters a female has had in the current year
+    float *survival_rate;        // Probability of survival for the current month (not allocated for the static method)
+} s_rabbit_columns;
+
+// Field accessors shared by both storage backends.
+// RABBIT_FIELD gives an lvalue for the numeric fields (age, maturity_age, nb_litters_y, nb_litters, survival_rate),
+// RABBIT_FLAG / RABBIT_SET_FLAG read and write the boolean ones (sex, status, mature, pregnant, survival_check_flag),
+// RABBIT_MOVE copies a whole rabbit from one slot to another, RABBIT_MOVE_NO_RATE all of it but its survival rate.
+#if RABBIT_STORAGE_SOA
+    #define RABBIT_FIELD(sim, i, field) ((sim)->columns.field[(i)])
+    #define RABBIT_FLAG(sim, i, flag) (((sim)->columns.flags[(i)] >> RABBIT_BIT_##flag) & 1)
+    #define RABBIT_SET_FLAG(sim, i, flag, value) \
+        ((sim)->columns.flags[(i)] = (uint8_t)(((sim)->columns.flags[(i)] & ~(1u << RABBIT_BIT_##flag)) | ((unsigned)((value) != 0) << RABBIT_BIT_##flag)))
+    #define RABBIT_MOVE(sim, dst, src) do { \
+        (sim)->columns.age[(dst)] = (sim)->columns.age[(src)]; \
+        (sim)->columns.maturity_age[(dst)] = (sim)->columns.maturity_age[(src)]; \
+        (sim)->columns.flags[(dst)] = (sim)->columns.flags[(src)]; \
+        (sim)->columns.nb_litters_y[(dst)] = (sim)->columns.nb_litters_y[(src)]; \
+        (sim)->columns.nb_litters[(dst)] = (sim)->columns.nb_litters[(src)]; \
+        (sim)->columns.survival_rate[(dst)] = (sim)->columns.survival_rate[(src)]; \
+    } while (0)
+    #define RABBIT_MOVE_NO_RATE(sim, dst, src) do { \
+        (sim)->columns.age[(dst)] = (sim)->columns.age[(src)]; \
+        (sim)->columns.maturity_age[(dst)] = (sim)->columns.maturity_age[(src)]; \
+        (sim)->columns.flags[(dst)] = (sim)->columns.flags[(src)]; \
+        (sim)->columns.nb_litters_y[(dst)] = (sim)->columns.nb_litters_y[(src)]; \
+        (sim)->columns.nb_litters[(dst)] = (sim)->columns.nb_litters[(src)]; \
+    } while (0)
+#else
+    #define RABBIT_FIELD(sim, i, field) ((sim)->rabbits[(i)].field)
+    #define RABBIT_FLAG(sim, i, flag) ((sim)->rabbits[(i)].flag)
+    #define RABBIT_SET_FLAG(sim, i, flag, value) ((sim)->rabbits[(i)].flag = (value))
+    #define RABBIT_MOVE(sim, dst, src) ((sim)->rabbits[(dst)] = (sim)->rabbits[(src)])
+    #define RABBIT_MOVE_NO_RATE(sim, dst, src) RABBIT_MOVE(sim, dst, src)
+#endif
+
 // Structure to store monthly statistics for a single simulation
 typedef struct {
     int month;                   // Month number
@@ -89,22 +309,97 @@ typedef struct {
     int max_age;                 // Maximum age of living rabbits
 } s_monthly_stats;
 
-// Structure representing a single simulation instance.
+// Monthly statistics of one finished simulation, as handed to the log writers
+typedef struct {
+    s_monthly_stats *data;       // Recorded months
+    int count;                   // Number of recorded months
+    int months;                  // Months requested
+    int sim_number;              // Simulation number (from 1)
+    int initial_population;      // Initial population size
+    s_age_row *age_rows;         // Age structure of the recorded months (NULL for none)
+    size_t age_row_count;        // Number of age rows
+} s_monthly_log;
+
+// Statistics of the living rabbits that the age histogram does not hold, kept up to date by the update pass
+// so that record_monthly_stats does not have to scan the rabbits array again.
 typedef struct {
+    int pregnant_females;        // Number of pregnant females
+} s_population_stats;
+
+// Progress of the monthly loop of simulate, everything besides the instance and the generator
+// that a checkpoint needs to continue the simulation (see checkpoint.h)
+typedef struct {
+    int month;                   // Next month to simulate
+    int peak_population;         // Maximum living population so far
+    int peak_month;              // Month of the maximum
+    int min_population;          // Minimum living population so far (INT32_MAX before month 1)
+    int min_month;               // Month of the minimum
+    int actual_months;           // Months simulated so far
+    long long population_sum;    // Sum of the population over the months simulated
+    int cohort_switch_month;     // Month when the rabbits were moved to the cohort engine (0 if never)
+    long long rabbit_updates;    // Rabbits updated so far
+} s_simulation_progress;
+
+struct simulation_instance;
+
+// Update loop of the rabbits array, one per survival method and with or without the statistics of the
+// monthly logs, generated from update_rabbit_range_with and chosen once per simulation (see select_update_kernel)
+typedef int (*rabbit_update_kernel_t)(struct simulation_instance *sim, pcg32x_random_t *rng);
+
+// Structure representing a single simulation instance.
+typedef struct simulation_instance {
+#if RABBIT_STORAGE_SOA
+    s_rabbit_columns columns;    // One dynamically allocated column per rabbit field
+#else
     s_rabbit *rabbits;           // Pointer to a dynamically allocated array of rabbits
-    size_t rabbit_count;         // Current number of rabbits in the array (both alive and dead but still in array)
+#endif
+    size_t rabbit_count;         // Current number of rabbits in the array (living rabbits are packed at the front)
     size_t dead_rabbit_count;    // Total number of rabbits that have died throughout the simulation
     size_t rabbit_capacity;      // Current allocated capacity for the rabbits array
-    int *free_indices;           // Array of indices of "dead" rabbit slots that can be reused
-    size_t free_count;           // Number of available free slots
-    int sex_distribution[2];     // Distribution of the males and the females
+    size_t free_count;           // Number of rabbits killed this month whose slot is not compacted yet
+    size_t initial_capacity;     // Capacity allocated first, and never shrunk below (0 for INIT_RABIT_CAPACITY)
+    size_t rabbit_reserved;      // Slots of address space reserved per array (0 for heap arrays, see storage_growth)
+    long long lost_rabbits;      // Rabbits of this run that the storage could not hold (the run stops with them)
+    int sex_distribution[2];     // Living females (0) and males (1)
     
     // Logging-related fields
-    s_monthly_stats *monthly_data;  // Array to store monthly statistics
-    int monthly_data_capacity;      // Allocated capacity for monthly_data
+    s_monthly_stats *monthly_data;  // Array to store monthly statistics (kept between runs of a pooled instance)
+    int monthly_data_allocated;     // Allocated length of monthly_data
+    int monthly_data_capacity;      // Months that can be recorded in the current run (0 when it is not logged)
     int monthly_data_count;         // Number of months recorded
     int deaths_this_month;          // Track deaths for current month
     int births_this_month;          // Track births for current month
+    s_population_stats stats;       // Statistics of the living rabbits (individual engine)
+    s_age_histogram ages;           // Age structure of the living rabbits (logged runs only, rows is 0 otherwise)
+    s_age_row *age_rows;            // Age structure of the recorded months (kept between runs of a pooled instance)
+    size_t age_row_count;           // Number of age rows recorded
+    size_t age_rows_allocated;      // Allocated length of age_rows
+    struct ensemble *ensemble;      // Accumulator fed every month of the run (NULL for none), see ensemble.h
+    struct checkpoint_target *checkpoint;  // Checkpoint file of the run (NULL for none), see checkpoint.h
+
+    // Cohort engine fields (only used when engine is ENGINE_COHORT)
+    simulation_engine_t engine;     // Engine used to update this simulation
+    rabbit_update_kernel_t update_kernel;  // Update loop of the individual engine (NULL until select_update_kernel)
+    int update_threads;             // Threads of the chunked update (0 for the serial update)
+    int deme_count;                 // Demes the individual engine splits the population into (0 for none), see deme.h
+    struct cohort *cohorts;         // Array of cohorts, see cohort.h
+    size_t cohort_count;            // Number of cohorts in the array
+    size_t cohort_capacity;         // Allocated capacity for the cohorts array
+    long long cohort_alive;         // Living rabbits across all cohorts
+    struct event_engine *events;    // Calendar queue and rabbits of the event engine (ENGINE_EVENT), see event.h
+    struct deme_set *demes;         // Sub-populations of a split simulation (NULL before the first split), see deme.h
+
+    s_survival_params survival;     // Survival model of this simulation
+    float founder_rate;             // Survival rate given to the initial population (adult_rate or SUPER_SRV_RATE)
+
+    // Survival thresholds of the static method, see build_static_survival_table
+    uint32_t *static_thresholds;    // Two rows (born in the simulation, initial population) of static_table_ages entries
+    size_t static_table_ages;       // Entries per row, older rabbits use the last one
+    size_t static_table_allocated;  // Allocated length of static_thresholds
+    s_survival_params static_table_params;  // Survival model the table was built for (reused by the next run if unchanged)
+    float static_table_founder_rate;        // Founder rate the table was built for
+    stop_mode_t stop_mode;          // Early stop condition of this simulation
+    long long last_births;          // Rabbits born during the last update (used by STOP_CONFIDENCE)
 } s_simulation_instance; // Alias for the simulation instance structure
 
 /**
@@ -128,54 +423,111 @@ typedef struct {
     int months_simulated;        // Actual number of months simulated (may be less than requested if extinction)
     float male_percentage;       // Percentage of males in final population
     float female_percentage;     // Percentage of females in final population
+    int stop_reason;             // Why the simulation stopped (stop_reason_t)
+    int cohort_switch_month;     // Month when the rabbits were moved to the cohort engine (0 if never)
+    long long rabbit_updates;    // Rabbits updated, summed over the months (population before each update)
+    double update_time;          // Seconds spent in update_rabbits / update_cohorts (with measure_phases)
+    double record_time;          // Seconds spent in record_monthly_stats (with measure_phases)
+#if defined(ENABLE_INSTRUMENTATION) && ENABLE_INSTRUMENTATION != 0
+    s_instrument_counters counters; // Hot path counters of this simulation
+#endif
 } s_simulation_results;
 
+// Throughput and time per phase of the last multi_simulate run
+typedef struct {
+    int nb_threads;              // Threads running simulations
+    double elapsed;              // Wall time of the run in seconds
+    double busy_time;            // Seconds spent simulating, summed over the threads
+    long long months_simulated;  // Months simulated, summed over the simulations
+    long long rabbit_updates;    // Rabbits updated, summed over the simulations
+    double update_time;          // Seconds in update_rabbits / update_cohorts, summed over the threads (with measure_phases)
+    double record_time;          // Seconds in record_monthly_stats, summed over the threads (with measure_phases)
+    double log_write_time;       // Seconds spent writing the monthly logs
+    long long logs_written;      // Monthly logs written
+} s_run_metrics;
+
+extern s_run_metrics last_run_metrics;
+
 
 //   > Function Prototypes <
 // Declarations for all functions used in the rabbit simulation.
-// Many functions now include a 'pcg32_random_t* rng' parameter
+// Many functions now include a 'pcg32x_random_t* rng' parameter
 // to pass the random number generator state explicitly,
 // allowing for thread-safe and reproducible simulations.
+// The generator is the buffered multi-stream PCG of pcg_batch.h,
+// seeded once per simulation from (base_seed, simulation index).
 
 int fibonacci(int n);
-double genrand_real(pcg32_random_t* rng);
+double genrand_real(pcg32x_random_t* rng);
 
 int ensure_capacity(s_simulation_instance *sim);
-void add_rabbit(s_simulation_instance *sim, pcg32_random_t* rng, int is_mature, float init_srv_rate, int age, int sex);
-void init_2_super_rabbits(s_simulation_instance *sim, pcg32_random_t* rng);
-void init_starting_population(s_simulation_instance *sim, int nb_rabbits, pcg32_random_t* rng);
+int reserve_rabbits(s_simulation_instance *sim, size_t count);
+void prepare_survival_storage(s_simulation_instance *sim);
+int append_rabbits(s_simulation_instance *dst, const s_simulation_instance *src, size_t first, size_t count);
+void refresh_population_stats(s_simulation_instance *sim);
+void shrink_capacity(s_simulation_instance *sim);
+void add_rabbit(s_simulation_instance *sim, pcg32x_random_t* rng, int is_mature, float init_srv_rate, int age, int sex);
+void init_2_super_rabbits(s_simulation_instance *sim, pcg32x_random_t* rng);
+void init_starting_population(s_simulation_instance *sim, int nb_rabbits, pcg32x_random_t* rng);
 void reset_population(s_simulation_instance *sim);
+void rewind_population(s_simulation_instance *sim);
+size_t initial_rabbit_capacity(int initial_population_nb);
+s_simulation_instance *reserve_simulation_pool(int nb_instances);
+void prepare_simulation_instance(s_simulation_instance *sim, size_t initial_capacity, const s_survival_params *survival);
+void free_simulation_pool(void);
+
+int generate_sex(pcg32x_random_t* rng);
+int generate_random_age(pcg32x_random_t *rng);
+int check_maturity(int age, pcg32x_random_t* rng);
+void update_maturity(s_simulation_instance *sim, size_t i, pcg32x_random_t* rng);
 
-int generate_sex(pcg32_random_t* rng);
-int generate_random_age(pcg32_random_t *rng);
-int check_maturity(int age, pcg32_random_t* rng);
-void update_maturity(s_simulation_instance *sim, size_t i, pcg32_random_t* rng);
+long long count_alive_rabbits(const s_simulation_instance *sim);
 
-int check_survival_rate(s_simulation_instance *sim, size_t i, pcg32_random_t *rng);
+int check_survival_rate(s_simulation_instance *sim, size_t i, pcg32x_random_t *rng);
 void kill_rabbit(s_simulation_instance *sim, size_t i);
-void check_survival(s_simulation_instance *sim, size_t i, pcg32_random_t* rng);
-void update_survival_rate(s_simulation_instance *sim, size_t i, pcg32_random_t *rng);
+void check_survival(s_simulation_instance *sim, size_t i, pcg32x_random_t* rng);
+void update_survival_rate(s_simulation_instance *sim, size_t i, pcg32x_random_t *rng);
 
+s_survival_params default_survival_params(void);
 float calculate_base_survival_rate(s_simulation_instance *sim, size_t i);
+float calculate_base_survival_rate_for(const s_survival_params *params, int mature, int age);
 float calculate_survival_rate_static(float base_rate);
-float calculate_survival_rate_gaussian(float base_rate, pcg32_random_t *rng);
-float calculate_survival_rate_exponential(float base_rate, pcg32_random_t *rng);
+float calculate_survival_rate_gaussian(const s_survival_params *params, float base_rate, pcg32x_random_t *rng);
+float calculate_survival_rate_exponential(const s_survival_params *params, float base_rate, pcg32x_random_t *rng);
+double exponential_inverse_lambda(const s_survival_params *params, float base_rate);
+float calculate_survival_rate_exponential_with(const s_survival_params *params, float base_rate, double inverse_lambda,
+                                               pcg32x_random_t *rng);
+float draw_survival_rate(const s_survival_params *params, float base_rate, pcg32x_random_t *rng);
+float static_survival_rate(const s_survival_params *params, float creation_rate, int age);
+uint32_t survival_threshold(float rate);
+int build_static_survival_table(s_simulation_instance *sim, float founder_rate);
 
-int generate_litters_per_year(pcg32_random_t* rng);
-void update_litters_per_year(s_simulation_instance *sim, size_t i, pcg32_random_t* rng);
-int can_be_pregnant_this_month(s_simulation_instance *sim, size_t i, pcg32_random_t* rng);
-int give_birth(s_simulation_instance *sim, size_t i, pcg32_random_t* rng);
-void check_pregnancy(s_simulation_instance *sim, size_t i, pcg32_random_t* rng);
-void create_new_generation(s_simulation_instance *sim, int nb_new_born, pcg32_random_t* rng);
+int generate_litters_per_year(pcg32x_random_t* rng);
+void update_litters_per_year(s_simulation_instance *sim, size_t i, pcg32x_random_t* rng);
+int can_be_pregnant_this_month(s_simulation_instance *sim, size_t i, pcg32x_random_t* rng);
+int give_birth(s_simulation_instance *sim, size_t i, pcg32x_random_t* rng);
+void check_pregnancy(s_simulation_instance *sim, size_t i, pcg32x_random_t* rng);
+void create_new_generation(s_simulation_instance *sim, int nb_new_born, pcg32x_random_t* rng);
 
-void update_rabbits(s_simulation_instance *sim, pcg32_random_t* rng);
-s_simulation_results simulate(s_simulation_instance *sim, int months, int initial_population_nb, pcg32_random_t* rng);
-void multi_simulate(int months, int initial_population_nb, int nb_simulation, uint64_t base_seed);
+void select_update_kernel(s_simulation_instance *sim);
+int update_rabbit_range(s_simulation_instance *sim, pcg32x_random_t* rng);
+void update_rabbits(s_simulation_instance *sim, pcg32x_random_t* rng);
+void update_rabbits_chunked(s_simulation_instance *sim, pcg32x_random_t* rng);
+s_simulation_results simulate(s_simulation_instance *sim, int months, int initial_population_nb, pcg32x_random_t* rng);
+const char *get_simulation_schedule_name(simulation_schedule_t schedule);
+const char *get_storage_growth_name(storage_growth_t growth);
+const char *get_stop_reason_name(int reason);
+void allow_nested_simulation_threads(void);
+void multi_simulate(int months, int initial_population_nb, int nb_simulation, uint64_t base_seed,
+                    const s_survival_params *survival);
 
 // Logging function prototypes
 void init_monthly_logging(s_simulation_instance *sim, int months);
 void record_monthly_stats(s_simulation_instance *sim, int month, int alive_count, int males, int females);
 void write_simulation_log(s_simulation_instance *sim, int sim_number, int initial_population);
+void write_monthly_log(const s_monthly_log *log);
+FILE *open_monthly_log_stream(int initial_population);
+void append_monthly_log(FILE *fp, const s_monthly_log *log);
 void write_summary_log(int months, int initial_population, int nb_simulations, 
                        s_simulation_results *all_results, uint64_t base_seed);
 
@@ -0,0 +1,156 @@
+#include "replay.h"
+#include "checkpoint.h"
+#include "cluster.h"
+
+#include <ctype.h>
+
+// Global variable for the simulations to replay, see replay.h
+const char *replay_list = NULL;
+
+/**
+ * @brief Parses a list of simulation numbers: numbers and ranges separated by commas ("3,40-45").
+ * @param text The list.
+ * @param nb_simulation The number of simulations of the run (the numbers go from 1 to it).
+ * @param numbers Receives the simulation numbers, in the order of the list (to free).
+ * @return The number of simulations, 0 if the list is invalid or empty (nothing to free then).
+ */
+static int parse_replay_list(const char *text, int nb_simulation, int **numbers)
+{
+    int count = 0, allocated = 0;
+    int *list = NULL;
+    const char *p = text;
+
+    while (*p)
+    {
+        char *end;
+        long first = strtol(p, &end, 10);
+        long last = first;
+        if (end == p)
+            break;
+        p = end;
+        if (*p == '-')
+        {
+            last = strtol(p + 1, &end, 10);
+            if (end == p + 1)
+                break;
+            p = end;
+        }
+        if (first < 1 || last < first || last > nb_simulation)
+            break;
+
+        for (long n = first; n <= last; ++n)
+        {
+            if (count == allocated)
+            {
+                allocated = allocated ? allocated * 2 : 16;
+                int *temp = realloc(list, sizeof(int) * allocated);
+                if (!temp)
+                {
+                    free(list);
+                    return 0;
+                }
+                list = temp;
+            }
+            list[count++] = (int)n;
+        }
+
+        if (*p == ',')
+            p++;
+        else if (*p && !isspace((unsigned char)*p))
+            break;
+    }
+
+    if (*p || count == 0)
+    {
+        free(list);
+        return 0;
+    }
+    *numbers = list;
+    return count;
+}
+
+/**
+ * @brief Runs the simulations of replay_list again, with the seed and options of the original run,
+ *        on the threads of the simulation pool. Every replayed simulation writes its monthly log and
+ *        age structure (as the logged simulations of multi_simulate) and its results are printed,
+ *        in the same form as a row of the summary file. Only rank 0 replays with MPI.
+ * @param months The number of months of each simulation.
+ * @param initial_population_nb The initial number of rabbits of each simulation.
+ * @param nb_simulation The number of simulations of the original run.
+ * @param base_seed The base seed of the original run.
+ * @param survival The survival model of the original run.
+ * @return 1 on success, 0 if replay_list is invalid or the instances could not be allocated.
+ */
+int replay_simulations(int months, int initial_population_nb, int nb_simulation, uint64_t base_seed,
+                       const s_survival_params *survival)
+{
+    if (cluster_rank() != 0)
+        return 1;
+
+    int *numbers = NULL;
+    int count = parse_replay_list(replay_list, nb_simulation, &numbers);
+    if (count == 0)
+    {
+        fprintf(stderr, "Error: Invalid simulation list '%s' (numbers from 1 to %d)\n", replay_list, nb_simulation);
+        return 0;
+    }
+
+    int nb_threads = (simulation_threads > 0) ? simulation_threads : omp_get_num_procs();
+    if (nb_threads > count)
+        nb_threads = count;
+    allow_nested_simulation_threads();
+    s_simulation_instance *pool = reserve_simulation_pool(nb_threads);
+    s_simulation_results *results = malloc(sizeof(s_simulation_results) * count);
+    if (!pool || !results)
+    {
+        LOG_PRINT("Error: Could not allocate the simulation instances\n");
+        free(results);
+        free(numbers);
+        return 0;
+    }
+    size_t initial_capacity = initial_rabbit_capacity(initial_population_nb);
+    double start_time = omp_get_wtime();
+
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(nb_threads)
+    for (int r = 0; r < count; ++r)
+    {
+        int i = numbers[r] - 1;
+        s_simulation_instance *sim = &pool[omp_get_thread_num()];
+        prepare_simulation_instance(sim, initial_capacity, survival);
+        sim->ensemble = NULL;
+
+        // The checkpoint file stays after the replay, so the next one can start from it
+        s_checkpoint_target checkpoint;
+        if (checkpoint_interval > 0 || checkpoint_resume)
+        {
+            checkpoint_target_for(&checkpoint, base_seed, i + 1, months, initial_population_nb);
+            sim->checkpoint = &checkpoint;
+        }
+
+        // Same generator as simulation i of multi_simulate
+        pcg32x_random_t rng;
+        pcg32x_srandom_r(&rng, base_seed, (uint64_t)i);
+        init_monthly_logging(sim, months);
+        results[r] = simulate(sim, months, initial_population_nb, &rng);
+        sim->checkpoint = NULL;
+        write_simulation_log(sim, i + 1, initial_population_nb);
+    }
+
+    // The rows are the output of a replay, like the results box of multi_simulate
+    printf("\n    Replayed %d simulation%s of %d in %.3f s (seed %llu)\n", count, count > 1 ? "s" : "",
+           nb_simulation, omp_get_wtime() - start_time, (unsigned long long)base_seed);
+    printf("    Sim_Number,Final_Alive,Total_Dead,Final_Males,Final_Females,Peak_Pop,Peak_Month,"
+           "Min_Pop,Min_Month,Extinction_Month,Months_Simulated,Stop_Reason\n");
+    for (int r = 0; r < count; ++r)
+    {
+        const s_simulation_results *s = &results[r];
+        printf("    %d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%s\n", numbers[r], s->final_alive, s->total_dead,
+               s->final_males, s->final_females, s->peak_population, s->peak_population_month,
+               s->min_population, s->min_population_month, s->extinction_month, s->months_simulated,
+               get_stop_reason_name(s->stop_reason));
+    }
+
+    free(results);
+    free(numbers);
+    return 1;
+}
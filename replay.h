@@ -0,0 +1,22 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+// Replay of chosen simulations of a run.
+// multi_simulate seeds simulation i (from 1) with pcg32x_srandom_r(rng, base_seed, i - 1), so any
+// simulation of a huge run can be run again on its own, from the same seed and options, and gives
+// the same results as in the run. With replay_list the batch mode only runs the listed simulations,
+// each one with its full monthly log and age structure, to look at an outlier of a summary without
+// running the whole ensemble again.
+// Replays keep their checkpoint files (see checkpoint.h): a replay with checkpoint_resume starts
+// from the month of the last checkpoint, its generator jumped ahead to that month, instead of
+// simulating the months before again.
+
+#include "rabbitsim.h"
+
+// Global variable for the simulations to replay, e.g. "17" or "3,40-45" (NULL for a normal run)
+extern const char *replay_list;
+
+int replay_simulations(int months, int initial_population_nb, int nb_simulation, uint64_t base_seed,
+                       const s_survival_params *survival);
+
+#endif
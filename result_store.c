@@ -0,0 +1,95 @@
+#define _DEFAULT_SOURCE  // For ftruncate and msync with -std=c11
+
+#include "result_store.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Global variable for the file of the result store, see result_store.h
+const char *result_store_path = NULL;
+
+_Static_assert(sizeof(s_result_store_header) == RESULT_STORE_HEADER_SIZE, "result store header size");
+
+/**
+ * @brief Creates (or replaces) the result store file of a run at its final size and maps it.
+ *        Every record starts zeroed and not done.
+ * @param store The store to open.
+ * @param path The file name.
+ * @param nb_simulations The number of simulations of the run.
+ * @param months The number of months requested.
+ * @param initial_population The initial population size.
+ * @param base_seed The base seed of the run.
+ * @return 1 on success, 0 if the file could not be created or mapped (the store is left closed).
+ */
+int open_result_store(s_result_store *store, const char *path, int nb_simulations, int months,
+                      int initial_population, uint64_t base_seed)
+{
+    *store = (s_result_store){0};
+    size_t records_offset = RESULT_STORE_HEADER_SIZE;
+    size_t done_offset = records_offset + sizeof(s_simulation_results) * (size_t)nb_simulations;
+    size_t size = done_offset + (size_t)nb_simulations;
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return 0;
+    void *map = MAP_FAILED;
+    if (ftruncate(fd, (off_t)size) == 0)
+        map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    // The mapping keeps the file open
+    close(fd);
+    if (map == MAP_FAILED)
+        return 0;
+
+    s_result_store_header header = {0};
+    memcpy(header.magic, RESULT_STORE_MAGIC, sizeof(header.magic));
+    header.version = RESULT_STORE_VERSION;
+    header.record_size = (uint32_t)sizeof(s_simulation_results);
+    header.nb_records = (uint32_t)nb_simulations;
+    header.months = months;
+    header.initial_population = initial_population;
+    #if defined(ENABLE_INSTRUMENTATION) && ENABLE_INSTRUMENTATION != 0
+    header.flags |= RESULT_STORE_INSTRUMENTED;
+    #endif
+    header.base_seed = base_seed;
+    header.records_offset = records_offset;
+    header.done_offset = done_offset;
+    memcpy(map, &header, sizeof(header));
+
+    store->map = map;
+    store->map_size = size;
+    store->records = (s_simulation_results *)((char *)map + records_offset);
+    store->done = (uint8_t *)map + done_offset;
+    store->nb_records = nb_simulations;
+    return 1;
+}
+
+/**
+ * @brief Marks records of the store as complete, once their results are written.
+ *        Does nothing on a closed store.
+ * @param store The store.
+ * @param first The index of the first record (simulation number - 1).
+ * @param count The number of records.
+ * @return void
+ */
+void mark_result_stored(s_result_store *store, int first, int count)
+{
+    if (store->done)
+        memset(store->done + first, 1, (size_t)count);
+}
+
+/**
+ * @brief Writes the mapped pages back to the file and unmaps it. Does nothing on a closed store.
+ * @param store The store to close.
+ * @return void
+ */
+void close_result_store(s_result_store *store)
+{
+    if (!store->map)
+        return;
+    if (msync(store->map, store->map_size, MS_SYNC) != 0)
+        LOG_PRINT("Warning: Could not write the result store %s\n", result_store_path);
+    munmap(store->map, store->map_size);
+    *store = (s_result_store){0};
+}
@@ -0,0 +1,55 @@
+#ifndef RESULT_STORE_H
+#define RESULT_STORE_H
+
+// Results of every simulation of multi_simulate kept in a memory-mapped file instead of the heap.
+// With result_store_path the file is created at its final size when the run starts, and each
+// simulation writes its s_simulation_results straight into its own record (indexed by simulation
+// number), then sets its byte in the completion map. Pages of the file are written back by the
+// kernel, so the memory of a huge run does not grow with the number of simulations, and the
+// records of the simulations already done stay in the file if the run is interrupted.
+// File layout (native byte order, little-endian on every supported host):
+//   header   RESULT_STORE_HEADER_SIZE bytes, see s_result_store_header
+//   records  nb_records raw s_simulation_results of record_size bytes, from offset records_offset
+//   done     nb_records bytes from offset done_offset, 1 once the record of the simulation is complete
+// analyze_simulation.py maps the records as one array (load_result_store).
+
+#include "rabbitsim.h"
+
+#define RESULT_STORE_MAGIC "RABBITRS"
+#define RESULT_STORE_VERSION 1
+#define RESULT_STORE_HEADER_SIZE 64
+
+// Flags of the header
+#define RESULT_STORE_INSTRUMENTED 1u    // The records end with the hot path counters (see instrument.h)
+
+typedef struct {
+    char magic[8];               // RESULT_STORE_MAGIC, without the NUL
+    uint32_t version;            // RESULT_STORE_VERSION
+    uint32_t record_size;        // sizeof(s_simulation_results) of the build that wrote the file
+    uint32_t nb_records;         // Number of simulations of the run
+    int32_t months;              // Months requested
+    int32_t initial_population;  // Initial population size
+    uint32_t flags;              // RESULT_STORE_* flags
+    uint64_t base_seed;          // Base seed of the run
+    uint64_t records_offset;     // Offset of the first record
+    uint64_t done_offset;        // Offset of the completion map
+    uint8_t reserved[8];
+} s_result_store_header;
+
+// Global variable for the file of the result store (NULL to keep the results on the heap)
+extern const char *result_store_path;
+
+typedef struct {
+    void *map;                       // Mapping of the whole file
+    size_t map_size;                 // Size of the file
+    s_simulation_results *records;   // Records of the simulations, from simulation 1
+    uint8_t *done;                   // Completion map
+    int nb_records;
+} s_result_store;
+
+int open_result_store(s_result_store *store, const char *path, int nb_simulations, int months,
+                      int initial_population, uint64_t base_seed);
+void mark_result_stored(s_result_store *store, int first, int count);
+void close_result_store(s_result_store *store);
+
+#endif
@@ -0,0 +1,299 @@
+#include "variates.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// Start of the tail and area of each layer of the two ziggurats (Marsaglia & Tsang, 2000)
+#define ZIGGURAT_NORMAL_R 3.442619855899
+#define ZIGGURAT_NORMAL_V 9.91256303526217e-3
+#define ZIGGURAT_EXPONENTIAL_R 7.697117470131487
+#define ZIGGURAT_EXPONENTIAL_V 3.949659822581572e-3
+
+// Low bits of a raw output selecting the layer, the remaining bits give the position in it
+#define ZIGGURAT_NORMAL_MASK (ZIGGURAT_NORMAL_LAYERS - 1)
+#define ZIGGURAT_EXPONENTIAL_MASK (ZIGGURAT_EXPONENTIAL_LAYERS - 1)
+
+// Ziggurat tables: k is the fast acceptance bound of a layer, w scales a raw output to x, f is the density at x
+static uint32_t normal_k[ZIGGURAT_NORMAL_LAYERS];
+static double normal_w[ZIGGURAT_NORMAL_LAYERS];
+static double normal_f[ZIGGURAT_NORMAL_LAYERS];
+static uint32_t exponential_k[ZIGGURAT_EXPONENTIAL_LAYERS];
+static double exponential_w[ZIGGURAT_EXPONENTIAL_LAYERS];
+static double exponential_f[ZIGGURAT_EXPONENTIAL_LAYERS];
+static int ziggurat_ready = 0;
+
+/**
+ * @brief Builds the ziggurat tables, once per process. Safe to call from several threads;
+ *        simulate calls it before the first rabbit so every caller of the samplers is covered.
+ * @return void
+ */
+void ziggurat_init(void)
+{
+    int ready;
+    #pragma omp atomic read
+    ready = ziggurat_ready;
+    if (ready)
+        return;
+
+    #pragma omp critical(ziggurat_init)
+    {
+        if (!ziggurat_ready)
+        {
+            const double m1 = 2147483648.0;
+            const double m2 = 4294967296.0;
+
+            double dn = ZIGGURAT_NORMAL_R, tn = dn;
+            double q = ZIGGURAT_NORMAL_V / exp(-0.5 * dn * dn);
+            normal_k[0] = (uint32_t)((dn / q) * m1);
+            normal_k[1] = 0;
+            normal_w[0] = q / m1;
+            normal_w[ZIGGURAT_NORMAL_LAYERS - 1] = dn / m1;
+            normal_f[0] = 1.0;
+            normal_f[ZIGGURAT_NORMAL_LAYERS - 1] = exp(-0.5 * dn * dn);
+            for (int i = ZIGGURAT_NORMAL_LAYERS - 2; i >= 1; --i)
+            {
+                dn = sqrt(-2.0 * log(ZIGGURAT_NORMAL_V / dn + exp(-0.5 * dn * dn)));
+                normal_k[i + 1] = (uint32_t)((dn / tn) * m1);
+                tn = dn;
+                normal_f[i] = exp(-0.5 * dn * dn);
+                normal_w[i] = dn / m1;
+            }
+
+            double de = ZIGGURAT_EXPONENTIAL_R, te = de;
+            q = ZIGGURAT_EXPONENTIAL_V / exp(-de);
+            exponential_k[0] = (uint32_t)((de / q) * m2);
+            exponential_k[1] = 0;
+            exponential_w[0] = q / m2;
+            exponential_w[ZIGGURAT_EXPONENTIAL_LAYERS - 1] = de / m2;
+            exponential_f[0] = 1.0;
+            exponential_f[ZIGGURAT_EXPONENTIAL_LAYERS - 1] = exp(-de);
+            for (int i = ZIGGURAT_EXPONENTIAL_LAYERS - 2; i >= 1; --i)
+            {
+                de = -log(ZIGGURAT_EXPONENTIAL_V / de + exp(-de));
+                exponential_k[i + 1] = (uint32_t)((de / te) * m2);
+                te = de;
+                exponential_f[i] = exp(-de);
+                exponential_w[i] = de / m2;
+            }
+
+            #pragma omp atomic write
+            ziggurat_ready = 1;
+        }
+    }
+}
+
+/**
+ * @brief Draws a standard normal variate, N(0, 1), with the ziggurat method.
+ *        The layer comes from the low bits of the raw output and the signed position from the others,
+ *        so both are independent and one output is enough for about 99% of the draws.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return The normal variate.
+ */
+double genrand_normal(pcg32x_random_t *rng)
+{
+    for (;;)
+    {
+        uint32_t raw = pcg32x_random_r(rng);
+        int layer = (int)(raw & ZIGGURAT_NORMAL_MASK);
+        int32_t position = (int32_t)(raw & ~(uint32_t)ZIGGURAT_NORMAL_MASK);
+        uint32_t magnitude = (position < 0) ? (uint32_t)0 - (uint32_t)position : (uint32_t)position;
+        double x = (double)position * normal_w[layer];
+
+        if (magnitude < normal_k[layer])
+            return x;
+
+        if (layer == 0)
+        {
+            // Tail beyond ZIGGURAT_NORMAL_R
+            double tail, y;
+            do
+            {
+                tail = -log(genrand_open(rng)) / ZIGGURAT_NORMAL_R;
+                y = -log(genrand_open(rng));
+            } while (y + y < tail * tail);
+            return (position > 0) ? ZIGGURAT_NORMAL_R + tail : -ZIGGURAT_NORMAL_R - tail;
+        }
+
+        // Wedge between the rectangle and the density
+        double f = normal_f[layer] + genrand_open(rng) * (normal_f[layer - 1] - normal_f[layer]);
+        if (f < exp(-0.5 * x * x))
+            return x;
+    }
+}
+
+/**
+ * @brief Draws a standard exponential variate, Exp(1), with the ziggurat method.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return The exponential variate.
+ */
+double genrand_exponential(pcg32x_random_t *rng)
+{
+    for (;;)
+    {
+        uint32_t raw = pcg32x_random_r(rng);
+        int layer = (int)(raw & ZIGGURAT_EXPONENTIAL_MASK);
+        uint32_t position = raw & ~(uint32_t)ZIGGURAT_EXPONENTIAL_MASK;
+        double x = (double)position * exponential_w[layer];
+
+        if (position < exponential_k[layer])
+            return x;
+
+        if (layer == 0)
+            return ZIGGURAT_EXPONENTIAL_R - log(genrand_open(rng));
+
+        double f = exponential_f[layer] + genrand_open(rng) * (exponential_f[layer - 1] - exponential_f[layer]);
+        if (f < exp(-x))
+            return x;
+    }
+}
+
+/**
+ * @brief Compares two doubles for qsort.
+ * @param a A pointer to the first double.
+ * @param b A pointer to the second double.
+ * @return A negative, zero or positive value as for qsort.
+ */
+static int compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Standard normal cumulative distribution function.
+ * @param x The point at which to evaluate the function.
+ * @return P(Z <= x).
+ */
+double normal_cdf(double x)
+{
+    return 0.5 * erfc(-x / sqrt(2.0));
+}
+
+/**
+ * @brief Standard exponential cumulative distribution function.
+ * @param x The point at which to evaluate the function.
+ * @return P(E <= x).
+ */
+static double exponential_cdf(double x)
+{
+    return (x > 0.0) ? 1.0 - exp(-x) : 0.0;
+}
+
+/**
+ * @brief Checks one sample against its distribution: mean and variance within 5 standard errors,
+ *        and Kolmogorov-Smirnov distance below the 0.1% critical value. Prints one line of results.
+ * @param name The name of the sampler.
+ * @param samples The samples (sorted in place).
+ * @param n The number of samples.
+ * @param mean The expected mean.
+ * @param variance The expected variance.
+ * @param kurtosis The expected fourth central moment divided by variance squared.
+ * @param cdf The expected cumulative distribution function.
+ * @param seconds The time spent drawing the samples.
+ * @return 1 if the sample passes, 0 otherwise.
+ */
+static int check_sample(const char *name, double *samples, int n, double mean, double variance,
+                        double kurtosis, double (*cdf)(double), double seconds)
+{
+    double sum = 0.0;
+    for (int i = 0; i < n; ++i)
+        sum += samples[i];
+    double sample_mean = sum / n;
+    double m2 = 0.0;
+    for (int i = 0; i < n; ++i)
+    {
+        double d = samples[i] - sample_mean;
+        m2 += d * d;
+    }
+    double sample_variance = m2 / (n - 1);
+
+    qsort(samples, n, sizeof(double), compare_doubles);
+    double distance = 0.0;
+    for (int i = 0; i < n; ++i)
+    {
+        double p = cdf(samples[i]);
+        double above = (double)(i + 1) / n - p;
+        double below = p - (double)i / n;
+        if (above > distance) distance = above;
+        if (below > distance) distance = below;
+    }
+
+    double mean_error = 5.0 * sqrt(variance / n);
+    double variance_error = 5.0 * variance * sqrt((kurtosis - 1.0) / n);
+    double critical = 1.949 / sqrt((double)n);
+    int pass = fabs(sample_mean - mean) < mean_error &&
+               fabs(sample_variance - variance) < variance_error &&
+               distance < critical;
+
+    printf("  %-22s mean %+.5f  var %.5f  KS %.5f (< %.5f)  %6.2f ns/draw  %s\n",
+           name, sample_mean, sample_variance, distance, critical, seconds * 1e9 / n, pass ? "ok" : "FAILED");
+    return pass;
+}
+
+/**
+ * @brief Statistical check of the ziggurat samplers against the Box-Muller and -log(u) draws they replace.
+ *        Both versions are drawn from the same seed and checked against the exact N(0, 1) and Exp(1)
+ *        distributions, with their cost per draw.
+ * @param nb_samples The number of draws of each sampler.
+ * @param seed The seed of the generator.
+ * @return 1 if every sample passes, 0 otherwise.
+ */
+int check_variate_distributions(int nb_samples, uint64_t seed)
+{
+    if (nb_samples < 2)
+        nb_samples = 2;
+    double *samples = malloc(sizeof(double) * nb_samples);
+    pcg32x_random_t *rng = malloc(sizeof(pcg32x_random_t));
+    if (!samples || !rng)
+    {
+        free(samples);
+        free(rng);
+        fprintf(stderr, "Error: Could not allocate the samples\n");
+        return 0;
+    }
+    ziggurat_init();
+
+    printf("Variate check: %d draws per sampler, seed %llu\n", nb_samples, (unsigned long long)seed);
+    int pass = 1;
+    double start;
+
+    pcg32x_srandom_r(rng, seed, 0);
+    start = omp_get_wtime();
+    for (int i = 0; i < nb_samples; ++i)
+    {
+        double u1 = genrand_open(rng);
+        double u2 = genrand_open(rng);
+        samples[i] = sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+    }
+    pass &= check_sample("normal (Box-Muller)", samples, nb_samples, 0.0, 1.0, 3.0, normal_cdf, omp_get_wtime() - start);
+
+    pcg32x_srandom_r(rng, seed, 0);
+    start = omp_get_wtime();
+    for (int i = 0; i < nb_samples; ++i)
+        samples[i] = genrand_normal(rng);
+    pass &= check_sample("normal (ziggurat)", samples, nb_samples, 0.0, 1.0, 3.0, normal_cdf, omp_get_wtime() - start);
+
+    pcg32x_srandom_r(rng, seed, 1);
+    start = omp_get_wtime();
+    for (int i = 0; i < nb_samples; ++i)
+        samples[i] = -log(genrand_open(rng));
+    pass &= check_sample("exponential (-log u)", samples, nb_samples, 1.0, 1.0, 9.0, exponential_cdf, omp_get_wtime() - start);
+
+    pcg32x_srandom_r(rng, seed, 1);
+    start = omp_get_wtime();
+    for (int i = 0; i < nb_samples; ++i)
+        samples[i] = genrand_exponential(rng);
+    pass &= check_sample("exponential (ziggurat)", samples, nb_samples, 1.0, 1.0, 9.0, exponential_cdf, omp_get_wtime() - start);
+
+    printf("Variate check %s\n", pass ? "passed" : "FAILED");
+    free(samples);
+    free(rng);
+    return pass;
+}
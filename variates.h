@@ -0,0 +1,32 @@
+#ifndef VARIATES_H
+#define VARIATES_H
+
+// Normal and exponential random variates for the random survival methods.
+// Both use the ziggurat method of Marsaglia and Tsang: most draws cost one table lookup,
+// one comparison and one multiplication on raw PCG outputs, and only the rare draws that
+// fall outside the rectangles of the ziggurat call into libm.
+
+#include <stdint.h>
+#include "pcg_batch.h"
+
+// Number of layers of the ziggurats
+#define ZIGGURAT_NORMAL_LAYERS 128
+#define ZIGGURAT_EXPONENTIAL_LAYERS 256
+
+/**
+ * @brief Generates a random double strictly between 0 and 1, as needed by the logarithms of the samplers.
+ * @param rng A pointer to the PCG random number generator state.
+ * @return A double in (0, 1).
+ */
+static inline double genrand_open(pcg32x_random_t *rng)
+{
+    return ((double)pcg32x_random_r(rng) + 0.5) * (1.0 / 4294967296.0);
+}
+
+void ziggurat_init(void);
+double normal_cdf(double x);
+double genrand_normal(pcg32x_random_t *rng);
+double genrand_exponential(pcg32x_random_t *rng);
+int check_variate_distributions(int nb_samples, uint64_t seed);
+
+#endif